@@ -1,13 +1,29 @@
 
+#include "sqlite_extensions/uuid.hpp"
 #include "sqlite_extensions/uuidext.hpp"
+#include "shardedwriter.hpp"
+#include "sqlitehelpers.hpp"
+#include "uuidbackfill.hpp"
+#include "uuidmigration.hpp"
+#include "uuidsoci.hpp"
 
 #include <sqlite3.h>
 #include <soci/soci.h>
 
+#include <algorithm>
 #include <iostream>
+#include <chrono>
 #include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 
+/*
+* Namespace for the name-based keys of licensed users. Changing it changes every key.
+*/
+static const char * const LICENSED_USERS_NAMESPACE = "3c8a1f4e-6b2d-4e71-9a05-d2f7c81b6e39";
+
 /*
 * can throw soci::error
 */
@@ -115,7 +131,6 @@ void testsoci_w_sqlite_ext()
         soci::session sql("sqlite3", "file:testdb.db");
         
         sql << "ALTER TABLE licensed_users ADD COLUMN uuid varchar(36) NOT NULL DEFAULT('0')";
-        sql << "UPDATE licensed_users SET uuid = uuid()";
     }
     catch(const soci::soci_error & e)
     {
@@ -123,10 +138,302 @@ void testsoci_w_sqlite_ext()
         return;
     }
 
+    // Fill the new column in batches rather than with one UPDATE holding the write lock for the whole table.
+    // The keys are name-based, so importing the same users again gives them the same keys.
+    sqlite3 * db = nullptr;
+    try
+    {
+        db = open_database("testdb.db");
+        backfill_uuid_column(db, "licensed_users", "uuid", "uuid5('" + std::string(LICENSED_USERS_NAMESPACE) + "', user_name || ':' || ifnull(email, ''))", BatchOptions());
+        clear_batch_checkpoint(db, "uuid_backfill licensed_users.uuid");
+        sqlite3_close(db);
+    }
+    catch(const std::exception & e)
+    {
+        sqlite3_close(db);
+        std::cerr << e.what() << '\n';
+        return;
+    }
+
     std::cout << "SQLite extension used to alter table successfully" << std::endl;
+
+    try
+    {
+        soci::session sql("sqlite3", "file:testdb.db");
+
+        Uuid key;
+        sql << "SELECT uuid FROM licensed_users WHERE user_name = 'Jane'", soci::into(key);
+        std::cout << "Jane's key is " << key.toString() << std::endl;
+    }
+    catch(const soci::soci_error & e)
+    {
+        std::cerr << e.what() << '\n';
+    }
+}
+
+void print_stats(const char * label, const StorageStats & before, const StorageStats & after)
+{
+    if( before.pageBytes < 0 || after.pageBytes < 0 )
+    {
+        std::cout << label << ": sizes unavailable, sqlite was built without dbstat" << std::endl;
+        return;
+    }
+
+    std::cout << label << ": " << before.pageBytes << " -> " << after.pageBytes << " bytes of pages ("
+        << before.pageBytes - after.pageBytes << " saved), "
+        << before.payloadBytes << " -> " << after.payloadBytes << " bytes of records ("
+        << before.payloadBytes - after.payloadBytes << " saved), depth "
+        << before.depth << " -> " << after.depth << std::endl;
+}
+
+static const char * const BATCH_USAGE = "[--batch-rows N] [--max-batch-ms N] [--pause-ms N]";
+
+/*
+* Reads the batch options, and the generator for backfill when it is not nullptr, from the arguments following the
+* command's positional ones. Returns false if there is one it does not know.
+*/
+bool parse_options(int argc, char ** argv, int first, BatchOptions & options, std::string * generator)
+{
+    try
+    {
+        for(int i = first; i < argc; i += 2)
+        {
+            const std::string name = argv[i];
+            if( i + 1 >= argc )
+            {
+                return false;
+            }
+
+            const std::string value = argv[i + 1];
+            if( name == "--batch-rows" )
+            {
+                options.batchRows = std::stoll(value);
+            }
+            else if( name == "--max-batch-ms" )
+            {
+                options.maxBatchTime = std::chrono::milliseconds(std::stoll(value));
+            }
+            else if( name == "--pause-ms" )
+            {
+                options.pause = std::chrono::milliseconds(std::stoll(value));
+            }
+            else if( name == "--generator" && generator != nullptr )
+            {
+                *generator = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+    catch(const std::exception &)
+    {
+        // Not a number
+        return false;
+    }
+
+    return true;
 }
 
-int main()
+void print_batches(const BatchReport & report)
+{
+    std::cout << report.batches << " batches, " << report.interruptedBatches << " interrupted for taking too long and retried with fewer rows" << std::endl;
+}
+
+/*
+* app migrate <database> <table> <column> [batch options]
+* Converts a column of text UUIDs to 16-byte blobs, see migrate_uuid_column()
+*/
+int migrate_command(int argc, char ** argv)
+{
+    BatchOptions options;
+    if( argc < 5 || !parse_options(argc, argv, 5, options, nullptr) )
+    {
+        std::cerr << "usage: " << argv[0] << " migrate <database> <table> <column> " << BATCH_USAGE << std::endl;
+        return 2;
+    }
+
+    sqlite3 * db = nullptr;
+    try
+    {
+        db = open_database(argv[2]);
+        const UuidMigrationReport report = migrate_uuid_column(db, argv[3], argv[4], options);
+        sqlite3_close(db);
+
+        std::cout << "Converted " << report.rowsConverted << " rows of " << argv[3] << "." << argv[4] << " to 16-byte blobs" << std::endl;
+        if( report.valuesSkipped > 0 )
+        {
+            std::cout << report.valuesSkipped << " values are not UUIDs and were left as they were" << std::endl;
+        }
+        print_stats("Table", report.tableBefore, report.tableAfter);
+        print_stats("Indexes", report.indexesBefore, report.indexesAfter);
+    }
+    catch(const std::exception & e)
+    {
+        sqlite3_close(db);
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+* app backfill <database> <table> <column> [--generator uuid()|uuid7()|uuid7_blob()] [batch options]
+* Gives every row without one a UUID, see backfill_uuid_column(). Run it again after an interruption to carry on.
+*/
+int backfill_command(int argc, char ** argv)
+{
+    BatchOptions options;
+    std::string generator = "uuid()";
+    if( argc < 5 || !parse_options(argc, argv, 5, options, &generator) )
+    {
+        std::cerr << "usage: " << argv[0] << " backfill <database> <table> <column> [--generator uuid()|uuid7()|uuid7_blob()] " << BATCH_USAGE << std::endl;
+        return 2;
+    }
+
+    sqlite3 * db = nullptr;
+    try
+    {
+        db = open_database(argv[2]);
+        const BatchReport report = backfill_uuid_column(db, argv[3], argv[4], generator, options);
+        sqlite3_close(db);
+
+        std::cout << "Filled " << report.rowsChanged << " rows of " << argv[3] << "." << argv[4] << " with " << generator << std::endl;
+        print_batches(report);
+    }
+    catch(const std::exception & e)
+    {
+        sqlite3_close(db);
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+* app shard-insert <base path> <shards> <rows>
+* Inserts rows with random UUID keys through a ShardedWriter and reports the rate, to see how inserts scale with shards
+*/
+int shard_insert_command(int argc, char ** argv)
+{
+    if( argc != 5 )
+    {
+        std::cerr << "usage: " << argv[0] << " shard-insert <base path> <shards> <rows>" << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        const int shards = std::stoi(argv[3]);
+        const int64_t rows = std::stoll(argv[4]);
+        int64_t total = 0;
+
+        const auto started = std::chrono::steady_clock::now();
+        {
+            ShardedWriter writer(argv[2], shards,
+                "CREATE TABLE IF NOT EXISTS licensed_users(uuid BLOB PRIMARY KEY, user_name TEXT NOT NULL) WITHOUT ROWID",
+                "INSERT INTO licensed_users VALUES (?1, ?2)");
+
+            // Generated a batch at a time, which draws from the randomness pool once per batch
+            std::vector<Uuid> uuids(1000);
+            for(int64_t row = 0; row < rows; row++)
+            {
+                const size_t batchIndex = static_cast<size_t>(row) % uuids.size();
+                if( batchIndex == 0 )
+                {
+                    Uuid::generate(uuids);
+                }
+                writer.insert(uuids[batchIndex], {std::string("user") + std::to_string(row)});
+            }
+            writer.flush();
+
+            for( const SqlRow & counted : writer.query("SELECT count(*) FROM licensed_users") )
+            {
+                total += std::get<int64_t>(counted[0]);
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+        std::cout << "Inserted " << rows << " rows into " << shards << " shards in " << elapsed.count() << "s, "
+            << static_cast<int64_t>(rows / elapsed.count()) << " rows/s. The shards now hold " << total << " rows." << std::endl;
+    }
+    catch(const std::exception & e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+* app bulk-insert <database> <rows>
+* Inserts rows with random UUID keys 10000 at a time, each batch bound as one array and written by one step of one
+* statement, then reads every key back as a blob, and reports both rates. No UUID is formatted as text on the way.
+*/
+int bulk_insert_command(int argc, char ** argv)
+{
+    if( argc != 4 )
+    {
+        std::cerr << "usage: " << argv[0] << " bulk-insert <database> <rows>" << std::endl;
+        return 2;
+    }
+
+    sqlite3 * db = nullptr;
+    try
+    {
+        const int64_t rows = std::stoll(argv[3]);
+        db = open_database(argv[2], true);
+        exec(db, "CREATE TABLE IF NOT EXISTS bulk_keys(id BLOB PRIMARY KEY) WITHOUT ROWID");
+
+        const auto started = std::chrono::steady_clock::now();
+        {
+            Statement insert(db, "INSERT INTO bulk_keys SELECT uuid_blob FROM uuid_carray(?1)");
+            std::vector<Uuid> uuids(10000);
+            for(int64_t inserted = 0; inserted < rows; inserted += static_cast<int64_t>(uuids.size()))
+            {
+                uuids.resize(static_cast<size_t>(std::min<int64_t>(rows - inserted, 10000)));
+                Uuid::generate(uuids);
+
+                in_transaction(db, [&]()
+                {
+                    insert.bind(1, uuids);
+                    insert.step();
+                    insert.reset();
+                });
+            }
+        }
+        const std::chrono::duration<double> inserting = std::chrono::steady_clock::now() - started;
+
+        std::vector<Uuid> keys;
+        {
+            Statement count(db, "SELECT count(*) FROM bulk_keys");
+            count.step();
+            keys.reserve(static_cast<size_t>(count.columnInt(0)));
+
+            Statement select(db, "SELECT id FROM bulk_keys");
+            read_uuids(select, 0, keys);
+        }
+        const std::chrono::duration<double> reading = std::chrono::steady_clock::now() - started - inserting;
+        sqlite3_close(db);
+
+        std::cout << "Inserted " << rows << " rows in " << inserting.count() << "s, " << static_cast<int64_t>(rows / inserting.count())
+            << " rows/s. Read back " << keys.size() << " keys in " << reading.count() << "s." << std::endl;
+    }
+    catch(const std::exception & e)
+    {
+        sqlite3_close(db);
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv)
 {
     // Register extention
     //
@@ -136,6 +443,26 @@ int main()
     pfnInitExtensionFunction test = (pfnInitExtensionFunction)sqlite3_uuid_init;
     sqlite3_auto_extension(test);
 
+    if( argc > 1 && std::string(argv[1]) == "migrate" )
+    {
+        return migrate_command(argc, argv);
+    }
+
+    if( argc > 1 && std::string(argv[1]) == "backfill" )
+    {
+        return backfill_command(argc, argv);
+    }
+
+    if( argc > 1 && std::string(argv[1]) == "shard-insert" )
+    {
+        return shard_insert_command(argc, argv);
+    }
+
+    if( argc > 1 && std::string(argv[1]) == "bulk-insert" )
+    {
+        return bulk_insert_command(argc, argv);
+    }
+
     // Test soci using sqlite
     testsoci_w_sqlite_ext();
 
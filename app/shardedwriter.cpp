@@ -0,0 +1,414 @@
+#include "shardedwriter.hpp"
+#include "sqlitehelpers.hpp"
+
+#include "sqlite_extensions/uuidhash.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+
+namespace
+{
+    struct PendingRow
+    {
+        Uuid uuid;
+        SqlRow values;
+    };
+
+    void bind_value(Statement & statement, int index, const SqlValue & value)
+    {
+        sqlite3_stmt * handle = statement.handle();
+        switch( value.index() )
+        {
+            case 0:
+                sqlite3_bind_null(handle, index);
+                break;
+            case 1:
+                sqlite3_bind_int64(handle, index, std::get<int64_t>(value));
+                break;
+            case 2:
+                sqlite3_bind_double(handle, index, std::get<double>(value));
+                break;
+            case 3:
+                statement.bind(index, std::get<std::string>(value));
+                break;
+            default:
+            {
+                const std::vector<unsigned char> & blob = std::get<std::vector<unsigned char>>(value);
+                sqlite3_bind_blob(handle, index, blob.data(), static_cast<int>(blob.size()), SQLITE_TRANSIENT);
+                break;
+            }
+        }
+    }
+
+    /*
+    * Orders two integers, or an integer and a real, exactly, as sqlite does, rather than converting the integer to a real
+    * and losing the low bits of large ones. Returns less than, equal to or greater than zero.
+    */
+    int compare_numbers(int64_t integer, double real)
+    {
+        if( real < -9223372036854775808.0 )
+        {
+            return 1;
+        }
+        if( real >= 9223372036854775808.0 )
+        {
+            return -1;
+        }
+
+        const int64_t truncated = static_cast<int64_t>(real);
+        if( integer != truncated )
+        {
+            return integer < truncated ? -1 : 1;
+        }
+
+        // The integer is the real without its fraction, so the fraction decides
+        const double whole = static_cast<double>(truncated);
+        return whole < real ? -1 : whole > real ? 1 : 0;
+    }
+
+    /*
+    * Orders values the way sqlite's ORDER BY does with the BINARY collation: NULL first, then integers and reals together
+    * by value, then text and then blobs, both by their bytes
+    */
+    bool value_less(const SqlValue & left, const SqlValue & right)
+    {
+        // NULL, numbers, text and blobs
+        static const int TYPE_ORDER[] = {0, 1, 1, 2, 3};
+        const int leftOrder = TYPE_ORDER[left.index()];
+        const int rightOrder = TYPE_ORDER[right.index()];
+        if( leftOrder != rightOrder )
+        {
+            return leftOrder < rightOrder;
+        }
+
+        switch( left.index() )
+        {
+            case 0:
+                return false;
+            case 1:
+                return std::holds_alternative<int64_t>(right)
+                    ? std::get<int64_t>(left) < std::get<int64_t>(right)
+                    : compare_numbers(std::get<int64_t>(left), std::get<double>(right)) < 0;
+            case 2:
+                return std::holds_alternative<double>(right)
+                    ? std::get<double>(left) < std::get<double>(right)
+                    : compare_numbers(std::get<int64_t>(right), std::get<double>(left)) > 0;
+            default:
+                // std::string and std::vector<unsigned char> both compare their bytes as unsigned, then their lengths,
+                // the same as memcmp() then length in sqlite
+                return left < right;
+        }
+    }
+
+    SqlValue column_value(Statement & statement, int index)
+    {
+        sqlite3_stmt * handle = statement.handle();
+        switch( sqlite3_column_type(handle, index) )
+        {
+            case SQLITE_INTEGER:
+                return static_cast<int64_t>(sqlite3_column_int64(handle, index));
+            case SQLITE_FLOAT:
+                return sqlite3_column_double(handle, index);
+            case SQLITE_TEXT:
+                return statement.columnText(index);
+            case SQLITE_BLOB:
+            {
+                const unsigned char * blob = reinterpret_cast<const unsigned char *>(sqlite3_column_blob(handle, index));
+                return std::vector<unsigned char>(blob, blob + sqlite3_column_bytes(handle, index));
+            }
+            default:
+                return std::monostate();
+        }
+    }
+}
+
+struct ShardedWriter::Shard
+{
+    std::string path;
+    sqlite3 * db = nullptr;
+    std::unique_ptr<Statement> insert;
+    std::thread writer;
+
+    std::mutex mutex;
+    std::condition_variable rowsWaiting;     // for the writer
+    std::condition_variable rowsWritten;     // for insert() waiting for space, and flush()
+    std::deque<PendingRow> queue;
+    uint64_t queued = 0;
+    uint64_t written = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+
+    ~Shard()
+    {
+        insert.reset();
+        sqlite3_close(db);
+    }
+
+    void write(size_t batchRows)
+    {
+        std::vector<PendingRow> batch;
+
+        while( true )
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                rowsWaiting.wait(lock, [this]() { return !queue.empty() || stopping; });
+                if( queue.empty() )
+                {
+                    return;
+                }
+
+                const size_t count = std::min(batchRows, queue.size());
+                batch.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.begin() + count));
+                queue.erase(queue.begin(), queue.begin() + count);
+            }
+
+            std::exception_ptr batchError;
+            try
+            {
+                in_transaction(db, [&]()
+                {
+                    for( const PendingRow & row : batch )
+                    {
+                        sqlite3_bind_blob(insert->handle(), 1, row.uuid.bytes.data(), 16, SQLITE_STATIC);
+                        for(size_t i = 0; i < row.values.size(); i++)
+                        {
+                            bind_value(*insert, static_cast<int>(i + 2), row.values[i]);
+                        }
+                        insert->step();
+                        insert->reset();
+                    }
+                });
+            }
+            catch( const std::exception & e )
+            {
+                insert->reset();
+                batchError = std::make_exception_ptr(std::runtime_error("Writing to " + path + ": " + e.what()));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                written += batch.size();
+                if( batchError && !error )
+                {
+                    error = batchError;
+                }
+            }
+            rowsWritten.notify_all();
+        }
+    }
+
+    /*
+    * Rethrows the first error from the writer, once. The mutex must be held.
+    */
+    void rethrow_error()
+    {
+        if( error )
+        {
+            std::exception_ptr thrown = error;
+            error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+    }
+};
+
+ShardedWriter::ShardedWriter(const std::string & basePath, int shards, const std::string & schema, const std::string & insertSql,
+    const ShardedWriterOptions & options)
+    : m_basePath(basePath)
+    , m_options(options)
+{
+    if( shards < 1 || options.batchRows < 1 || options.queueRows < 1 )
+    {
+        throw std::runtime_error("A sharded writer needs at least one shard, and room for at least one row per batch and queue");
+    }
+
+    // Everything that can fail happens here, before any thread starts
+    for(int i = 0; i < shards; i++)
+    {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->path = shardPath(i);
+        shard->db = open_database(shard->path, true);
+        exec(shard->db, "PRAGMA journal_mode = WAL");
+        exec(shard->db, "PRAGMA synchronous = NORMAL");
+        exec(shard->db, schema);
+        shard->insert.reset(new Statement(shard->db, insertSql));
+        m_shards.push_back(std::move(shard));
+    }
+
+    // Starting a thread can fail too, and the ones already running must be joined before the shards go away
+    try
+    {
+        for( std::unique_ptr<Shard> & shard : m_shards )
+        {
+            Shard * writing = shard.get();
+            const size_t batchRows = m_options.batchRows;
+            shard->writer = std::thread([writing, batchRows]() { writing->write(batchRows); });
+        }
+    }
+    catch( ... )
+    {
+        stopWriters();
+        throw;
+    }
+}
+
+ShardedWriter::~ShardedWriter()
+{
+    stopWriters();
+}
+
+void ShardedWriter::stopWriters()
+{
+    for( std::unique_ptr<Shard> & shard : m_shards )
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stopping = true;
+        }
+        shard->rowsWaiting.notify_one();
+    }
+
+    for( std::unique_ptr<Shard> & shard : m_shards )
+    {
+        if( shard->writer.joinable() )
+        {
+            shard->writer.join();
+        }
+    }
+}
+
+int ShardedWriter::shards() const
+{
+    return static_cast<int>(m_shards.size());
+}
+
+std::string ShardedWriter::shardPath(int shard) const
+{
+    return m_basePath + "-" + std::to_string(shard) + ".db";
+}
+
+void ShardedWriter::insert(const Uuid & uuid, SqlRow values)
+{
+    Shard & shard = *m_shards[static_cast<size_t>(sqlite3UuidShard(uuid.bytes.data(), shards()))];
+
+    PendingRow row;
+    row.uuid = uuid;
+    row.values = std::move(values);
+
+    bool wasEmpty;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.rowsWritten.wait(lock, [&]() { return shard.queue.size() < m_options.queueRows || shard.error; });
+        shard.rethrow_error();
+
+        wasEmpty = shard.queue.empty();
+        shard.queue.push_back(std::move(row));
+        shard.queued++;
+    }
+
+    // The writer only sleeps once it has emptied the queue
+    if( wasEmpty )
+    {
+        shard.rowsWaiting.notify_one();
+    }
+}
+
+void ShardedWriter::flush()
+{
+    for( std::unique_ptr<Shard> & shard : m_shards )
+    {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        const uint64_t queued = shard->queued;
+        shard->rowsWritten.wait(lock, [&]() { return shard->written >= queued; });
+        shard->rethrow_error();
+    }
+}
+
+std::vector<SqlRow> ShardedWriter::query(const std::string & sql, int mergeColumn)
+{
+    std::vector<std::vector<SqlRow>> results(m_shards.size());
+    std::vector<std::exception_ptr> errors(m_shards.size());
+    std::vector<std::thread> readers;
+
+    const auto readShard = [&](size_t i)
+    {
+        sqlite3 * db = nullptr;
+        try
+        {
+            db = open_database(m_shards[i]->path);
+            Statement statement(db, sql);
+            const int columns = sqlite3_column_count(statement.handle());
+            while( statement.step() )
+            {
+                SqlRow row;
+                for(int column = 0; column < columns; column++)
+                {
+                    row.push_back(column_value(statement, column));
+                }
+                results[i].push_back(std::move(row));
+            }
+        }
+        catch( ... )
+        {
+            errors[i] = std::current_exception();
+        }
+        sqlite3_close(db);
+    };
+
+    const auto joinReaders = [&readers]()
+    {
+        for( std::thread & reader : readers )
+        {
+            reader.join();
+        }
+    };
+
+    // A connection of its own for each shard, as the writer's is busy writing. Starting a thread can fail, and the
+    // readers already running must be joined before what they write to goes away.
+    try
+    {
+        for(size_t i = 0; i < m_shards.size(); i++)
+        {
+            readers.emplace_back(readShard, i);
+        }
+    }
+    catch( ... )
+    {
+        joinReaders();
+        throw;
+    }
+    joinReaders();
+
+    for( std::exception_ptr & error : errors )
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<SqlRow> merged;
+    for( std::vector<SqlRow> & result : results )
+    {
+        const size_t sorted = merged.size();
+        std::move(result.begin(), result.end(), std::back_inserter(merged));
+
+        if( mergeColumn >= 0 )
+        {
+            const size_t column = static_cast<size_t>(mergeColumn);
+            std::inplace_merge(merged.begin(), merged.begin() + sorted, merged.end(), [column](const SqlRow & left, const SqlRow & right)
+            {
+                return value_less(left.at(column), right.at(column));
+            });
+        }
+    }
+
+    return merged;
+}
@@ -0,0 +1,91 @@
+#ifndef APP_SHARDED_WRITER_HPP
+#define APP_SHARDED_WRITER_HPP
+
+#include "sqlite_extensions/uuid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+/*
+* A value bound to or read from sqlite: NULL (std::monostate), integer, real, text or blob
+*/
+typedef std::variant<std::monostate, int64_t, double, std::string, std::vector<unsigned char>> SqlValue;
+typedef std::vector<SqlValue> SqlRow;
+
+struct ShardedWriterOptions
+{
+    size_t batchRows = 1000;        // rows per transaction, at most
+    size_t queueRows = 100000;      // rows waiting for a shard before insert() blocks
+};
+
+/*
+* Spreads UUID-keyed rows over several database files, so each has its own write lock and inserts scale with the number
+* of shards rather than queueing for one.
+*
+* Every row goes to the shard sqlite3UuidShard() picks for its UUID, the same one uuid_shard() gives in SQL, so a row can
+* be found again without asking every shard. Each shard has a writer thread with its own connection and prepared insert,
+* which commits whatever rows are waiting, up to batchRows, in one transaction. The databases are in WAL mode, so queries
+* read alongside the writers.
+*
+* Errors on the writer threads are rethrown, as std::runtime_error, by the next call to insert() or flush(). The rows of the
+* batch that failed are not written.
+*/
+class ShardedWriter
+{
+public:
+    /*
+    * Opens, or creates, shards databases named <basePath>-<shard>.db and runs schema on each, which must not fail if it
+    * has already run, so CREATE TABLE IF NOT EXISTS and the like. insertSql is run for every row, with the 16-byte UUID as
+    * ?1 and the row's values from ?2 on. Throws std::runtime_error on failure.
+    */
+    ShardedWriter(const std::string & basePath, int shards, const std::string & schema, const std::string & insertSql,
+        const ShardedWriterOptions & options = ShardedWriterOptions());
+
+    /*
+    * Writes every row still waiting, then closes the databases
+    */
+    ~ShardedWriter();
+
+    ShardedWriter(const ShardedWriter &) = delete;
+    ShardedWriter & operator=(const ShardedWriter &) = delete;
+
+    int shards() const;
+    std::string shardPath(int shard) const;
+
+    /*
+    * Queues a row for the shard of its UUID, blocking while that shard already has queueRows waiting
+    */
+    void insert(const Uuid & uuid, SqlRow values);
+
+    /*
+    * Waits until every row inserted so far is committed
+    */
+    void flush();
+
+    /*
+    * Runs sql on every shard at once and returns all of the rows. If mergeColumn is not negative, each shard's rows must
+    * already be in order of that column, with an ORDER BY, and they are merged into one ordered list. Values are ordered
+    * as sqlite orders them with the BINARY collation: NULL first, then integers and reals together by value, then text and
+    * then blobs by their bytes.
+    * Rows that are only queued are not seen, so call flush() first to read them back.
+    */
+    std::vector<SqlRow> query(const std::string & sql, int mergeColumn = -1);
+
+private:
+    struct Shard;
+
+    /*
+    * Tells every writer thread to stop once its queue is empty, and joins those that were started
+    */
+    void stopWriters();
+
+    std::string m_basePath;
+    ShardedWriterOptions m_options;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "sqlitehelpers.hpp"
+
+#include "sqlite_extensions/uuidcarray.hpp"
+
+#include <stdexcept>
+
+
+Statement::Statement(sqlite3 * db, const std::string & sql)
+    : m_db(db)
+    , m_statement(nullptr)
+{
+    if( sqlite3_prepare_v2(db, sql.c_str(), -1, &m_statement, nullptr) != SQLITE_OK )
+    {
+        throw std::runtime_error(std::string(sqlite3_errmsg(db)) + " in: " + sql);
+    }
+}
+
+Statement::~Statement()
+{
+    sqlite3_finalize(m_statement);
+}
+
+bool Statement::step()
+{
+    const int returnCode = sqlite3_step(m_statement);
+    if( returnCode == SQLITE_ROW )
+    {
+        return true;
+    }
+
+    if( returnCode != SQLITE_DONE )
+    {
+        const std::string message = sqlite3_errmsg(m_db);
+        sqlite3_reset(m_statement);
+        throw std::runtime_error(message);
+    }
+
+    return false;
+}
+
+void Statement::reset()
+{
+    sqlite3_reset(m_statement);
+}
+
+void Statement::bind(int index, sqlite3_int64 value)
+{
+    sqlite3_bind_int64(m_statement, index, value);
+}
+
+void Statement::bind(int index, const std::string & value)
+{
+    sqlite3_bind_text(m_statement, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+}
+
+void Statement::bind(int index, const Uuid & value)
+{
+    sqlite3_bind_blob(m_statement, index, value.bytes.data(), 16, SQLITE_STATIC);
+}
+
+void Statement::bind(int index, std::span<const Uuid> values)
+{
+    // Binding does not always set the connection's error, running out of memory before binding for one, so the message
+    // comes from the return code
+    const int returnCode = sqlite3UuidBindCarray(m_statement, index, reinterpret_cast<const unsigned char *>(values.data()), values.size());
+    if( returnCode != SQLITE_OK )
+    {
+        throw std::runtime_error(std::string("Could not bind ") + std::to_string(values.size()) + " UUIDs to parameter "
+            + std::to_string(index) + ": " + sqlite3_errstr(returnCode));
+    }
+}
+
+sqlite3_int64 Statement::columnInt(int index)
+{
+    return sqlite3_column_int64(m_statement, index);
+}
+
+std::string Statement::columnText(int index)
+{
+    const unsigned char * text = sqlite3_column_text(m_statement, index);
+    return text == nullptr ? std::string() : std::string(reinterpret_cast<const char *>(text), static_cast<size_t>(sqlite3_column_bytes(m_statement, index)));
+}
+
+Uuid Statement::columnUuid(int index)
+{
+    // The type is checked first, as reading the blob of another type converts it
+    if( sqlite3_column_type(m_statement, index) != SQLITE_BLOB || sqlite3_column_bytes(m_statement, index) != 16 )
+    {
+        throw std::runtime_error("Column " + std::to_string(index) + " is not a 16-byte UUID");
+    }
+    return Uuid::fromBytes(reinterpret_cast<const unsigned char *>(sqlite3_column_blob(m_statement, index)));
+}
+
+bool Statement::columnIsNull(int index)
+{
+    return sqlite3_column_type(m_statement, index) == SQLITE_NULL;
+}
+
+sqlite3 * open_database(const std::string & path, bool create)
+{
+    sqlite3 * db = nullptr;
+    if( sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | (create ? SQLITE_OPEN_CREATE : 0), nullptr) != SQLITE_OK )
+    {
+        const std::string message = db == nullptr ? "out of memory" : sqlite3_errmsg(db);
+        sqlite3_close(db);
+        throw std::runtime_error("Could not open " + path + ": " + message);
+    }
+
+    sqlite3_busy_timeout(db, 5000);
+
+    return db;
+}
+
+void exec(sqlite3 * db, const std::string & sql)
+{
+    char * errorMessage = nullptr;
+    if( sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errorMessage) != SQLITE_OK )
+    {
+        const std::string message = errorMessage == nullptr ? sqlite3_errmsg(db) : errorMessage;
+        sqlite3_free(errorMessage);
+        throw std::runtime_error(message + " in: " + sql);
+    }
+}
+
+void read_uuids(Statement & statement, int column, std::vector<Uuid> & uuids)
+{
+    while( statement.step() )
+    {
+        uuids.push_back(statement.columnUuid(column));
+    }
+}
+
+std::string quote_identifier(const std::string & name)
+{
+    std::string quoted = "\"";
+    for( char character : name )
+    {
+        quoted += character;
+        if( character == '"' )
+        {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
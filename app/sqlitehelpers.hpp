@@ -0,0 +1,112 @@
+#ifndef APP_SQLITE_HELPERS_HPP
+#define APP_SQLITE_HELPERS_HPP
+
+#include "sqlite_extensions/uuid.hpp"
+
+#include <sqlite3.h>
+
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+* The maintenance commands talk to sqlite directly rather than through soci, because they need the connection itself for
+* things soci does not expose, like sqlite3_changes() and progress handlers.
+* Everything here throws std::runtime_error, with sqlite's message, on failure.
+*/
+
+/*
+* Owns a prepared statement, finalizing it when it goes out of scope
+*/
+class Statement
+{
+public:
+    Statement(sqlite3 * db, const std::string & sql);
+    ~Statement();
+
+    Statement(const Statement &) = delete;
+    Statement & operator=(const Statement &) = delete;
+
+    /*
+    * Steps the statement, returning true while there is a row to read
+    */
+    bool step();
+
+    /*
+    * Resets the statement so it can be stepped again, keeping its bindings
+    */
+    void reset();
+
+    void bind(int index, sqlite3_int64 value);
+    void bind(int index, const std::string & value);
+
+    /*
+    * Binds a UUID as a 16-byte blob. It is not copied, so it must stay where it is until the statement is reset or
+    * finalized, or the parameter is rebound.
+    */
+    void bind(int index, const Uuid & value);
+
+    /*
+    * Binds an array of UUIDs for uuid_carray() to read, so a statement like
+    *     INSERT INTO t(id) SELECT uuid_blob FROM uuid_carray(?1)
+    * writes all of them in one step. They are not copied either, with the same lifetime as above.
+    */
+    void bind(int index, std::span<const Uuid> values);
+
+    sqlite3_int64 columnInt(int index);
+    std::string columnText(int index);
+
+    /*
+    * Reads a 16-byte blob column, throwing if it holds anything else
+    */
+    Uuid columnUuid(int index);
+    bool columnIsNull(int index);
+
+    sqlite3_stmt * handle() { return m_statement; }
+
+private:
+    sqlite3 * m_db;
+    sqlite3_stmt * m_statement;
+};
+
+/*
+* Opens a connection, which the UUID extension is registered with when it was added as an auto extension, creating the
+* database if create is true. It waits up to five seconds for a lock held by another connection before giving up.
+*/
+sqlite3 * open_database(const std::string & path, bool create = false);
+
+/*
+* Runs sql that returns no rows
+*/
+void exec(sqlite3 * db, const std::string & sql);
+
+/*
+* Runs body in a transaction taking the write lock up front, rolling it back if body throws
+*/
+template<typename Body>
+void in_transaction(sqlite3 * db, Body body)
+{
+    exec(db, "BEGIN IMMEDIATE");
+    try
+    {
+        body();
+        exec(db, "COMMIT");
+    }
+    catch( ... )
+    {
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        throw;
+    }
+}
+
+/*
+* Steps statement until it is done, appending the UUID in column of every row to uuids
+*/
+void read_uuids(Statement & statement, int column, std::vector<Uuid> & uuids);
+
+/*
+* Quotes a table, column or index name for use in sql
+*/
+std::string quote_identifier(const std::string & name);
+
+#endif
@@ -0,0 +1,165 @@
+#include "uuidbackfill.hpp"
+#include "sqlitehelpers.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+
+namespace
+{
+    // How often the progress handler looks at the clock, in virtual machine instructions
+    const int PROGRESS_INTERVAL = 1000;
+
+    int past_deadline(void * deadline)
+    {
+        return std::chrono::steady_clock::now() > *reinterpret_cast<std::chrono::steady_clock::time_point *>(deadline);
+    }
+
+    void create_checkpoint_table(sqlite3 * db)
+    {
+        exec(db, "CREATE TABLE IF NOT EXISTS uuid_batch_checkpoint(name TEXT PRIMARY KEY, last_rowid INTEGER NOT NULL)");
+    }
+}
+
+BatchReport run_in_batches(sqlite3 * db, const std::string & table, const std::string & checkpoint, const std::string & update, const BatchOptions & options)
+{
+    if( options.batchRows < 1 )
+    {
+        throw std::runtime_error("The batch size must be at least one row");
+    }
+
+    create_checkpoint_table(db);
+
+    Statement lastRowid(db, "SELECT last_rowid FROM uuid_batch_checkpoint WHERE name = ?");
+    lastRowid.bind(1, checkpoint);
+    Statement batchEnd(db, "SELECT max(rowid) FROM (SELECT rowid FROM " + quote_identifier(table) + " WHERE rowid > ? ORDER BY rowid LIMIT ?)");
+    Statement updateBatch(db, update);
+    Statement saveCheckpoint(db, "INSERT OR REPLACE INTO uuid_batch_checkpoint VALUES (?, ?)");
+    saveCheckpoint.bind(1, checkpoint);
+
+    BatchReport report = {0, 0, 0};
+    int64_t batchRows = options.batchRows;
+    bool finished = false;
+    bool quick = false;
+
+    while( !finished )
+    {
+        bool interrupted = false;
+
+        try
+        {
+            in_transaction(db, [&]()
+            {
+                // Read inside the transaction, so a second run on another connection carries on after this one's last batch
+                const sqlite3_int64 first = lastRowid.step() ? lastRowid.columnInt(0) : INT64_MIN;
+                lastRowid.reset();
+
+                batchEnd.bind(1, first);
+                batchEnd.bind(2, static_cast<sqlite3_int64>(batchRows));
+                batchEnd.step();
+                finished = batchEnd.columnIsNull(0);
+                const sqlite3_int64 last = batchEnd.columnInt(0);
+                batchEnd.reset();
+
+                if( finished )
+                {
+                    return;
+                }
+
+                const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point deadline = started + options.maxBatchTime;
+                sqlite3_progress_handler(db, PROGRESS_INTERVAL, past_deadline, &deadline);
+                updateBatch.bind(1, first);
+                updateBatch.bind(2, last);
+
+                try
+                {
+                    updateBatch.step();
+                }
+                catch( const std::runtime_error & e )
+                {
+                    interrupted = sqlite3_errcode(db) == SQLITE_INTERRUPT;
+                    sqlite3_progress_handler(db, 0, nullptr, nullptr);
+                    updateBatch.reset();
+
+                    throw std::runtime_error(std::string(e.what()) + " updating " + table + " in rowids " +
+                        std::to_string(first == INT64_MIN ? 1 : first + 1) + " to " + std::to_string(last));
+                }
+
+                sqlite3_progress_handler(db, 0, nullptr, nullptr);
+                updateBatch.reset();
+                quick = std::chrono::steady_clock::now() - started < options.maxBatchTime / 2;
+                report.rowsChanged += sqlite3_changes(db);
+
+                saveCheckpoint.bind(2, last);
+                saveCheckpoint.step();
+                saveCheckpoint.reset();
+            });
+        }
+        catch( const std::runtime_error & )
+        {
+            if( !interrupted || batchRows == 1 )
+            {
+                throw;
+            }
+
+            // Rolled back, so try again with fewer rows
+            report.interruptedBatches++;
+            batchRows = std::max<int64_t>(1, batchRows / 2);
+            continue;
+        }
+
+        if( !finished )
+        {
+            report.batches++;
+            if( quick )
+            {
+                // Only grows with room to spare, so the size settles rather than being interrupted every other batch
+                batchRows = std::min(options.batchRows, batchRows * 2);
+            }
+            std::this_thread::sleep_for(options.pause);
+        }
+    }
+
+    return report;
+}
+
+void clear_batch_checkpoint(sqlite3 * db, const std::string & checkpoint)
+{
+    create_checkpoint_table(db);
+
+    Statement forget(db, "DELETE FROM uuid_batch_checkpoint WHERE name = ?");
+    forget.bind(1, checkpoint);
+    forget.step();
+}
+
+BatchReport backfill_uuid_column(sqlite3 * db, const std::string & table, const std::string & column, const std::string & generator, const BatchOptions & options)
+{
+    // The default as written in the schema, which is an SQL expression, or NULL when there is none
+    std::string defaultValue = "NULL";
+    bool hasColumn = false;
+    {
+        Statement columnInfo(db, "SELECT dflt_value FROM pragma_table_info(?) WHERE name = ?");
+        columnInfo.bind(1, table);
+        columnInfo.bind(2, column);
+        if( columnInfo.step() )
+        {
+            hasColumn = true;
+            if( !columnInfo.columnIsNull(0) )
+            {
+                defaultValue = columnInfo.columnText(0);
+            }
+        }
+    }
+
+    if( !hasColumn )
+    {
+        throw std::runtime_error("No such column: " + table + "." + column);
+    }
+
+    const std::string quotedColumn = quote_identifier(column);
+    return run_in_batches(db, table, "uuid_backfill " + table + "." + column,
+        "UPDATE " + quote_identifier(table) + " SET " + quotedColumn + " = " + generator + " "
+        "WHERE rowid > ?1 AND rowid <= ?2 AND (" + quotedColumn + " IS NULL OR " + quotedColumn + " IS (" + defaultValue + "))", options);
+}
@@ -0,0 +1,59 @@
+#ifndef APP_UUID_BACKFILL_HPP
+#define APP_UUID_BACKFILL_HPP
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct BatchOptions
+{
+    int64_t batchRows = 10000;                                   // rows per batch to start with, and at most
+    std::chrono::milliseconds maxBatchTime{100};                 // longer batches are interrupted and retried with fewer rows
+    std::chrono::milliseconds pause{10};                         // between batches, for other connections to get the lock
+};
+
+struct BatchReport
+{
+    int64_t rowsChanged;
+    int64_t batches;
+    int64_t interruptedBatches;
+};
+
+/*
+* Runs an UPDATE over a table's rows in rowid order, a batch at a time, instead of in one statement holding the write lock
+* for as long as the whole table takes and growing the WAL by all of it.
+*
+* update must change only rows with a rowid above ?1 and up to ?2, the bounds of each batch. Every batch is its own
+* transaction, and the connection sleeps for options.pause after each one so other connections can read and write
+* in between.
+*
+* A progress handler interrupts any batch running longer than options.maxBatchTime. It is rolled back and retried with half
+* as many rows, and the batch size grows back towards options.batchRows while batches finish in under half that time.
+*
+* The last rowid done is saved in the uuid_batch_checkpoint table under the name checkpoint, in the same transaction as
+* the batch, and later runs start after it. It is kept once the table is done, so a finished run is not repeated, until
+* clear_batch_checkpoint() is called.
+*
+* Throws std::runtime_error on failure, including when a single row takes longer than options.maxBatchTime, leaving the
+* checkpoint at the last batch committed.
+*/
+BatchReport run_in_batches(sqlite3 * db, const std::string & table, const std::string & checkpoint, const std::string & update, const BatchOptions & options);
+
+/*
+* Forgets a checkpoint saved by run_in_batches(), so the next run with that name starts from the first row again
+*/
+void clear_batch_checkpoint(sqlite3 * db, const std::string & checkpoint);
+
+/*
+* Gives every row of a table a UUID in column, where it is NULL or still holds the column's default, using
+* run_in_batches() under the checkpoint name "uuid_backfill <table>.<column>".
+*
+* generator is the SQL expression producing each value: uuid(), or uuid7() so rows filled together are also next to each
+* other in an index on the column, or uuid7_blob() for a blob column. Rows that already have a value keep it, so running
+* it again only fills rows added since.
+*/
+BatchReport backfill_uuid_column(sqlite3 * db, const std::string & table, const std::string & column, const std::string & generator, const BatchOptions & options);
+
+#endif
@@ -0,0 +1,250 @@
+#include "uuidmigration.hpp"
+#include "sqlitehelpers.hpp"
+#include "uuidbackfill.hpp"
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+namespace
+{
+    const StorageStats UNMEASURED = {-1, -1, -1};
+
+    /*
+    * is_uuid_text(X): 1 if X is text that uuid_blob() accepts, otherwise 0, so the migration can pass over anything else
+    * rather than fail on it
+    */
+    void is_uuid_text(sqlite3_context * context, int argc, sqlite3_value ** argv)
+    {
+        (void)argc;
+
+        unsigned char bytes[16];
+        const unsigned char * text = sqlite3_value_text(argv[0]);
+        sqlite3_result_int(context, sqlite3_value_type(argv[0]) == SQLITE_TEXT && text != nullptr &&
+            sqlite3UuidStrToBlob(text, static_cast<size_t>(sqlite3_value_bytes(argv[0])), bytes) == 0);
+    }
+
+    /*
+    * Measures the b-trees with the given names, summing their sizes. Paths in dbstat have four characters a level.
+    */
+    StorageStats measure(sqlite3 * db, const std::vector<std::string> & names)
+    {
+        StorageStats stats = {0, 0, 0};
+
+        try
+        {
+            Statement statement(db, "SELECT sum(pgsize), sum(payload), max(CASE WHEN pagetype <> 'overflow' THEN (length(path) + 3) / 4 END) "
+                "FROM dbstat WHERE name = ?");
+
+            for( const std::string & name : names )
+            {
+                statement.bind(1, name);
+                if( statement.step() )
+                {
+                    stats.pageBytes += statement.columnInt(0);
+                    stats.payloadBytes += statement.columnInt(1);
+                    stats.depth = std::max(stats.depth, static_cast<int>(statement.columnInt(2)));
+                }
+                statement.reset();
+            }
+        }
+        catch( const std::runtime_error & )
+        {
+            // No dbstat in this build of sqlite
+            return UNMEASURED;
+        }
+
+        return stats;
+    }
+
+    std::vector<std::string> saved_index_names(sqlite3 * db, const std::string & table, const std::string & column)
+    {
+        Statement statement(db, "SELECT index_name FROM uuid_migration_index WHERE table_name = ? AND column_name = ?");
+        statement.bind(1, table);
+        statement.bind(2, column);
+
+        std::vector<std::string> names;
+        while( statement.step() )
+        {
+            names.push_back(statement.columnText(0));
+        }
+        return names;
+    }
+
+    std::string checkpoint_name(const std::string & table, const std::string & column)
+    {
+        return "uuid_migration " + table + "." + column;
+    }
+
+    /*
+    * The statements are finalized on return, as sqlite refuses to change the schema while any are reading it
+    */
+    void check_column(sqlite3 * db, const std::string & table, const std::string & column)
+    {
+        Statement withoutRowid(db, "SELECT wr FROM pragma_table_list WHERE name = ? AND schema = 'main'");
+        withoutRowid.bind(1, table);
+        if( !withoutRowid.step() )
+        {
+            throw std::runtime_error("No such table: " + table);
+        }
+        if( withoutRowid.columnInt(0) != 0 )
+        {
+            throw std::runtime_error("Tables without a rowid are not supported: " + table);
+        }
+
+        Statement hasColumn(db, "SELECT 1 FROM pragma_table_info(?) WHERE name = ?");
+        hasColumn.bind(1, table);
+        hasColumn.bind(2, column);
+        if( !hasColumn.step() )
+        {
+            throw std::runtime_error("No such column: " + table + "." + column);
+        }
+    }
+
+    /*
+    * Records the migration and drops the indexes on the column, unless an earlier run got that far
+    */
+    void start(sqlite3 * db, const std::string & table, const std::string & column)
+    {
+        in_transaction(db, [&]()
+        {
+            Statement started(db, "SELECT 1 FROM uuid_migration WHERE table_name = ? AND column_name = ?");
+            started.bind(1, table);
+            started.bind(2, column);
+            if( started.step() )
+            {
+                return;
+            }
+
+            check_column(db, table, column);
+
+            // Indexes created by a PRIMARY KEY or UNIQUE constraint have no sql and cannot be dropped, so they stay and
+            // are updated along with the rows. Unique indexes stay too: two spellings of a UUID, like upper and lower
+            // case, are distinct as text but the same blob, and with the index in place the batch converting them fails
+            // with its rowids, rather than the index failing to be created again once every row is converted. It also
+            // keeps other writers from adding duplicates while the migration runs.
+            Statement indexes(db, "SELECT m.name, m.sql FROM sqlite_schema AS m "
+                "WHERE m.type = 'index' AND m.tbl_name = ?1 AND m.sql IS NOT NULL "
+                "AND EXISTS (SELECT 1 FROM pragma_index_xinfo(m.name) WHERE name = ?2) "
+                "AND NOT EXISTS (SELECT 1 FROM pragma_index_list(?1) AS l WHERE l.name = m.name AND l.\"unique\")");
+            indexes.bind(1, table);
+            indexes.bind(2, column);
+
+            std::vector<std::string> names;
+            Statement saveIndex(db, "INSERT INTO uuid_migration_index VALUES (?, ?, ?, ?)");
+            while( indexes.step() )
+            {
+                names.push_back(indexes.columnText(0));
+
+                saveIndex.bind(1, table);
+                saveIndex.bind(2, column);
+                saveIndex.bind(3, indexes.columnText(0));
+                saveIndex.bind(4, indexes.columnText(1));
+                saveIndex.step();
+                saveIndex.reset();
+            }
+
+            const StorageStats tableStats = measure(db, {table});
+            const StorageStats indexStats = measure(db, names);
+
+            Statement record(db, "INSERT INTO uuid_migration VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+            record.bind(1, table);
+            record.bind(2, column);
+            record.bind(3, tableStats.pageBytes);
+            record.bind(4, tableStats.payloadBytes);
+            record.bind(5, static_cast<sqlite3_int64>(tableStats.depth));
+            record.bind(6, indexStats.pageBytes);
+            record.bind(7, indexStats.payloadBytes);
+            record.bind(8, static_cast<sqlite3_int64>(indexStats.depth));
+            record.step();
+
+            for( const std::string & name : names )
+            {
+                exec(db, "DROP INDEX " + quote_identifier(name));
+            }
+        });
+    }
+
+    /*
+    * Creates the dropped indexes again, fills in the sizes from before and after, and forgets the migration
+    */
+    void finish(sqlite3 * db, const std::string & table, const std::string & column, UuidMigrationReport & report)
+    {
+        in_transaction(db, [&]()
+        {
+            std::vector<std::string> indexSql;
+            {
+                Statement indexes(db, "SELECT sql FROM uuid_migration_index WHERE table_name = ? AND column_name = ?");
+                indexes.bind(1, table);
+                indexes.bind(2, column);
+                while( indexes.step() )
+                {
+                    indexSql.push_back(indexes.columnText(0));
+                }
+            }
+
+            for( const std::string & sql : indexSql )
+            {
+                exec(db, sql);
+            }
+
+            Statement before(db, "SELECT table_page_bytes, table_payload_bytes, table_depth, index_page_bytes, index_payload_bytes, index_depth "
+                "FROM uuid_migration WHERE table_name = ? AND column_name = ?");
+            before.bind(1, table);
+            before.bind(2, column);
+            before.step();
+            report.tableBefore = {before.columnInt(0), before.columnInt(1), static_cast<int>(before.columnInt(2))};
+            report.indexesBefore = {before.columnInt(3), before.columnInt(4), static_cast<int>(before.columnInt(5))};
+
+            const std::string quotedColumn = quote_identifier(column);
+            Statement skipped(db, "SELECT count(*) FROM " + quote_identifier(table) + " WHERE " + quotedColumn + " IS NOT NULL "
+                "AND NOT (typeof(" + quotedColumn + ") = 'blob' AND length(" + quotedColumn + ") = 16)");
+            skipped.step();
+            report.valuesSkipped = skipped.columnInt(0);
+
+            report.tableAfter = measure(db, {table});
+            report.indexesAfter = measure(db, saved_index_names(db, table, column));
+
+            for( const char * progressTable : {"uuid_migration_index", "uuid_migration"} )
+            {
+                Statement forget(db, std::string("DELETE FROM ") + progressTable + " WHERE table_name = ? AND column_name = ?");
+                forget.bind(1, table);
+                forget.bind(2, column);
+                forget.step();
+            }
+
+            clear_batch_checkpoint(db, checkpoint_name(table, column));
+        });
+    }
+}
+
+UuidMigrationReport migrate_uuid_column(sqlite3 * db, const std::string & table, const std::string & column, const BatchOptions & options)
+{
+    exec(db, "CREATE TABLE IF NOT EXISTS uuid_migration("
+        "table_name TEXT NOT NULL, column_name TEXT NOT NULL, "
+        "table_page_bytes INTEGER, table_payload_bytes INTEGER, table_depth INTEGER, "
+        "index_page_bytes INTEGER, index_payload_bytes INTEGER, index_depth INTEGER, "
+        "PRIMARY KEY(table_name, column_name))");
+    exec(db, "CREATE TABLE IF NOT EXISTS uuid_migration_index("
+        "table_name TEXT NOT NULL, column_name TEXT NOT NULL, index_name TEXT NOT NULL, sql TEXT NOT NULL, "
+        "PRIMARY KEY(table_name, column_name, index_name))");
+
+    if( sqlite3_create_function(db, "is_uuid_text", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, is_uuid_text, nullptr, nullptr) != SQLITE_OK )
+    {
+        throw std::runtime_error(sqlite3_errmsg(db));
+    }
+
+    UuidMigrationReport report = {};
+    start(db, table, column);
+
+    const std::string quotedColumn = quote_identifier(column);
+    report.rowsConverted = run_in_batches(db, table, checkpoint_name(table, column),
+        "UPDATE " + quote_identifier(table) + " SET " + quotedColumn + " = uuid_blob(" + quotedColumn + ") "
+        "WHERE rowid > ?1 AND rowid <= ?2 AND typeof(" + quotedColumn + ") = 'text' AND is_uuid_text(" + quotedColumn + ")", options).rowsChanged;
+
+    finish(db, table, column, report);
+    return report;
+}
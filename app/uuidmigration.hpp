@@ -0,0 +1,59 @@
+#ifndef APP_UUID_MIGRATION_HPP
+#define APP_UUID_MIGRATION_HPP
+
+#include "uuidbackfill.hpp"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+
+/*
+* Size of a table or of the indexes on a column, as measured with the dbstat virtual table.
+* Every member is -1 when sqlite was built without dbstat.
+*/
+struct StorageStats
+{
+    int64_t pageBytes;      // bytes of the pages in use
+    int64_t payloadBytes;   // bytes of the records stored in them
+    int depth;              // levels in the b-tree, the deepest of them for several indexes
+};
+
+struct UuidMigrationReport
+{
+    int64_t rowsConverted;  // by this run, which may have resumed an earlier one
+    int64_t valuesSkipped;  // left as they were, as they are neither NULL, a 16-byte blob nor a UUID as text
+    StorageStats tableBefore;
+    StorageStats tableAfter;
+    StorageStats indexesBefore;
+    StorageStats indexesAfter;
+};
+
+/*
+* Converts a column of text UUIDs to 16-byte blobs in place, with uuid_blob(), while the database stays in use.
+*
+* The indexes on the column are dropped first, so converting the rows does not scatter writes across them, and created
+* again once every row is converted. Creating an index sorts its keys, so it is rebuilt in key order with full pages.
+* Unique indexes are left in place, and only those that are dropped are measured in the report. Values that are the same
+* UUID spelled differently, like in upper and lower case, collide in them once converted, which fails that batch.
+* Rows are converted with run_in_batches(), so no lock is held for longer than one batch takes.
+*
+* Progress is kept in the uuid_migration and uuid_migration_index tables and the batch checkpoint, in the same database and
+* the same transactions as the changes, so running it again after an interruption carries on from the last committed batch. The sizes from before
+* the first run are kept there too, so the report covers the whole migration.
+*
+* Text in any form uuid_blob() accepts is converted. Any other value is left as it was, such as a placeholder default like
+* '0' that was never replaced, and counted in valuesSkipped once the migration is done, so they can be found and fixed with
+*     SELECT rowid, <column> FROM <table> WHERE <column> IS NOT NULL AND NOT (typeof(<column>) = 'blob' AND length(<column>) = 16)
+* If a batch fails, std::runtime_error is thrown with the rowids of that batch, leaving the migration ready to resume.
+*
+* The space freed in the table's own pages is reused by later writes, but the pages themselves are only given back by a
+* VACUUM, so the table's page bytes barely move until then while its payload bytes drop straight away.
+*
+* The declared type of the column is not changed, as sqlite cannot do that without copying the table. It makes no
+* difference to what can be stored, as a column of TEXT affinity keeps blobs as they are.
+* Tables without a rowid are not supported. Throws std::runtime_error on failure.
+*/
+UuidMigrationReport migrate_uuid_column(sqlite3 * db, const std::string & table, const std::string & column, const BatchOptions & options);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef APP_UUID_SOCI_HPP
+#define APP_UUID_SOCI_HPP
+
+#include "sqlite_extensions/uuid.hpp"
+
+#include <soci/soci.h>
+
+#include <optional>
+#include <string>
+
+namespace soci
+{
+    /*
+    * Lets a Uuid be used with soci::use() and soci::into(), for one row at a time:
+    *     session << "INSERT INTO t(id) VALUES (uuid_blob(:id))", soci::use(uuid);
+    *     session << "SELECT uuid_str(id) FROM t", soci::into(uuid);
+    *
+    * It goes through the canonical text rather than the 16 bytes, because soci's sqlite3 backend binds and reads a
+    * std::string as text, which a zero byte in the middle of a UUID would cut short. uuid_blob() and uuid_str() convert
+    * on the sqlite side, so a blob column still holds a blob, at the cost of formatting and parsing each UUID once.
+    *
+    * Vectors of Uuids are not supported: the backend has no vector form for blobs, and uuid_carray() needs a pointer
+    * bound with sqlite3_bind_pointer(), which soci cannot do. Bulk reads and writes go through Statement, whose
+    * bind(std::span<const Uuid>) and read_uuids() in sqlitehelpers.hpp move the 16 bytes without any text.
+    */
+    template<>
+    struct type_conversion<Uuid>
+    {
+        typedef std::string base_type;
+
+        static void from_base(const std::string & text, indicator ind, Uuid & uuid)
+        {
+            if( ind == i_null )
+            {
+                throw soci_error("NULL where a UUID was expected");
+            }
+
+            const std::optional<Uuid> parsed = Uuid::fromString(text);
+            if( !parsed )
+            {
+                throw soci_error("Not a canonical UUID: " + text);
+            }
+            uuid = *parsed;
+        }
+
+        static void to_base(const Uuid & uuid, std::string & text, indicator & ind)
+        {
+            text = uuid.toString();
+            ind = i_ok;
+        }
+    };
+}
+
+#endif
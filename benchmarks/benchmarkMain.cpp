@@ -0,0 +1,131 @@
+#include "benchmarkSupport.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+
+namespace
+{
+    sqlite3_mem_methods defaultMemMethods;
+
+    /*
+    * The count is spread over a slot per cache line, picked by thread, so the multi-threaded benchmarks measure contention
+    * in sqlite and the extension rather than threads fighting over the counter
+    */
+    const size_t ALLOCATION_COUNT_SLOTS = 64;
+
+    struct alignas(64) AllocationCountSlot
+    {
+        std::atomic<uint64_t> count;
+    };
+
+    AllocationCountSlot allocationCounts[ALLOCATION_COUNT_SLOTS];
+
+    void countAllocation()
+    {
+        static thread_local const size_t slot = std::hash<std::thread::id>()(std::this_thread::get_id()) % ALLOCATION_COUNT_SLOTS;
+        allocationCounts[slot].count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void * countingMalloc(int size)
+    {
+        countAllocation();
+        return defaultMemMethods.xMalloc(size);
+    }
+
+    void * countingRealloc(void * pointer, int size)
+    {
+        countAllocation();
+        return defaultMemMethods.xRealloc(pointer, size);
+    }
+
+    /*
+    * Wraps sqlite's default allocator with one that counts. This must happen before sqlite is initialized, and the default
+    * methods are only filled in by initializing, hence the initialize and shutdown first.
+    */
+    void installCountingAllocator()
+    {
+        sqlite3_initialize();
+        sqlite3_shutdown();
+        sqlite3_config(SQLITE_CONFIG_GETMALLOC, &defaultMemMethods);
+
+        sqlite3_mem_methods countingMemMethods = defaultMemMethods;
+        countingMemMethods.xMalloc = countingMalloc;
+        countingMemMethods.xRealloc = countingRealloc;
+        sqlite3_config(SQLITE_CONFIG_MALLOC, &countingMemMethods);
+    }
+}
+
+void benchExec(sqlite3 * db, const std::string & sql)
+{
+    char * errorMessage = nullptr;
+    if( sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errorMessage) != SQLITE_OK )
+    {
+        std::string message = errorMessage ? errorMessage : "unknown error";
+        sqlite3_free(errorMessage);
+        throw std::runtime_error(message + " in: " + sql);
+    }
+}
+
+sqlite3_int64 benchQueryInt(sqlite3 * db, const char * sql)
+{
+    sqlite3_stmt * statement = nullptr;
+    sqlite3_int64 result = 0;
+
+    if( sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW )
+    {
+        result = sqlite3_column_int64(statement, 0);
+    }
+
+    sqlite3_finalize(statement);
+    return result;
+}
+
+sqlite3 * benchOpen(const char * path)
+{
+    sqlite3 * db = nullptr;
+    if( sqlite3_open(path, &db) != SQLITE_OK )
+    {
+        std::string message = sqlite3_errmsg(db);
+        sqlite3_close(db);
+        throw std::runtime_error(message);
+    }
+
+    return db;
+}
+
+uint64_t benchAllocationCount()
+{
+    uint64_t count = 0;
+    for( const AllocationCountSlot & slot : allocationCounts )
+    {
+        count += slot.count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+int main(int argc, char ** argv)
+{
+    installCountingAllocator();
+
+    // Register extention the same way the app does
+    typedef void(*pfnInitExtensionFunction)(void);
+    pfnInitExtensionFunction initExtension = (pfnInitExtensionFunction)sqlite3_uuid_init;
+    sqlite3_auto_extension(initExtension);
+
+    benchmark::Initialize(&argc, argv);
+    if( benchmark::ReportUnrecognizedArguments(argc, argv) )
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
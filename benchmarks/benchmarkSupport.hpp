@@ -0,0 +1,30 @@
+#ifndef SQLITE_EXTENSIONS_BENCHMARK_SUPPORT_HPP
+#define SQLITE_EXTENSIONS_BENCHMARK_SUPPORT_HPP
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+
+/*
+* Runs sql that returns no rows, throwing std::runtime_error on failure
+*/
+void benchExec(sqlite3 * db, const std::string & sql);
+
+/*
+* Returns the first column of the first row of sql, or 0 if there is none
+*/
+sqlite3_int64 benchQueryInt(sqlite3 * db, const char * sql);
+
+/*
+* Opens a connection the UUID extension is registered with, throwing std::runtime_error on failure
+*/
+sqlite3 * benchOpen(const char * path);
+
+/*
+* Number of allocations, including reallocations, sqlite has made since the benchmarks started.
+* Counted by the allocator benchmarkMain.cpp installs ahead of sqlite's default one.
+*/
+uint64_t benchAllocationCount();
+
+#endif
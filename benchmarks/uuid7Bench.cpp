@@ -0,0 +1,81 @@
+#include "benchmarkSupport.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+
+
+/*
+* Compares inserting random version 4 keys against time-ordered version 7 keys into a 16-byte blob primary key.
+*
+* The table is WITHOUT ROWID, so its b-tree is the primary key index and the database page count is the index page count.
+* The page cache is deliberately kept small so that, as with a production-sized table, the index soon outgrows it.
+* Random keys then touch a different leaf for nearly every row, while time-ordered keys append to the right-most leaf.
+*/
+namespace
+{
+    const char * BENCH_DB_PATH = "uuid7_bench.db";
+    const int ROWS_PER_TRANSACTION = 10000;
+    const int CACHE_SIZE_KIB = 16384;
+
+    /*
+    * Inserts state.range(0) keys generated by keyExpression, ROWS_PER_TRANSACTION at a time, into a fresh database
+    */
+    void insertKeys(benchmark::State & state, const char * keyExpression)
+    {
+        const int64_t rowCount = state.range(0);
+        sqlite3_int64 pageCount = 0;
+        sqlite3_int64 pageSize = 0;
+
+        for( auto _ : state )
+        {
+            state.PauseTiming();
+            std::remove(BENCH_DB_PATH);
+
+            sqlite3 * db = benchOpen(BENCH_DB_PATH);
+
+            benchExec(db, "PRAGMA journal_mode=WAL");
+            benchExec(db, "PRAGMA synchronous=NORMAL");
+            benchExec(db, "PRAGMA cache_size=-" + std::to_string(CACHE_SIZE_KIB));
+            benchExec(db, "CREATE TABLE keys(id BLOB PRIMARY KEY) WITHOUT ROWID");
+
+            const std::string insert = 
+                "WITH RECURSIVE counter(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM counter WHERE x < " + std::to_string(ROWS_PER_TRANSACTION) + ") "
+                "INSERT INTO keys(id) SELECT " + keyExpression + " FROM counter";
+            state.ResumeTiming();
+
+            for( int64_t inserted = 0; inserted < rowCount; inserted += ROWS_PER_TRANSACTION )
+            {
+                benchExec(db, "BEGIN");
+                benchExec(db, insert);
+                benchExec(db, "COMMIT");
+            }
+
+            state.PauseTiming();
+            benchExec(db, "PRAGMA wal_checkpoint(TRUNCATE)");
+            pageCount = benchQueryInt(db, "PRAGMA page_count");
+            pageSize = benchQueryInt(db, "PRAGMA page_size");
+            sqlite3_close(db);
+            std::remove(BENCH_DB_PATH);
+            state.ResumeTiming();
+        }
+
+        state.counters["rows_per_second"] = benchmark::Counter(static_cast<double>(rowCount), benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["index_pages"] = static_cast<double>(pageCount);
+        state.counters["index_bytes_per_row"] = static_cast<double>(pageCount * pageSize) / static_cast<double>(rowCount);
+    }
+
+    void BM_InsertUuid4Keys(benchmark::State & state)
+    {
+        insertKeys(state, "uuid_blob(uuid())");
+    }
+
+    void BM_InsertUuid7Keys(benchmark::State & state)
+    {
+        insertKeys(state, "uuid7_blob()");
+    }
+}
+
+BENCHMARK(BM_InsertUuid4Keys)->Arg(1000000)->Arg(10000000)->Iterations(1)->Unit(benchmark::kSecond);
+BENCHMARK(BM_InsertUuid7Keys)->Arg(1000000)->Arg(10000000)->Iterations(1)->Unit(benchmark::kSecond);
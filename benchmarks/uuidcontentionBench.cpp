@@ -0,0 +1,115 @@
+#include "benchmarkSupport.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*
+* Measures how the UUID functions scale with threads, each with its own connection, as the app runs one connection per
+* worker. Connections are opened with benchOpen(), so the extension comes from the same sqlite3_auto_extension()
+* registration main() makes. Every connection has its own in-memory database, so the only state the threads share is
+* sqlite's own (the allocator, the randomness behind randomblob()) and the extension's.
+*
+* Reported for each thread count:
+*
+*    items_per_second  - statements per second across all threads
+*    p99_ns            - 99th percentile latency of a single statement, across all threads
+*
+* The randomblob(16) workload is the baseline: it draws from sqlite's generator, which sits behind a global mutex,
+* while uuid() draws from the extension's thread-local pool.
+*/
+namespace
+{
+    const char * CONTENTION_WORKLOADS[] = {
+        "INSERT INTO keys VALUES (uuid())",
+        "INSERT INTO keys VALUES (uuid7())",
+        "SELECT uuid_blob('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11')",
+        "SELECT uuid_str(x'a0eebc999c0b4ef8bb6d6bb9bd380a11')",
+        "INSERT INTO keys VALUES (randomblob(16))"      // baseline
+    };
+
+    const int ROWS_PER_TRANSACTION = 1000;
+
+    /*
+    * Latencies from every thread of the current run, so the last thread to finish can report the percentile over all of them
+    */
+    std::mutex latenciesMutex;
+    std::vector<int64_t> latencies;
+    int threadsFinished = 0;
+
+    void BM_Contention(benchmark::State & state)
+    {
+        const char * sql = CONTENTION_WORKLOADS[state.range(0)];
+        sqlite3 * db = benchOpen(":memory:");
+        benchExec(db, "CREATE TABLE keys(id)");
+
+        sqlite3_stmt * statement = nullptr;
+        if( sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK )
+        {
+            state.SkipWithError(sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return;
+        }
+
+        std::vector<int64_t> threadLatencies;
+        threadLatencies.reserve(1 << 20);
+        int rowsInTransaction = 0;
+        benchExec(db, "BEGIN");
+
+        for( auto _ : state )
+        {
+            const auto started = std::chrono::steady_clock::now();
+            while( sqlite3_step(statement) == SQLITE_ROW )
+            {
+                benchmark::DoNotOptimize(sqlite3_column_blob(statement, 0));
+            }
+            sqlite3_reset(statement);
+            threadLatencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+
+            // Keeps the inserted tables small and the journal bounded, outside of the timed statements
+            if( ++rowsInTransaction == ROWS_PER_TRANSACTION )
+            {
+                state.PauseTiming();
+                benchExec(db, "COMMIT");
+                benchExec(db, "DELETE FROM keys");
+                benchExec(db, "BEGIN");
+                rowsInTransaction = 0;
+                state.ResumeTiming();
+            }
+        }
+
+        benchExec(db, "COMMIT");
+        sqlite3_finalize(statement);
+        sqlite3_close(db);
+
+        state.SetItemsProcessed(state.iterations());
+        state.SetLabel(sql);
+
+        // Counters are summed over threads, so only the last thread to finish sets the percentile
+        std::lock_guard<std::mutex> lock(latenciesMutex);
+        latencies.insert(latencies.end(), threadLatencies.begin(), threadLatencies.end());
+        if( ++threadsFinished == state.threads() )
+        {
+            if( !latencies.empty() )
+            {
+                const size_t p99 = latencies.size() * 99 / 100;
+                std::nth_element(latencies.begin(), latencies.begin() + p99, latencies.end());
+                state.counters["p99_ns"] = static_cast<double>(latencies[p99]);
+            }
+
+            latencies.clear();
+            threadsFinished = 0;
+        }
+    }
+}
+
+BENCHMARK(BM_Contention)
+    ->DenseRange(0, sizeof(CONTENTION_WORKLOADS) / sizeof(CONTENTION_WORKLOADS[0]) - 1)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
@@ -0,0 +1,287 @@
+#include "benchmarkSupport.hpp"
+
+#include "sqlite_extensions/uuidcarray.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+
+/*
+* Measures uuid(), uuid_str() and uuid_blob() from SQL, reporting time and sqlite allocations per call:
+*
+*    BM_Exec          - one sqlite3_exec() of a SELECT per call, as an application issuing single statements sees it
+*    BM_ResultPath    - stepping a statement over many rows, the steady state of a query over a large table
+*    BM_InsertSelect  - INSERT ... SELECT of many rows into a table with a UUID column
+*    BM_TextEncoding  - the text functions over a table of many rows, in a database of each text encoding
+*    BM_DistinctCount - counting the distinct UUIDs of a table exactly, and by the HyperLogLog aggregate
+*    BM_BulkBind      - inserting an application's array of UUIDs with a bind, step and reset each, and through uuid_carray
+*
+* The many row benchmarks take their inputs from uuid_series, and include its plain uuid_blob column as the baseline cost.
+*/
+namespace
+{
+    const int ROWS_PER_STATEMENT = 10000;
+
+    const char * EXEC_STATEMENTS[] = {
+        "SELECT uuid()",
+        "SELECT uuid_str('A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11')",
+        "SELECT uuid_str(x'a0eebc999c0b4ef8bb6d6bb9bd380a11')",
+        "SELECT uuid_blob('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11')",
+        "SELECT uuid_blob('{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}')",
+        "SELECT uuid_blob(x'a0eebc999c0b4ef8bb6d6bb9bd380a11')"
+    };
+
+    int discardRow(void *, int, char **, char **)
+    {
+        return 0;
+    }
+
+    void BM_Exec(benchmark::State & state)
+    {
+        const char * sql = EXEC_STATEMENTS[state.range(0)];
+        sqlite3 * db = benchOpen(":memory:");
+        const uint64_t allocationsBefore = benchAllocationCount();
+
+        for( auto _ : state )
+        {
+            if( sqlite3_exec(db, sql, discardRow, nullptr, nullptr) != SQLITE_OK )
+            {
+                state.SkipWithError(sqlite3_errmsg(db));
+                break;
+            }
+        }
+
+        state.counters["allocations_per_call"] = benchmark::Counter(static_cast<double>(benchAllocationCount() - allocationsBefore),
+                                                                    benchmark::Counter::kAvgIterations);
+        state.SetLabel(sql);
+        sqlite3_close(db);
+    }
+
+    const char * RESULT_EXPRESSIONS[] = {
+        "uuid_blob",                // baseline
+        "uuid()",
+        "uuid_str(uuid_blob)",      // blob in, text out
+        "uuid_str(uuid)",           // text in, text out
+        "uuid_blob(uuid)",          // text in, blob out
+        "uuid_blob(uuid_blob)"      // blob in, blob out
+    };
+
+    void BM_ResultPath(benchmark::State & state)
+    {
+        const std::string expression = RESULT_EXPRESSIONS[state.range(0)];
+        sqlite3 * db = benchOpen(":memory:");
+
+        const std::string sql = "SELECT " + expression + " FROM uuid_series(" + std::to_string(ROWS_PER_STATEMENT) + ")";
+        sqlite3_stmt * statement = nullptr;
+        if( sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK )
+        {
+            state.SkipWithError(sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return;
+        }
+
+        const uint64_t allocationsBefore = benchAllocationCount();
+
+        for( auto _ : state )
+        {
+            while( sqlite3_step(statement) == SQLITE_ROW )
+            {
+                benchmark::DoNotOptimize(sqlite3_column_blob(statement, 0));
+            }
+            sqlite3_reset(statement);
+        }
+
+        const double calls = static_cast<double>(state.iterations()) * ROWS_PER_STATEMENT;
+        state.counters["allocations_per_call"] = static_cast<double>(benchAllocationCount() - allocationsBefore) / calls;
+        state.counters["ns_per_call"] = benchmark::Counter(calls, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        state.SetLabel(expression);
+
+        sqlite3_finalize(statement);
+        sqlite3_close(db);
+    }
+
+    void BM_InsertSelect(benchmark::State & state)
+    {
+        const std::string expression = RESULT_EXPRESSIONS[state.range(0)];
+        sqlite3 * db = benchOpen(":memory:");
+        benchExec(db, "CREATE TABLE keys(id)");
+
+        const std::string sql = "INSERT INTO keys SELECT " + expression + " FROM uuid_series(" + std::to_string(ROWS_PER_STATEMENT) + ")";
+        uint64_t allocations = 0;
+
+        for( auto _ : state )
+        {
+            const uint64_t allocationsBefore = benchAllocationCount();
+            benchExec(db, sql);
+            allocations += benchAllocationCount() - allocationsBefore;
+
+            state.PauseTiming();
+            benchExec(db, "DELETE FROM keys");
+            state.ResumeTiming();
+        }
+
+        const double calls = static_cast<double>(state.iterations()) * ROWS_PER_STATEMENT;
+        state.counters["allocations_per_call"] = static_cast<double>(allocations) / calls;
+        state.counters["ns_per_call"] = benchmark::Counter(calls, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        state.SetLabel(expression);
+        sqlite3_close(db);
+    }
+
+    const char * TEXT_ENCODINGS[] = {"UTF-8", "UTF-16le", "UTF-16be"};
+
+    const char * ENCODING_EXPRESSIONS[] = {
+        "uuid",                     // baseline
+        "uuid()",
+        "uuid_str(uuid_blob)",
+        "uuid_str(uuid)",
+        "uuid_blob(uuid)"
+    };
+
+    void BM_TextEncoding(benchmark::State & state)
+    {
+        const std::string encoding = TEXT_ENCODINGS[state.range(0)];
+        const std::string expression = ENCODING_EXPRESSIONS[state.range(1)];
+        sqlite3 * db = benchOpen(":memory:");
+
+        // The text is stored in the database's encoding up front, unlike uuid_series which always returns UTF-8
+        benchExec(db, "PRAGMA encoding = '" + encoding + "'");
+        benchExec(db, "CREATE TABLE keys(uuid TEXT, uuid_blob BLOB)");
+        benchExec(db, "INSERT INTO keys SELECT uuid, uuid_blob FROM uuid_series(" + std::to_string(ROWS_PER_STATEMENT) + ")");
+
+        const std::string sql = "SELECT " + expression + " FROM keys";
+        sqlite3_stmt * statement = nullptr;
+        if( sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK )
+        {
+            state.SkipWithError(sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return;
+        }
+
+        const uint64_t allocationsBefore = benchAllocationCount();
+
+        for( auto _ : state )
+        {
+            while( sqlite3_step(statement) == SQLITE_ROW )
+            {
+                // The raw bytes, so reading the result does not convert it either
+                benchmark::DoNotOptimize(sqlite3_column_blob(statement, 0));
+            }
+            sqlite3_reset(statement);
+        }
+
+        const double calls = static_cast<double>(state.iterations()) * ROWS_PER_STATEMENT;
+        state.counters["allocations_per_call"] = static_cast<double>(benchAllocationCount() - allocationsBefore) / calls;
+        state.counters["ns_per_call"] = benchmark::Counter(calls, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        state.SetLabel(encoding + " " + expression);
+
+        sqlite3_finalize(statement);
+        sqlite3_close(db);
+    }
+
+    const char * DISTINCT_EXPRESSIONS[] = {
+        "count(DISTINCT uuid)",
+        "uuid_approx_distinct(uuid)",
+        "count(DISTINCT uuid_blob)",
+        "uuid_approx_distinct(uuid_blob)"
+    };
+
+    void BM_DistinctCount(benchmark::State & state)
+    {
+        const std::string expression = DISTINCT_EXPRESSIONS[state.range(0)];
+        sqlite3 * db = benchOpen(":memory:");
+        benchExec(db, "CREATE TABLE keys(uuid TEXT, uuid_blob BLOB)");
+        benchExec(db, "INSERT INTO keys SELECT uuid, uuid_blob FROM uuid_series(" + std::to_string(ROWS_PER_STATEMENT) + ")");
+
+        const std::string sql = "SELECT " + expression + " FROM keys";
+        sqlite3_stmt * statement = nullptr;
+        if( sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK )
+        {
+            state.SkipWithError(sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return;
+        }
+
+        const uint64_t allocationsBefore = benchAllocationCount();
+
+        for( auto _ : state )
+        {
+            while( sqlite3_step(statement) == SQLITE_ROW )
+            {
+                benchmark::DoNotOptimize(sqlite3_column_int64(statement, 0));
+            }
+            sqlite3_reset(statement);
+        }
+
+        const double rows = static_cast<double>(state.iterations()) * ROWS_PER_STATEMENT;
+        state.counters["allocations_per_row"] = static_cast<double>(benchAllocationCount() - allocationsBefore) / rows;
+        state.counters["ns_per_row"] = benchmark::Counter(rows, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        state.SetLabel(expression);
+
+        sqlite3_finalize(statement);
+        sqlite3_close(db);
+    }
+
+    void BM_BulkBind(benchmark::State & state)
+    {
+        const bool carray = state.range(0) != 0;
+        sqlite3 * db = benchOpen(":memory:");
+        benchExec(db, "CREATE TABLE keys(id BLOB)");
+
+        std::vector<unsigned char> uuids(16 * ROWS_PER_STATEMENT);
+        sqlite3UuidV4Generate(uuids.data(), ROWS_PER_STATEMENT);
+
+        sqlite3_stmt * statement = nullptr;
+        const char * sql = carray ? "INSERT INTO keys SELECT uuid_blob FROM uuid_carray(?)" : "INSERT INTO keys VALUES (?)";
+        if( sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK )
+        {
+            state.SkipWithError(sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return;
+        }
+
+        for( auto _ : state )
+        {
+            benchExec(db, "BEGIN");
+            if( carray )
+            {
+                sqlite3UuidBindCarray(statement, 1, uuids.data(), ROWS_PER_STATEMENT);
+                sqlite3_step(statement);
+                sqlite3_reset(statement);
+            }
+            else
+            {
+                for(int row = 0; row < ROWS_PER_STATEMENT; row++)
+                {
+                    sqlite3_bind_blob(statement, 1, uuids.data() + 16 * row, 16, SQLITE_STATIC);
+                    sqlite3_step(statement);
+                    sqlite3_reset(statement);
+                }
+            }
+            benchExec(db, "COMMIT");
+
+            state.PauseTiming();
+            benchExec(db, "DELETE FROM keys");
+            state.ResumeTiming();
+        }
+
+        const double rows = static_cast<double>(state.iterations()) * ROWS_PER_STATEMENT;
+        state.counters["ns_per_row"] = benchmark::Counter(rows, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        state.SetLabel(sql);
+
+        sqlite3_finalize(statement);
+        sqlite3_close(db);
+    }
+}
+
+BENCHMARK(BM_Exec)->DenseRange(0, sizeof(EXEC_STATEMENTS) / sizeof(EXEC_STATEMENTS[0]) - 1);
+BENCHMARK(BM_ResultPath)->DenseRange(0, sizeof(RESULT_EXPRESSIONS) / sizeof(RESULT_EXPRESSIONS[0]) - 1);
+BENCHMARK(BM_InsertSelect)->DenseRange(0, sizeof(RESULT_EXPRESSIONS) / sizeof(RESULT_EXPRESSIONS[0]) - 1);
+BENCHMARK(BM_TextEncoding)->ArgsProduct({
+    benchmark::CreateDenseRange(0, sizeof(TEXT_ENCODINGS) / sizeof(TEXT_ENCODINGS[0]) - 1, 1),
+    benchmark::CreateDenseRange(0, sizeof(ENCODING_EXPRESSIONS) / sizeof(ENCODING_EXPRESSIONS[0]) - 1, 1)
+});
+BENCHMARK(BM_DistinctCount)->DenseRange(0, sizeof(DISTINCT_EXPRESSIONS) / sizeof(DISTINCT_EXPRESSIONS[0]) - 1);
+BENCHMARK(BM_BulkBind)->Arg(0)->Arg(1);
@@ -0,0 +1,371 @@
+#include "benchmarkSupport.hpp"
+
+#include "sqlite_extensions/ulid.hpp"
+#include "sqlite_extensions/uuidbloom.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "sqlite_extensions/uuidname.hpp"
+#include "sqlite_extensions/uuidpack.hpp"
+#include "sqlite_extensions/uuidrandom.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+/*
+* Measures the kernels behind the SQL functions on their own, one operation per iteration unless noted:
+* formatting and parsing at every SIMD level the cpu supports, the randomness pool against sqlite3_randomness(),
+* UUID generation, and the same for ULIDs. Name-based generation is reported in bytes hashed per second as well.
+* Bloom filter lookups go to random blocks of a filter larger than the cpu's caches, as they would for a large table.
+* Pack searches are for members of packs of several sizes, half of the time for UUIDs that are not there.
+*/
+namespace
+{
+    const size_t BATCH_SIZE = 256;
+
+    const char * CANONICAL_TEXT = "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11";
+    const char * BRACED_TEXT = "{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}";
+    const char * B64_TEXT = "oO68mZwLTvi7bWu5vTgKEQ";
+    const char * ULID_TEXT = "01ARZ3NDEKTSV4RRFFQ69G5FAV";
+
+    bool skipUnsupported(benchmark::State & state, UuidSimdLevel level)
+    {
+        if( level > sqlite3UuidSimdSupported() )
+        {
+            state.SkipWithError("SIMD level not supported by this cpu");
+            return true;
+        }
+        return false;
+    }
+
+    void BM_FormatKernel(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        unsigned char bytes[16];
+        unsigned char text[36];
+        sqlite3UuidV4Generate(bytes, 1);
+
+        for( auto _ : state )
+        {
+            sqlite3UuidBlobsToStrsWith(level, bytes, 1, text);
+            benchmark::DoNotOptimize(text);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    /*
+    * BATCH_SIZE UUIDs per iteration, reported per UUID
+    */
+    void BM_FormatKernelBatch(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        std::vector<unsigned char> bytes(16 * BATCH_SIZE);
+        std::vector<unsigned char> text(36 * BATCH_SIZE);
+        sqlite3UuidV4Generate(bytes.data(), BATCH_SIZE);
+
+        for( auto _ : state )
+        {
+            sqlite3UuidBlobsToStrsWith(level, bytes.data(), BATCH_SIZE, text.data());
+            benchmark::DoNotOptimize(text.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.counters["ns_per_uuid"] = benchmark::Counter(static_cast<double>(state.iterations() * BATCH_SIZE),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    void parse(benchmark::State & state, const char * text)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        const size_t length = strlen(text);
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            benchmark::DoNotOptimize(sqlite3UuidStrToBlobWith(level, reinterpret_cast<const unsigned char *>(text), length, bytes));
+            benchmark::ClobberMemory();
+        }
+    }
+
+    void BM_ParseCanonical(benchmark::State & state)
+    {
+        parse(state, CANONICAL_TEXT);
+    }
+
+    void BM_ParseBraced(benchmark::State & state)
+    {
+        parse(state, BRACED_TEXT);
+    }
+
+    void BM_B64FormatKernel(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        unsigned char bytes[16];
+        unsigned char text[22];
+        sqlite3UuidV4Generate(bytes, 1);
+
+        for( auto _ : state )
+        {
+            sqlite3UuidBlobToB64With(level, bytes, text);
+            benchmark::DoNotOptimize(text);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    void BM_B64ParseKernel(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            benchmark::DoNotOptimize(sqlite3UuidB64ToBlobWith(level, reinterpret_cast<const unsigned char *>(B64_TEXT), 22, bytes));
+            benchmark::ClobberMemory();
+        }
+    }
+
+    void BM_UlidFormatKernel(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        unsigned char bytes[16];
+        unsigned char text[26];
+        sqlite3UuidV4Generate(bytes, 1);
+
+        for( auto _ : state )
+        {
+            sqlite3UlidBlobToStrWith(level, bytes, text);
+            benchmark::DoNotOptimize(text);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    void BM_UlidParseKernel(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            benchmark::DoNotOptimize(sqlite3UlidStrToBlobWith(level, reinterpret_cast<const unsigned char *>(ULID_TEXT), 26, bytes));
+            benchmark::ClobberMemory();
+        }
+    }
+
+    void BM_RandomnessPool(benchmark::State & state)
+    {
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            sqlite3UuidRandomness(16, bytes);
+            benchmark::DoNotOptimize(bytes);
+        }
+    }
+
+    void BM_SqliteRandomness(benchmark::State & state)
+    {
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            sqlite3_randomness(16, bytes);
+            benchmark::DoNotOptimize(bytes);
+        }
+    }
+
+    void BM_GenerateV4(benchmark::State & state)
+    {
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            sqlite3UuidV4Generate(bytes, 1);
+            benchmark::DoNotOptimize(bytes);
+        }
+    }
+
+    void BM_GenerateV7(benchmark::State & state)
+    {
+        Uuid7State uuid7State = {0, 0, 1};
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            sqlite3UuidV7Generate(&uuid7State, bytes, 1);
+            benchmark::DoNotOptimize(bytes);
+        }
+    }
+
+    /*
+    * Version 5 of BATCH_SIZE e-mail addresses per iteration, one at a time or as a batch, with the SHA extensions or without
+    */
+    void generateV5(benchmark::State & state, bool batch)
+    {
+        const bool shaNi = state.range(0) != 0;
+        if( shaNi && !sqlite3UuidShaNiSupported() )
+        {
+            state.SkipWithError("SHA extensions not supported by this cpu");
+            return;
+        }
+
+        std::vector<std::string> names;
+        std::vector<const unsigned char *> pointers;
+        std::vector<size_t> lengths;
+        size_t bytesPerIteration = 0;
+        for(size_t nameIndex = 0; nameIndex < BATCH_SIZE; nameIndex++)
+        {
+            names.push_back("user" + std::to_string(nameIndex) + "@example.com");
+        }
+        for( const std::string & name : names )
+        {
+            pointers.push_back(reinterpret_cast<const unsigned char *>(name.data()));
+            lengths.push_back(name.size());
+            bytesPerIteration += 16 + name.size();
+        }
+
+        const unsigned char namespaceBytes[16] = {0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8};
+        std::vector<unsigned char> out(16 * BATCH_SIZE);
+
+        for( auto _ : state )
+        {
+            if( batch )
+            {
+                sqlite3UuidV5GenerateBatchWith(shaNi, namespaceBytes, pointers.data(), lengths.data(), BATCH_SIZE, out.data());
+            }
+            else
+            {
+                for(size_t nameIndex = 0; nameIndex < BATCH_SIZE; nameIndex++)
+                {
+                    sqlite3UuidV5GenerateWith(shaNi, namespaceBytes, pointers[nameIndex], lengths[nameIndex], out.data() + 16 * nameIndex);
+                }
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytesPerIteration));
+        state.counters["ns_per_uuid"] = benchmark::Counter(static_cast<double>(state.iterations() * BATCH_SIZE),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    void BM_GenerateV5(benchmark::State & state)
+    {
+        generateV5(state, false);
+    }
+
+    void BM_GenerateV5Batch(benchmark::State & state)
+    {
+        generateV5(state, true);
+    }
+
+    void BM_BloomContains(benchmark::State & state)
+    {
+        const UuidSimdLevel level = static_cast<UuidSimdLevel>(state.range(0));
+        if( skipUnsupported(state, level) )
+        {
+            return;
+        }
+
+        // 64MB at 10 bits per key, looked up with a million keys so the same blocks are not hit again for a while
+        const size_t keys = (size_t(1) << 29) / 10;
+        const size_t lookupCount = size_t(1) << 20;
+        std::vector<unsigned char> filter(sqlite3UuidBloomBytes(keys, 10.0));
+        sqlite3UuidBloomInit(filter.data(), filter.size());
+        std::vector<uint64_t> lookups(lookupCount);
+        sqlite3UuidRandomness(lookups.size() * sizeof(uint64_t), lookups.data());
+
+        size_t lookupIndex = 0;
+        for( auto _ : state )
+        {
+            benchmark::DoNotOptimize(sqlite3UuidBloomContainsWith(level, filter.data(), filter.size(), lookups[lookupIndex++ % lookupCount]));
+        }
+    }
+
+    void BM_PackContains(benchmark::State & state)
+    {
+        const size_t count = static_cast<size_t>(state.range(0));
+        std::vector<unsigned char> bytes(16 * 2 * count);
+        sqlite3UuidV4Generate(bytes.data(), 2 * count);
+
+        std::vector<UuidPackKey> keys(count);
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            keys[uuidIndex] = sqlite3UuidPackKey(bytes.data() + 16 * uuidIndex);
+        }
+        std::vector<unsigned char> pack(16 * sqlite3UuidPackSort(keys.data(), count));
+        sqlite3UuidPackWrite(keys.data(), pack.size() / 16, pack.data());
+
+        size_t lookupIndex = 0;
+        for( auto _ : state )
+        {
+            benchmark::DoNotOptimize(sqlite3UuidPackContains(pack.data(), pack.size() / 16, bytes.data() + 16 * (lookupIndex++ % (2 * count))));
+        }
+    }
+
+    void BM_GenerateUlid(benchmark::State & state)
+    {
+        UlidState ulidState = {0, 0, 0, 1};
+        unsigned char bytes[16];
+
+        for( auto _ : state )
+        {
+            sqlite3UlidGenerate(&ulidState, bytes, 1);
+            benchmark::DoNotOptimize(bytes);
+        }
+    }
+}
+
+BENCHMARK(BM_FormatKernel)->DenseRange(UUID_SIMD_SCALAR, UUID_SIMD_AVX2);
+BENCHMARK(BM_FormatKernelBatch)->DenseRange(UUID_SIMD_SCALAR, UUID_SIMD_AVX2);
+BENCHMARK(BM_ParseCanonical)->DenseRange(UUID_SIMD_SCALAR, UUID_SIMD_AVX2);
+BENCHMARK(BM_ParseBraced)->Arg(UUID_SIMD_SCALAR);
+BENCHMARK(BM_B64FormatKernel)->Args({UUID_SIMD_SCALAR})->Args({UUID_SIMD_SSSE3});
+BENCHMARK(BM_B64ParseKernel)->Args({UUID_SIMD_SCALAR})->Args({UUID_SIMD_SSSE3});
+BENCHMARK(BM_UlidFormatKernel)->DenseRange(UUID_SIMD_SCALAR, UUID_SIMD_SSE2);
+BENCHMARK(BM_UlidParseKernel)->DenseRange(UUID_SIMD_SCALAR, UUID_SIMD_SSE2);
+BENCHMARK(BM_BloomContains)->Args({UUID_SIMD_SCALAR})->Args({UUID_SIMD_AVX2});
+BENCHMARK(BM_PackContains)->Arg(16)->Arg(1024)->Arg(65536);
+BENCHMARK(BM_RandomnessPool);
+BENCHMARK(BM_SqliteRandomness);
+BENCHMARK(BM_GenerateV4);
+BENCHMARK(BM_GenerateV7);
+BENCHMARK(BM_GenerateV5)->Arg(0)->Arg(1);
+BENCHMARK(BM_GenerateV5Batch)->Arg(0)->Arg(1);
+BENCHMARK(BM_GenerateUlid);
@@ -0,0 +1,61 @@
+#ifndef SQLITE_ULID_HPP
+#define SQLITE_ULID_HPP
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Per-connection state for the ULID generators, shared and reference counted the same way as Uuid7State.
+* Remembers the last timestamp and random part handed out so that ULIDs generated within the same millisecond are
+* still strictly increasing.
+*/
+struct UlidState
+{
+    int64_t lastMilliseconds;
+    uint64_t randomHigh;    // the top 16 of the 80 random bits
+    uint64_t randomLow;     // the other 64
+    int refCount;
+};
+
+/*
+* Allocates a UlidState with sqlite's allocator, holding refCount references.
+* Returns nullptr if out of memory.
+*/
+UlidState * sqlite3UlidStateCreate(int refCount);
+
+/*
+* Drops one reference to a UlidState, freeing it with the last one. Suitable as an xDestroy callback.
+*/
+void sqlite3UlidStateRelease(void * state);
+
+/*
+* Fills bytes with count ULIDs of 16 bytes each, strictly increasing and following on from anything previously generated
+* with the same state.
+*/
+void sqlite3UlidGenerate(UlidState * state, unsigned char * bytes, size_t count);
+
+/*
+* Encodes 16 bytes as the 26 characters of a ULID, in upper case Crockford base32. The output buffer should be at least 26
+* bytes in length and is not zero terminated.
+*/
+void sqlite3UlidBlobToStr(const unsigned char * bytes, unsigned char * result);
+
+/*
+* Same as sqlite3UlidBlobToStr(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+void sqlite3UlidBlobToStrWith(UuidSimdLevel level, const unsigned char * bytes, unsigned char * result);
+
+/*
+* Decodes the 26 characters of a ULID into 16 bytes. Either case is accepted, as are the Crockford aliases I and L for 1
+* and O for 0. Returns 0 on success, or non-zero if the text is not a ULID, including when it is above 7ZZZZZZZZZZZZZZZZZZZZZZZZZ.
+*/
+int sqlite3UlidStrToBlob(const unsigned char * text, size_t length, unsigned char * out);
+
+/*
+* Same as sqlite3UlidStrToBlob(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+int sqlite3UlidStrToBlobWith(UuidSimdLevel level, const unsigned char * text, size_t length, unsigned char * out);
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef SQLITE_UUID_HPP
+#define SQLITE_UUID_HPP
+
+#include "sqlite_extensions/uuidhash.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <array>
+#include <charconv>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/*
+* A UUID as a value: its 16 bytes in the order the extension stores them as blobs, and nothing else. Default constructed,
+* it is the nil UUID.
+*
+* It is trivially copyable, so a std::vector<Uuid> is laid out the same as the byte arrays the kernels, sqlite3_bind_blob()
+* and sqlite3UuidBindCarray() take. Parsing and formatting are constexpr, for UUIDs known at compile time, and at run time
+* use the same vectorized kernels as the SQL functions. toChars() writes into the caller's buffer, so turning an ID into
+* text needs no allocation.
+*
+* UUIDs compare as their bytes do, the same order as the blobs in sqlite and the canonical text in the UUID collation.
+*/
+struct Uuid
+{
+    /*
+    * Length of the canonical 8-4-4-4-12 form
+    */
+    static constexpr size_t TEXT_LENGTH = 36;
+
+    std::array<unsigned char, 16> bytes = {};
+
+    /*
+    * Copies 16 bytes, such as a blob read from sqlite
+    */
+    static constexpr Uuid fromBytes(const unsigned char * source)
+    {
+        Uuid uuid;
+        for(size_t byteIndex = 0; byteIndex < 16; byteIndex++)
+        {
+            uuid.bytes[byteIndex] = source[byteIndex];
+        }
+        return uuid;
+    }
+
+    /*
+    * Parses the canonical 8-4-4-4-12 form, in upper or lower case. Returns std::nullopt for anything else, including the
+    * braced, undashed and base64url forms the SQL functions also accept.
+    */
+    static constexpr std::optional<Uuid> fromString(std::string_view text)
+    {
+        Uuid uuid;
+
+        if( !std::is_constant_evaluated() )
+        {
+            if( sqlite3UuidCanonicalToBlob(reinterpret_cast<const unsigned char *>(text.data()), text.size(), uuid.bytes.data()) != 0 )
+            {
+                return std::nullopt;
+            }
+            return uuid;
+        }
+
+        if( text.size() != TEXT_LENGTH || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-' )
+        {
+            return std::nullopt;
+        }
+
+        for(size_t byteIndex = 0, textIndex = 0; byteIndex < 16; byteIndex++, textIndex += 2)
+        {
+            if( text[textIndex] == '-' )
+            {
+                textIndex++;
+            }
+
+            const int high = hexValue(text[textIndex]);
+            const int low = hexValue(text[textIndex + 1]);
+            if( (high | low) < 0 )
+            {
+                return std::nullopt;
+            }
+            uuid.bytes[byteIndex] = static_cast<unsigned char>((high << 4) | low);
+        }
+
+        return uuid;
+    }
+
+    /*
+    * Writes the canonical form, 36 characters in lower case with no terminator, to [first, last). Like std::to_chars,
+    * returns the end of what was written, or last and std::errc::value_too_large if it does not fit.
+    */
+    constexpr std::to_chars_result toChars(char * first, char * last) const
+    {
+        if( last - first < static_cast<std::ptrdiff_t>(TEXT_LENGTH) )
+        {
+            return {last, std::errc::value_too_large};
+        }
+
+        if( !std::is_constant_evaluated() )
+        {
+            sqlite3UuidBlobsToStrs(bytes.data(), 1, reinterpret_cast<unsigned char *>(first));
+            return {first + TEXT_LENGTH, std::errc()};
+        }
+
+        constexpr char digits[] = "0123456789abcdef";
+        for(size_t byteIndex = 0; byteIndex < 16; byteIndex++)
+        {
+            if( byteIndex == 4 || byteIndex == 6 || byteIndex == 8 || byteIndex == 10 )
+            {
+                *first++ = '-';
+            }
+            *first++ = digits[bytes[byteIndex] >> 4];
+            *first++ = digits[bytes[byteIndex] & 0xf];
+        }
+        return {first, std::errc()};
+    }
+
+    /*
+    * The canonical form as a string, for when one is needed anyway. toChars() does the same without allocating.
+    */
+    std::string toString() const;
+
+    /*
+    * The version, from the top 4 bits of byte 6, as uuid_version() returns in SQL
+    */
+    constexpr int version() const
+    {
+        return bytes[6] >> 4;
+    }
+
+    constexpr bool isNil() const
+    {
+        return *this == Uuid();
+    }
+
+    friend constexpr bool operator==(const Uuid & left, const Uuid & right) = default;
+    friend constexpr std::strong_ordering operator<=>(const Uuid & left, const Uuid & right) = default;
+
+    /*
+    * Fills uuids with random version 4 UUIDs, drawing from the randomness pool once for the whole span
+    */
+    static void generate(std::span<Uuid> uuids);
+
+    /*
+    * Fills uuids with version 7 UUIDs, strictly increasing and following on from anything previously generated with state
+    */
+    static void generate7(Uuid7State * state, std::span<Uuid> uuids);
+
+    /*
+    * Parses each of texts, as fromString() does, into the same position of uuids, which must be at least as long.
+    * Returns the index of the first text that is not a canonical UUID, or texts.size() if they all are. Nothing after
+    * the first failure is parsed.
+    */
+    static size_t parse(std::span<const std::string_view> texts, std::span<Uuid> uuids);
+
+    /*
+    * Writes the canonical form of each of uuids back to back, 36 characters each with no terminators, to text, which
+    * must be at least TEXT_LENGTH * uuids.size() characters in length
+    */
+    static void format(std::span<const Uuid> uuids, std::span<char> text);
+
+private:
+    static constexpr int hexValue(char digit)
+    {
+        return digit >= '0' && digit <= '9' ? digit - '0'
+            : digit >= 'a' && digit <= 'f' ? digit - 'a' + 10
+            : digit >= 'A' && digit <= 'F' ? digit - 'A' + 10
+            : -1;
+    }
+};
+
+// The batch functions and the kernels read a span of Uuid as 16 * size() bytes
+static_assert(sizeof(Uuid) == 16 && alignof(Uuid) == 1, "Uuid must be exactly its 16 bytes");
+static_assert(std::is_trivially_copyable_v<Uuid> && std::is_standard_layout_v<Uuid>, "Uuid must be copyable as bytes");
+
+/*
+* Hashes with sqlite3UuidHash64(), the same value uuid_hash64() gives in SQL
+*/
+template<>
+struct std::hash<Uuid>
+{
+    size_t operator()(const Uuid & uuid) const noexcept
+    {
+        return static_cast<size_t>(sqlite3UuidHash64(uuid.bytes.data()));
+    }
+};
+
+#endif
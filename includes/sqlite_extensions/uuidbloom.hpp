@@ -0,0 +1,51 @@
+#ifndef SQLITE_UUID_BLOOM_HPP
+#define SQLITE_UUID_BLOOM_HPP
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Blocked Bloom filters of sets of UUIDs, for skipping index lookups of UUIDs that are certainly not in a table.
+*
+* A filter is a 4 byte header followed by blocks of 32 bytes, the blob uuid_bloom() returns in SQL. Each UUID sets one bit
+* in each of the eight 32-bit little-endian words of a single block, so a lookup reads one block, in one or two cache lines,
+* and an AVX2 lookup is a handful of instructions. Keys are the sqlite3UuidHash64() of a UUID: the high half picks the block
+* and the low half the bits.
+*/
+const size_t UUID_BLOOM_HEADER_BYTES = 4;
+const size_t UUID_BLOOM_BLOCK_BYTES = 32;
+
+/*
+* The size of a filter for keys keys with about bitsPerKey bits each, which must be positive. Never less than one block.
+* Returns 0 if the filter would be too large for a blob.
+*/
+size_t sqlite3UuidBloomBytes(size_t keys, double bitsPerKey);
+
+/*
+* Writes the header of an empty filter of size bytes, from sqlite3UuidBloomBytes(), and zeroes its blocks
+*/
+void sqlite3UuidBloomInit(unsigned char * filter, size_t size);
+
+/*
+* Returns true if size bytes are a filter sqlite3UuidBloomInit() could have started: the right header, and whole blocks
+*/
+bool sqlite3UuidBloomIsValid(const unsigned char * filter, size_t size);
+
+/*
+* Adds the key of a UUID, its sqlite3UuidHash64(), to a filter of size bytes
+*/
+void sqlite3UuidBloomInsert(unsigned char * filter, size_t size, uint64_t key);
+
+/*
+* Returns false if the key of a UUID was certainly never added to a filter of size bytes, and true if it probably was
+*/
+bool sqlite3UuidBloomContains(const unsigned char * filter, size_t size, uint64_t key);
+
+/*
+* Same as sqlite3UuidBloomContains(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+bool sqlite3UuidBloomContainsWith(UuidSimdLevel level, const unsigned char * filter, size_t size, uint64_t key);
+
+#endif
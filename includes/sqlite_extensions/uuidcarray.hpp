@@ -0,0 +1,35 @@
+#ifndef SQLITE_UUID_CARRAY_HPP
+#define SQLITE_UUID_CARRAY_HPP
+
+#include "sqlite3ext.h"
+
+#include <cstddef>
+
+/*
+* The pointer type uuid_carray() accepts from sqlite3_bind_pointer(). sqlite only hands a bound pointer to a function asking
+* for the same type, so a pointer bound for anything else reads as NULL.
+*/
+const char * const UUID_CARRAY_POINTER_TYPE = "uuid_carray";
+
+/*
+* What uuid_carray() expects a bound pointer to point at: count 16-byte UUIDs back to back, starting at bytes
+*/
+struct UuidCarray
+{
+    const unsigned char * bytes;
+    size_t count;
+};
+
+/*
+* Binds count 16-byte UUIDs, starting at bytes, to parameter index of a statement, for uuid_carray() to read. The UUIDs are
+* not copied, so they must stay where they are until the statement is reset or finalized, or the parameter is rebound.
+* Returns SQLITE_NOMEM if out of memory, otherwise what sqlite3_bind_pointer() returns.
+*/
+int sqlite3UuidBindCarray(sqlite3_stmt * statement, int index, const unsigned char * bytes, size_t count);
+
+/*
+* Registers the uuid_carray table-valued function with a connection. Called by sqlite3_uuid_init.
+*/
+int sqlite3UuidCarrayInit(sqlite3 * db);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SQLITE_UUID_HASH_HPP
+#define SQLITE_UUID_HASH_HPP
+
+#include <cstdint>
+
+/*
+* Hashes a 16-byte UUID to 64 bits, the same value uuid_hash64() returns in SQL.
+*
+* This is wyhash's path for 16 bytes of input with a fixed seed, so it is fast, mixes every input bit into every output bit,
+* and gives the same result on every platform and in every release. Rows are routed with it, so it must never change.
+*/
+uint64_t sqlite3UuidHash64(const unsigned char * bytes);
+
+/*
+* Jump consistent hash (Lamping and Veach): maps a 64-bit key to one of buckets buckets, which must be at least 1.
+* Going from n to n + 1 buckets moves only 1 / (n + 1) of the keys, all of them into the new bucket.
+*/
+int32_t sqlite3UuidJumpHash(uint64_t key, int32_t buckets);
+
+/*
+* The shard out of shards, which must be at least 1, a 16-byte UUID belongs to. The same value uuid_shard() returns in SQL.
+*/
+int32_t sqlite3UuidShard(const unsigned char * bytes, int32_t shards);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef SQLITE_UUID_HLL_HPP
+#define SQLITE_UUID_HLL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* HyperLogLog sketches of sets of UUIDs, for counting distinct UUIDs in constant memory.
+*
+* A sketch is a 4 byte header followed by one byte register for each of 2^UUID_HLL_PRECISION buckets, the blob
+* uuid_hll() returns in SQL. Sketches of any sets of UUIDs can be merged into the sketch of their union, so sketches
+* stored per shard or per day can be combined later.
+*/
+const int UUID_HLL_PRECISION = 14;
+const size_t UUID_HLL_REGISTERS = size_t(1) << UUID_HLL_PRECISION;
+const size_t UUID_HLL_HEADER_BYTES = 4;
+const size_t UUID_HLL_SKETCH_BYTES = UUID_HLL_HEADER_BYTES + UUID_HLL_REGISTERS;
+
+/*
+* The 64 bits of a 16-byte UUID a sketch is built from. The random bits of version 3, 4 and 5 UUIDs with the RFC 9562
+* variant are used as they are; any other UUID, such as version 7 with its timestamp, is hashed with sqlite3UuidHash64().
+*/
+uint64_t sqlite3UuidHllHash(const unsigned char * bytes);
+
+/*
+* Writes the header of an empty sketch, and zeroes its registers. The output buffer should be UUID_HLL_SKETCH_BYTES long.
+*/
+void sqlite3UuidHllInit(unsigned char * sketch);
+
+/*
+* Returns true if size bytes are a sketch sqlite3UuidHllInit() could have started: the right header, size and registers
+*/
+bool sqlite3UuidHllIsValid(const unsigned char * sketch, size_t size);
+
+/*
+* Adds a 16-byte UUID to the registers of a sketch, which start UUID_HLL_HEADER_BYTES into it
+*/
+void sqlite3UuidHllAdd(unsigned char * registers, const unsigned char * bytes);
+
+/*
+* Merges the registers of another sketch into registers, which then hold the sketch of the union of the two sets
+*/
+void sqlite3UuidHllMerge(unsigned char * registers, const unsigned char * otherRegisters);
+
+/*
+* Estimates the number of distinct UUIDs added to the registers of a sketch, with a standard error of about 0.8%
+*/
+double sqlite3UuidHllEstimate(const unsigned char * registers);
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef SQLITE_UUID_KERNELS_HPP
+#define SQLITE_UUID_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Per-connection state for the version 7 generators.
+* Remembers the last timestamp and counter handed out so that UUIDs generated on the same connection within the same
+* millisecond are still strictly increasing. One instance is shared by everything on a connection that generates version 7
+* UUIDs and is reference counted, because sqlite calls the destructor once for every function or module it was registered with.
+*/
+struct Uuid7State
+{
+    int64_t lastMilliseconds;
+    uint64_t counter;
+    int refCount;
+};
+
+/*
+* Allocates a Uuid7State with sqlite's allocator, holding refCount references.
+* Returns nullptr if out of memory.
+*/
+Uuid7State * sqlite3Uuid7StateCreate(int refCount);
+
+/*
+* Drops one reference to a Uuid7State, freeing it with the last one. Suitable as an xDestroy callback.
+*/
+void sqlite3Uuid7StateRelease(void * state);
+
+/*
+* Fills bytes with count random version 4 UUIDs of 16 bytes each, using a single draw from the randomness pool
+*/
+void sqlite3UuidV4Generate(unsigned char * bytes, size_t count);
+
+/*
+* Fills bytes with count version 7 UUIDs of 16 bytes each, strictly increasing and following on from anything previously
+* generated with the same state. The clock is read and the randomness pool drawn from once for the whole batch.
+*/
+void sqlite3UuidV7Generate(Uuid7State * state, unsigned char * bytes, size_t count);
+
+/*
+* Reads the time a version 1, 6 or 7 UUID was generated, as milliseconds since the unix epoch, rounding the finer timestamps
+* of versions 1 and 6 down. Returns false for any other version, or a variant other than RFC 9562's.
+*/
+bool sqlite3UuidTimestamp(const unsigned char * bytes, int64_t & milliseconds);
+
+/*
+* Writes the lowest version 7 UUID with the given timestamp if upper is false, or the highest if it is true. Every version 7
+* UUID generated in that millisecond is between the two, as bytes, and as lower case text in the canonical form.
+* The timestamp must be from 0 to 2^48 - 1.
+*/
+void sqlite3UuidV7Bound(int64_t milliseconds, bool upper, unsigned char * bytes);
+
+/*
+* Instruction set extensions the formatting and parsing kernels have versions for, in increasing order
+*/
+enum UuidSimdLevel
+{
+    UUID_SIMD_SCALAR = 0,
+    UUID_SIMD_SSE2,
+    UUID_SIMD_SSSE3,
+    UUID_SIMD_AVX2
+};
+
+/*
+* Returns the highest level the running cpu supports. Every level below it is supported too.
+*/
+UuidSimdLevel sqlite3UuidSimdSupported();
+
+/*
+* Converts a 16-byte BLOB into a well-formed RFC-4122 UUID with 8-4-4-4-12 hexidecimal digits, each representing 4 bits.
+* The output buffer should be at least 37 bytes in length and will be zero terminted.
+*/
+void sqlite3UuidBlobToStr(const unsigned char * bytes, unsigned char * result);
+
+/*
+* The portable one-nibble-at-a-time version of sqlite3UuidBlobToStr(), kept as the reference for the vectorized kernels
+*/
+void sqlite3UuidBlobToStrScalar(const unsigned char * bytes, unsigned char * result);
+
+/*
+* Converts count 16-byte BLOBs into their 36 character string forms, written back to back with no terminators.
+* The output buffer should be at least 36 * count bytes in length.
+*/
+void sqlite3UuidBlobsToStrs(const unsigned char * bytes, size_t count, unsigned char * result);
+
+/*
+* Same as sqlite3UuidBlobsToStrs(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+void sqlite3UuidBlobsToStrsWith(UuidSimdLevel level, const unsigned char * bytes, size_t count, unsigned char * result);
+
+/*
+* Parses a string of length bytes into a binary UUID. The string must consist of 32 hexadecimal digits, upper or lower case,
+* optionally surrounded by {...} and with an optional "-" before any pair of digits, or be the 22 characters of base64url
+* that sqlite3UuidBlobToB64() produces.
+* The canonical 8-4-4-4-12 and base64url forms are parsed with vectorized kernels, any other with the scalar parser.
+* Returns 0 on success, or non-zero if the input string is not parsable
+*/
+int sqlite3UuidStrToBlob(const unsigned char * guidAsText, size_t length, unsigned char * out);
+
+/*
+* The portable byte-at-a-time version of sqlite3UuidStrToBlob(), kept as the reference for the vectorized kernels
+*/
+int sqlite3UuidStrToBlobScalar(const unsigned char * guidAsText, size_t length, unsigned char * out);
+
+/*
+* Same as sqlite3UuidStrToBlob(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+int sqlite3UuidStrToBlobWith(UuidSimdLevel level, const unsigned char * guidAsText, size_t length, unsigned char * out);
+
+/*
+* Parses only the canonical 8-4-4-4-12 form, in upper or lower case, with the vectorized kernels where there are some.
+* Returns 0 on success, or non-zero for any other input, including the other forms sqlite3UuidStrToBlob() accepts
+*/
+int sqlite3UuidCanonicalToBlob(const unsigned char * guidAsText, size_t length, unsigned char * out);
+
+/*
+* Same as sqlite3UuidCanonicalToBlob(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+int sqlite3UuidCanonicalToBlobWith(UuidSimdLevel level, const unsigned char * guidAsText, size_t length, unsigned char * out);
+
+/*
+* Converts a 16-byte BLOB into 22 characters of base64url (RFC 4648 section 5) without padding. The output buffer should be
+* at least 22 bytes in length and is not zero terminated. The text does not sort in the same order as the bytes, which the
+* UUID collation takes care of.
+*/
+void sqlite3UuidBlobToB64(const unsigned char * bytes, unsigned char * result);
+
+/*
+* The portable version of sqlite3UuidBlobToB64(), kept as the reference for the vectorized kernels
+*/
+void sqlite3UuidBlobToB64Scalar(const unsigned char * bytes, unsigned char * result);
+
+/*
+* Same as sqlite3UuidBlobToB64(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+void sqlite3UuidBlobToB64With(UuidSimdLevel level, const unsigned char * bytes, unsigned char * result);
+
+/*
+* Parses the 22 characters of base64url sqlite3UuidBlobToB64() produces into a binary UUID. The 4 bits the last character
+* has beyond the UUID must be zero, so that each UUID has one form.
+* Returns 0 on success, or non-zero if the input string is not parsable
+*/
+int sqlite3UuidB64ToBlob(const unsigned char * text, size_t length, unsigned char * out);
+
+/*
+* The portable version of sqlite3UuidB64ToBlob(), kept as the reference for the vectorized kernels
+*/
+int sqlite3UuidB64ToBlobScalar(const unsigned char * text, size_t length, unsigned char * out);
+
+/*
+* Same as sqlite3UuidB64ToBlob(), using the kernel for a given level, which must not be above sqlite3UuidSimdSupported()
+*/
+int sqlite3UuidB64ToBlobWith(UuidSimdLevel level, const unsigned char * text, size_t length, unsigned char * out);
+
+/*
+* Widens count ASCII characters to UTF-16 code units, big-endian if bigEndian is true and little-endian otherwise.
+* The output buffer should be at least 2 * count bytes in length.
+*/
+void sqlite3UuidWiden16(const unsigned char * text, size_t count, bool bigEndian, unsigned char * result);
+
+/*
+* Narrows length bytes of UTF-16 code units, big-endian if bigEndian is true and little-endian otherwise, to one byte each.
+* Code units outside of ASCII become bytes that are not ASCII either. Returns the number of characters written to text, or
+* SIZE_MAX if length is odd or there are more than capacity characters.
+*/
+size_t sqlite3UuidNarrow16(const unsigned char * text16, size_t length, bool bigEndian, unsigned char * text, size_t capacity);
+
+/*
+* Same as sqlite3UuidBlobToStr(), but the 36 characters are written as UTF-16 code units, big-endian if bigEndian is true
+* and little-endian otherwise. The output buffer should be at least 72 bytes in length and is not zero terminated.
+*/
+void sqlite3UuidBlobToStr16(const unsigned char * bytes, bool bigEndian, unsigned char * result);
+
+/*
+* Same as sqlite3UuidStrToBlob(), but the string is length bytes of UTF-16 code units, big-endian if bigEndian is true and
+* little-endian otherwise. Accepts the same forms as sqlite3UuidStrToBlob().
+* Returns 0 on success, or non-zero if the input string is not parsable
+*/
+int sqlite3UuidStr16ToBlob(const unsigned char * guidAsText, size_t length, bool bigEndian, unsigned char * out);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SQLITE_UUID_NAME_HPP
+#define SQLITE_UUID_NAME_HPP
+
+#include <cstddef>
+
+/*
+* Returns true if the running cpu has the SHA extensions, which the version 5 kernels use when they are there
+*/
+bool sqlite3UuidShaNiSupported();
+
+/*
+* Generates the name-based version 5 UUID (RFC 9562 section 5.5) of length bytes of name within a 16-byte namespace UUID:
+* the first 16 bytes of the SHA-1 of the namespace followed by the name, with the version and variant set.
+* The same namespace and name always give the same UUID.
+*/
+void sqlite3UuidV5Generate(const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out);
+
+/*
+* Same as sqlite3UuidV5Generate(), with the SHA extensions if shaNi is true, which it must only be where
+* sqlite3UuidShaNiSupported() is, and the portable SHA-1 otherwise
+*/
+void sqlite3UuidV5GenerateWith(bool shaNi, const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out);
+
+/*
+* Generates count version 5 UUIDs within the same namespace, of names[i] of lengths[i] bytes, into 16 * count bytes of out.
+* Where there are SHA extensions two names are hashed at a time, interleaved, so the cpu is not left waiting on the latency
+* of one hash.
+*/
+void sqlite3UuidV5GenerateBatch(const unsigned char * namespaceBytes, const unsigned char * const * names, const size_t * lengths,
+                                size_t count, unsigned char * out);
+
+/*
+* Same as sqlite3UuidV5GenerateBatch(), choosing the kernel the same way as sqlite3UuidV5GenerateWith()
+*/
+void sqlite3UuidV5GenerateBatchWith(bool shaNi, const unsigned char * namespaceBytes, const unsigned char * const * names, const size_t * lengths,
+                                    size_t count, unsigned char * out);
+
+/*
+* Generates the name-based version 3 UUID of a name within a namespace, as sqlite3UuidV5Generate() does but with MD5.
+* Only there for compatibility with existing version 3 identifiers, version 5 should be preferred.
+*/
+void sqlite3UuidV3Generate(const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out);
+
+#endif
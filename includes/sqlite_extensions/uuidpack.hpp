@@ -0,0 +1,55 @@
+#ifndef SQLITE_UUID_PACK_HPP
+#define SQLITE_UUID_PACK_HPP
+
+#include "sqlite3ext.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Packs are sets of UUIDs stored in a single blob: their 16-byte forms back to back, in increasing order of their bytes,
+* with no duplicates and nothing else. uuid_pack() builds them in SQL, uuid_pack_contains() searches them and uuid_each()
+* turns them back into rows.
+*/
+
+/*
+* A UUID as two big-endian halves, so that comparing keys compares the bytes in memcmp() order
+*/
+struct UuidPackKey
+{
+    uint64_t high;
+    uint64_t low;
+};
+
+/*
+* Reads the key of a 16-byte UUID
+*/
+UuidPackKey sqlite3UuidPackKey(const unsigned char * bytes);
+
+/*
+* Sorts count keys and removes duplicates, returning how many are left at the front of keys
+*/
+size_t sqlite3UuidPackSort(UuidPackKey * keys, size_t count);
+
+/*
+* Writes count keys as 16-byte UUIDs. The output buffer should be at least 16 * count bytes in length.
+*/
+void sqlite3UuidPackWrite(const UuidPackKey * keys, size_t count, unsigned char * pack);
+
+/*
+* Returns true if a 16-byte UUID is one of the count UUIDs of a pack. The pack is binary searched with no data dependent
+* branches, so it must be sorted, which is not checked.
+*/
+bool sqlite3UuidPackContains(const unsigned char * pack, size_t count, const unsigned char * bytes);
+
+/*
+* Returns true if the count UUIDs of a pack are strictly increasing
+*/
+bool sqlite3UuidPackIsSorted(const unsigned char * pack, size_t count);
+
+/*
+* Registers the uuid_each table-valued function with a connection. Called by sqlite3_uuid_init.
+*/
+int sqlite3UuidEachInit(sqlite3 * db);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SQLITE_UUID_RANDOM_HPP
+#define SQLITE_UUID_RANDOM_HPP
+
+#include <cstddef>
+
+/*
+* Fills out with count cryptographically secure random bytes.
+*
+* This is what the UUID functions use instead of sqlite3_randomness(), which takes sqlite's global PRNG mutex on every call.
+* Each thread draws from its own pool, which is refilled in large blocks from a ChaCha20 keystream keyed by the operating system,
+* so handing out bytes needs no locking. The pool is discarded and reseeded in a child process after fork().
+*/
+void sqlite3UuidRandomness(size_t count, void * out);
+
+#endif
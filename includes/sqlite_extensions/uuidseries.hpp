@@ -0,0 +1,14 @@
+#ifndef SQLITE_UUID_SERIES_HPP
+#define SQLITE_UUID_SERIES_HPP
+
+#include "sqlite3ext.h"
+
+struct Uuid7State;
+
+/*
+* Registers the uuid_series table-valued function with a connection. Called by sqlite3_uuid_init.
+* Takes ownership of one reference to state, which version 7 series share with the connection's uuid7() functions.
+*/
+int sqlite3UuidSeriesInit(sqlite3 * db, Uuid7State * state);
+
+#endif
@@ -0,0 +1,328 @@
+/*
+** ULIDs (https://github.com/ulid/spec): 128 bits, like a UUID, made of a 48-bit unix timestamp in milliseconds followed by
+** 80 random bits, and written as 26 characters of Crockford base32. Both forms sort in generation order.
+**
+** The base32 kernels follow the design of the UUID formatting and parsing kernels: a scalar reference, and a version for
+** each instruction set level picked at runtime. The 5-bit groups straddle byte boundaries, so they are moved between
+** the 128-bit value and one byte per character with shifts of two 64-bit halves. The conversion between those bytes and
+** characters, which is where the branches would be, is done 16 characters at a time with SSE2 compares.
+*/
+
+#include "sqlite_extensions/ulid.hpp"
+#include "sqlite_extensions/uuidrandom.hpp"
+
+#include "sqlite3ext.h"
+SQLITE_EXTENSION_INIT3
+
+#include <chrono>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+# define ULID_KERNELS_X86 1
+# define ULID_TARGET(isa) __attribute__((target(isa)))
+# include <immintrin.h>
+#endif
+
+static const char CROCKFORD_ALPHABET[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+/*
+* The random part is seeded with its top bit clear at the start of every millisecond, like the version 7 counter,
+* leaving at least 2^79 increments before it would overflow into the timestamp
+*/
+static const uint64_t ULID_RANDOM_HIGH_SEED_MASK = 0x7fff;
+
+UlidState * sqlite3UlidStateCreate(int refCount)
+{
+    UlidState * state = reinterpret_cast<UlidState *>(sqlite3_malloc(sizeof(UlidState)));
+    if( state != nullptr )
+    {
+        state->lastMilliseconds = 0;
+        state->randomHigh = 0;
+        state->randomLow = 0;
+        state->refCount = refCount;
+    }
+
+    return state;
+}
+
+void sqlite3UlidStateRelease(void * pointer)
+{
+    UlidState * state = reinterpret_cast<UlidState *>(pointer);
+
+    if( --state->refCount == 0 )
+    {
+        sqlite3_free(state);
+    }
+}
+
+/*
+* If the clock has not advanced, or has gone backwards, the previous timestamp is reused and the random part incremented,
+* as the ULID spec's monotonic generation does. Should the random part ever overflow, the timestamp is advanced by a
+* millisecond, rather than failing as the spec would.
+*/
+void sqlite3UlidGenerate(UlidState * state, unsigned char * bytes, size_t count)
+{
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    for(size_t ulidIndex = 0; ulidIndex < count; ulidIndex++, bytes += 16)
+    {
+        if( now > state->lastMilliseconds )
+        {
+            unsigned char seed[10];
+            sqlite3UuidRandomness(sizeof(seed), seed);
+
+            state->lastMilliseconds = now;
+            state->randomHigh = ((uint64_t(seed[0]) << 8) | seed[1]) & ULID_RANDOM_HIGH_SEED_MASK;
+            state->randomLow = 0;
+            for(int byteIndex = 2; byteIndex < 10; byteIndex++)
+            {
+                state->randomLow = (state->randomLow << 8) | seed[byteIndex];
+            }
+        }
+        else if( ++state->randomLow == 0 && ++state->randomHigh >> 16 )
+        {
+            state->lastMilliseconds++;
+            state->randomHigh = 0;
+        }
+
+        const uint64_t milliseconds = static_cast<uint64_t>(state->lastMilliseconds);
+        for(int byteIndex = 0; byteIndex < 6; byteIndex++)
+        {
+            bytes[byteIndex] = static_cast<unsigned char>(milliseconds >> (40 - 8 * byteIndex));
+        }
+
+        bytes[6] = static_cast<unsigned char>(state->randomHigh >> 8);
+        bytes[7] = static_cast<unsigned char>(state->randomHigh);
+        for(int byteIndex = 8; byteIndex < 16; byteIndex++)
+        {
+            bytes[byteIndex] = static_cast<unsigned char>(state->randomLow >> (120 - 8 * byteIndex));
+        }
+    }
+}
+
+/*
+* Splits 16 bytes into the 26 5-bit values of their base32 digits, most significant first. The 128 bits are padded to 130
+* with two zero bits at the top, so the first digit is never above 7.
+*/
+static void sqlite3UlidBlobToDigits(const unsigned char * bytes, unsigned char * digits)
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+    for(int byteIndex = 0; byteIndex < 8; byteIndex++)
+    {
+        high = (high << 8) | bytes[byteIndex];
+        low = (low << 8) | bytes[byteIndex + 8];
+    }
+
+    for(int digitIndex = 0; digitIndex < 26; digitIndex++)
+    {
+        const int shift = 125 - 5 * digitIndex;
+        uint64_t value;
+        if( shift >= 64 )
+        {
+            value = high >> (shift - 64);
+        }
+        else if( shift > 59 )
+        {
+            value = (low >> shift) | (high << (64 - shift));
+        }
+        else
+        {
+            value = low >> shift;
+        }
+        digits[digitIndex] = static_cast<unsigned char>(value & 31);
+    }
+}
+
+/*
+* Joins 26 5-bit values back into 16 bytes. Returns non-zero if the first is above 7, which would need more than 128 bits.
+*/
+static int sqlite3UlidDigitsToBlob(const unsigned char * digits, unsigned char * bytes)
+{
+    if( digits[0] > 7 )
+    {
+        return 1;
+    }
+
+    uint64_t high = 0;
+    uint64_t low = 0;
+    for(int digitIndex = 0; digitIndex < 26; digitIndex++)
+    {
+        high = (high << 5) | (low >> 59);
+        low = (low << 5) | digits[digitIndex];
+    }
+
+    for(int byteIndex = 0; byteIndex < 8; byteIndex++)
+    {
+        bytes[byteIndex] = static_cast<unsigned char>(high >> (56 - 8 * byteIndex));
+        bytes[byteIndex + 8] = static_cast<unsigned char>(low >> (56 - 8 * byteIndex));
+    }
+
+    return 0;
+}
+
+/*
+* Value of every byte as a Crockford base32 digit, or -1 if it is not one. Case is ignored, I and L read as 1 and O as 0.
+*/
+static const signed char CROCKFORD_VALUES[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,16,17, 1,18,19, 1,20,21, 0, 22,23,24,25,26,-1,27,28,29,30,31,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,16,17, 1,18,19, 1,20,21, 0, 22,23,24,25,26,-1,27,28,29,30,31,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+static void sqlite3UlidBlobToStrScalar(const unsigned char * bytes, unsigned char * result)
+{
+    unsigned char digits[26];
+    sqlite3UlidBlobToDigits(bytes, digits);
+
+    for(int digitIndex = 0; digitIndex < 26; digitIndex++)
+    {
+        result[digitIndex] = static_cast<unsigned char>(CROCKFORD_ALPHABET[digits[digitIndex]]);
+    }
+}
+
+static int sqlite3UlidStrToBlobScalar(const unsigned char * text, unsigned char * out)
+{
+    unsigned char digits[26];
+    for(int digitIndex = 0; digitIndex < 26; digitIndex++)
+    {
+        const int value = CROCKFORD_VALUES[text[digitIndex]];
+        if( value < 0 )
+        {
+            return 1;
+        }
+        digits[digitIndex] = static_cast<unsigned char>(value);
+    }
+
+    return sqlite3UlidDigitsToBlob(digits, out);
+}
+
+#ifdef ULID_KERNELS_X86
+/*
+* Digit values to characters: '0' + value below 10, otherwise 'A' + value - 10, plus one for each of the letters I, L, O
+* and U the alphabet skips at or below it
+*/
+ULID_TARGET("sse2") static inline __m128i sqlite3UlidDigitsToCharsSse2(__m128i digits)
+{
+    const __m128i isDigit = _mm_cmplt_epi8(digits, _mm_set1_epi8(10));
+    __m128i letters = _mm_add_epi8(digits, _mm_set1_epi8('A' - 10));
+    letters = _mm_sub_epi8(letters, _mm_cmpgt_epi8(digits, _mm_set1_epi8(17)));
+    letters = _mm_sub_epi8(letters, _mm_cmpgt_epi8(digits, _mm_set1_epi8(19)));
+    letters = _mm_sub_epi8(letters, _mm_cmpgt_epi8(digits, _mm_set1_epi8(21)));
+    letters = _mm_sub_epi8(letters, _mm_cmpgt_epi8(digits, _mm_set1_epi8(26)));
+
+    const __m128i numbers = _mm_add_epi8(digits, _mm_set1_epi8('0'));
+    return _mm_or_si128(_mm_and_si128(isDigit, numbers), _mm_andnot_si128(isDigit, letters));
+}
+
+/*
+* Characters to digit values, the inverse of the above with case ignored and the aliases mapped. Returns false if any
+* character is not a digit. Bytes are compared unsigned by checking that the minimum with the bound leaves them unchanged.
+*/
+ULID_TARGET("sse2") static inline bool sqlite3UlidCharsToDigitsSse2(__m128i text, __m128i & digits)
+{
+    const __m128i numbers = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    const __m128i isNumber = _mm_cmpeq_epi8(_mm_min_epu8(numbers, _mm_set1_epi8(9)), numbers);
+
+    const __m128i letterIndex = _mm_sub_epi8(_mm_and_si128(text, _mm_set1_epi8(static_cast<char>(0xDF))), _mm_set1_epi8('A'));
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letterIndex, _mm_set1_epi8(25)), letterIndex);
+    const __m128i isU = _mm_cmpeq_epi8(letterIndex, _mm_set1_epi8('U' - 'A'));
+    const __m128i isOne = _mm_or_si128(_mm_cmpeq_epi8(letterIndex, _mm_set1_epi8('I' - 'A')), _mm_cmpeq_epi8(letterIndex, _mm_set1_epi8('L' - 'A')));
+    const __m128i isZero = _mm_cmpeq_epi8(letterIndex, _mm_set1_epi8('O' - 'A'));
+
+    __m128i letters = _mm_add_epi8(letterIndex, _mm_set1_epi8(10));
+    letters = _mm_add_epi8(letters, _mm_cmpgt_epi8(letterIndex, _mm_set1_epi8('I' - 'A')));
+    letters = _mm_add_epi8(letters, _mm_cmpgt_epi8(letterIndex, _mm_set1_epi8('L' - 'A')));
+    letters = _mm_add_epi8(letters, _mm_cmpgt_epi8(letterIndex, _mm_set1_epi8('O' - 'A')));
+    letters = _mm_add_epi8(letters, _mm_cmpgt_epi8(letterIndex, _mm_set1_epi8('U' - 'A')));
+    letters = _mm_andnot_si128(isZero, _mm_or_si128(_mm_andnot_si128(isOne, letters), _mm_and_si128(isOne, _mm_set1_epi8(1))));
+
+    const __m128i valid = _mm_or_si128(isNumber, _mm_andnot_si128(isU, isLetter));
+    if( _mm_movemask_epi8(valid) != 0xFFFF )
+    {
+        return false;
+    }
+
+    digits = _mm_or_si128(_mm_and_si128(isNumber, numbers), _mm_andnot_si128(isNumber, letters));
+    return true;
+}
+
+/*
+* The 26 characters are handled as characters 0-15 and 10-25, overlapping so that nothing past the end is read or written
+*/
+ULID_TARGET("sse2") static void sqlite3UlidBlobToStrSse2(const unsigned char * bytes, unsigned char * result)
+{
+    unsigned char digits[26];
+    sqlite3UlidBlobToDigits(bytes, digits);
+
+    const __m128i first = sqlite3UlidDigitsToCharsSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)));
+    const __m128i second = sqlite3UlidDigitsToCharsSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits + 10)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 10), second);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result), first);
+}
+
+ULID_TARGET("sse2") static int sqlite3UlidStrToBlobSse2(const unsigned char * text, unsigned char * out)
+{
+    __m128i first;
+    __m128i second;
+    if( !sqlite3UlidCharsToDigitsSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text)), first) ||
+        !sqlite3UlidCharsToDigitsSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 10)), second) )
+    {
+        return 1;
+    }
+
+    unsigned char digits[26];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(digits + 10), second);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(digits), first);
+    return sqlite3UlidDigitsToBlob(digits, out);
+}
+#endif
+
+void sqlite3UlidBlobToStrWith(UuidSimdLevel level, const unsigned char * bytes, unsigned char * result)
+{
+#ifdef ULID_KERNELS_X86
+    if( level >= UUID_SIMD_SSE2 )
+    {
+        sqlite3UlidBlobToStrSse2(bytes, result);
+        return;
+    }
+#else
+    (void)level;
+#endif
+
+    sqlite3UlidBlobToStrScalar(bytes, result);
+}
+
+void sqlite3UlidBlobToStr(const unsigned char * bytes, unsigned char * result)
+{
+    sqlite3UlidBlobToStrWith(sqlite3UuidSimdSupported(), bytes, result);
+}
+
+int sqlite3UlidStrToBlobWith(UuidSimdLevel level, const unsigned char * text, size_t length, unsigned char * out)
+{
+    if( length != 26 )
+    {
+        return 1;
+    }
+
+#ifdef ULID_KERNELS_X86
+    if( level >= UUID_SIMD_SSE2 )
+    {
+        return sqlite3UlidStrToBlobSse2(text, out);
+    }
+#else
+    (void)level;
+#endif
+
+    return sqlite3UlidStrToBlobScalar(text, out);
+}
+
+int sqlite3UlidStrToBlob(const unsigned char * text, size_t length, unsigned char * out)
+{
+    return sqlite3UlidStrToBlobWith(sqlite3UuidSimdSupported(), text, length, out);
+}
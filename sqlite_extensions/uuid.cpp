@@ -0,0 +1,40 @@
+#include "sqlite_extensions/uuid.hpp"
+
+std::string Uuid::toString() const
+{
+    std::string text(TEXT_LENGTH, '\0');
+    toChars(text.data(), text.data() + text.size());
+    return text;
+}
+
+void Uuid::generate(std::span<Uuid> uuids)
+{
+    sqlite3UuidV4Generate(reinterpret_cast<unsigned char *>(uuids.data()), uuids.size());
+}
+
+void Uuid::generate7(Uuid7State * state, std::span<Uuid> uuids)
+{
+    sqlite3UuidV7Generate(state, reinterpret_cast<unsigned char *>(uuids.data()), uuids.size());
+}
+
+size_t Uuid::parse(std::span<const std::string_view> texts, std::span<Uuid> uuids)
+{
+    // Looked up once, rather than once for each text
+    const UuidSimdLevel level = sqlite3UuidSimdSupported();
+
+    for(size_t textIndex = 0; textIndex < texts.size(); textIndex++)
+    {
+        const std::string_view text = texts[textIndex];
+        if( sqlite3UuidCanonicalToBlobWith(level, reinterpret_cast<const unsigned char *>(text.data()), text.size(), uuids[textIndex].bytes.data()) != 0 )
+        {
+            return textIndex;
+        }
+    }
+
+    return texts.size();
+}
+
+void Uuid::format(std::span<const Uuid> uuids, std::span<char> text)
+{
+    sqlite3UuidBlobsToStrs(reinterpret_cast<const unsigned char *>(uuids.data()), uuids.size(), reinterpret_cast<unsigned char *>(text.data()));
+}
@@ -0,0 +1,139 @@
+/*
+** Blocked Bloom filters of UUIDs, behind uuid_bloom() and uuid_bloom_contains().
+**
+** The blocks follow the split block Bloom filter of Apache Parquet and Impala (after Putze, Sanders and Singler's cache
+** efficient Bloom filters): 256 bits as eight 32-bit words, with one bit set in every word. The bit in each word comes
+** from the top 5 bits of the key multiplied by that word's odd salt, which AVX2 does for all eight words at once.
+** Keeping a key's bits in one block costs a little accuracy over a classic Bloom filter of the same size, about 1.2% false
+** positives at 10 bits per key rather than 0.8%, for a single memory access per lookup.
+*/
+
+#include "sqlite_extensions/uuidbloom.hpp"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+# define UUID_KERNELS_X86 1
+# define UUID_TARGET(isa) __attribute__((target(isa)))
+# include <immintrin.h>
+#endif
+
+namespace
+{
+    const unsigned char BLOOM_HEADER[UUID_BLOOM_HEADER_BYTES] = {'U', 'B', 1, 8};
+
+    const uint32_t BLOOM_SALTS[8] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+    // sqlite's default limit on the length of a blob
+    const size_t BLOOM_MAX_BYTES = 1000000000;
+
+    inline size_t blockCount(size_t size)
+    {
+        return (size - UUID_BLOOM_HEADER_BYTES) / UUID_BLOOM_BLOCK_BYTES;
+    }
+
+    /*
+    * The block the high half of the key picks, by multiplying rather than dividing
+    */
+    inline size_t blockOffset(size_t size, uint64_t key)
+    {
+        const uint64_t block = ((key >> 32) * static_cast<uint64_t>(blockCount(size))) >> 32;
+        return UUID_BLOOM_HEADER_BYTES + static_cast<size_t>(block) * UUID_BLOOM_BLOCK_BYTES;
+    }
+
+    /*
+    * Bit bit of little-endian word word of a block, as a byte and a mask, whatever the platform's byte order
+    */
+    inline size_t bitByte(int word, uint32_t bit)
+    {
+        return static_cast<size_t>(4 * word) + bit / 8;
+    }
+
+    inline unsigned char bitMask(uint32_t bit)
+    {
+        return static_cast<unsigned char>(1u << (bit % 8));
+    }
+}
+
+size_t sqlite3UuidBloomBytes(size_t keys, double bitsPerKey)
+{
+    const double bits = static_cast<double>(keys) * bitsPerKey;
+    const double blocks = bits / (8.0 * UUID_BLOOM_BLOCK_BYTES) + 1.0;
+    if( blocks > static_cast<double>((BLOOM_MAX_BYTES - UUID_BLOOM_HEADER_BYTES) / UUID_BLOOM_BLOCK_BYTES) )
+    {
+        return 0;
+    }
+
+    return UUID_BLOOM_HEADER_BYTES + static_cast<size_t>(blocks) * UUID_BLOOM_BLOCK_BYTES;
+}
+
+void sqlite3UuidBloomInit(unsigned char * filter, size_t size)
+{
+    memcpy(filter, BLOOM_HEADER, UUID_BLOOM_HEADER_BYTES);
+    memset(filter + UUID_BLOOM_HEADER_BYTES, 0, size - UUID_BLOOM_HEADER_BYTES);
+}
+
+bool sqlite3UuidBloomIsValid(const unsigned char * filter, size_t size)
+{
+    return size >= UUID_BLOOM_HEADER_BYTES + UUID_BLOOM_BLOCK_BYTES && (size - UUID_BLOOM_HEADER_BYTES) % UUID_BLOOM_BLOCK_BYTES == 0 &&
+        memcmp(filter, BLOOM_HEADER, UUID_BLOOM_HEADER_BYTES) == 0;
+}
+
+void sqlite3UuidBloomInsert(unsigned char * filter, size_t size, uint64_t key)
+{
+    unsigned char * block = filter + blockOffset(size, key);
+    const uint32_t low = static_cast<uint32_t>(key);
+
+    for(int word = 0; word < 8; word++)
+    {
+        const uint32_t bit = (low * BLOOM_SALTS[word]) >> 27;
+        block[bitByte(word, bit)] |= bitMask(bit);
+    }
+}
+
+static bool sqlite3UuidBloomContainsScalar(const unsigned char * filter, size_t size, uint64_t key)
+{
+    const unsigned char * block = filter + blockOffset(size, key);
+    const uint32_t low = static_cast<uint32_t>(key);
+
+    // Every word is looked at rather than stopping at the first clear bit, as most lookups of a useful filter miss
+    unsigned char missing = 0;
+    for(int word = 0; word < 8; word++)
+    {
+        const uint32_t bit = (low * BLOOM_SALTS[word]) >> 27;
+        missing |= static_cast<unsigned char>(~block[bitByte(word, bit)] & bitMask(bit));
+    }
+    return missing == 0;
+}
+
+#ifdef UUID_KERNELS_X86
+UUID_TARGET("avx2") static bool sqlite3UuidBloomContainsAvx2(const unsigned char * filter, size_t size, uint64_t key)
+{
+    const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(BLOOM_SALTS));
+    const __m256i products = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(key))), salts);
+    const __m256i masks = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(products, 27));
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(filter + blockOffset(size, key)));
+
+    // Whether every bit of the masks is set in the block
+    return _mm256_testc_si256(block, masks) != 0;
+}
+#endif
+
+bool sqlite3UuidBloomContainsWith(UuidSimdLevel level, const unsigned char * filter, size_t size, uint64_t key)
+{
+#ifdef UUID_KERNELS_X86
+    if( level >= UUID_SIMD_AVX2 )
+    {
+        return sqlite3UuidBloomContainsAvx2(filter, size, key);
+    }
+#else
+    (void)level;
+#endif
+
+    return sqlite3UuidBloomContainsScalar(filter, size, key);
+}
+
+bool sqlite3UuidBloomContains(const unsigned char * filter, size_t size, uint64_t key)
+{
+    return sqlite3UuidBloomContainsWith(sqlite3UuidSimdSupported(), filter, size, key);
+}
@@ -0,0 +1,265 @@
+/*
+** The uuid_carray table-valued function reads an array of UUIDs straight out of the application's memory:
+**
+**     SELECT uuid_blob FROM uuid_carray(?)
+**
+** where the parameter is bound with sqlite3UuidBindCarray(), or sqlite3_bind_pointer() and a UuidCarray, produces one row
+** for each UUID of the array, in order, numbered by rowid from 1. Its only visible column is the 16-byte blob, so
+**
+**     SELECT * FROM t WHERE id IN uuid_carray(?)
+**     INSERT INTO t(id) SELECT uuid_blob FROM uuid_carray(?)
+**
+** look up or insert any number of UUIDs in a single step of one statement, rather than a bind, step and reset for each.
+** The hidden uuid column has them as strings, for tables keyed by text.
+**
+** The array is neither copied nor converted to text, unless the uuid column is read. A parameter bound to anything other
+** than a UuidCarray pointer, including NULL, gives no rows.
+*/
+
+#include "sqlite_extensions/uuidcarray.hpp"
+SQLITE_EXTENSION_INIT3
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <cstring>
+
+namespace
+{
+    enum CarrayColumn
+    {
+        CARRAY_COLUMN_UUID_BLOB = 0,
+        CARRAY_COLUMN_POINTER,
+        CARRAY_COLUMN_UUID
+    };
+
+    struct CarrayCursor
+    {
+        sqlite3_vtab_cursor base;
+        const UuidCarray * array;
+        sqlite3_int64 count;
+        sqlite3_int64 rowid;
+    };
+
+    int carrayConnect(sqlite3 * db, void * pAux, int argc, const char * const * argv, sqlite3_vtab ** ppVtab, char ** pzErr)
+    {
+        (void)pAux;
+        (void)argc;
+        (void)argv;
+        (void)pzErr;
+
+        // The pointer comes first of the hidden columns, as table-valued function arguments fill them in order
+        int returnCode = sqlite3_declare_vtab(db, "CREATE TABLE x(uuid_blob BLOB, pointer HIDDEN, uuid TEXT HIDDEN)");
+        if( returnCode != SQLITE_OK )
+        {
+            return returnCode;
+        }
+
+        sqlite3_vtab * table = reinterpret_cast<sqlite3_vtab *>(sqlite3_malloc(sizeof(sqlite3_vtab)));
+        if( table == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        memset(table, 0, sizeof(sqlite3_vtab));
+        sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+
+        *ppVtab = table;
+        return SQLITE_OK;
+    }
+
+    int carrayDisconnect(sqlite3_vtab * pVtab)
+    {
+        sqlite3_free(pVtab);
+        return SQLITE_OK;
+    }
+
+    int carrayOpen(sqlite3_vtab * pVtab, sqlite3_vtab_cursor ** ppCursor)
+    {
+        (void)pVtab;
+
+        CarrayCursor * cursor = reinterpret_cast<CarrayCursor *>(sqlite3_malloc(sizeof(CarrayCursor)));
+        if( cursor == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        memset(cursor, 0, sizeof(CarrayCursor));
+        *ppCursor = &cursor->base;
+        return SQLITE_OK;
+    }
+
+    int carrayClose(sqlite3_vtab_cursor * pCursor)
+    {
+        sqlite3_free(pCursor);
+        return SQLITE_OK;
+    }
+
+    int carrayNext(sqlite3_vtab_cursor * pCursor)
+    {
+        reinterpret_cast<CarrayCursor *>(pCursor)->rowid++;
+        return SQLITE_OK;
+    }
+
+    int carrayEof(sqlite3_vtab_cursor * pCursor)
+    {
+        CarrayCursor * cursor = reinterpret_cast<CarrayCursor *>(pCursor);
+        return cursor->rowid > cursor->count;
+    }
+
+    int carrayColumn(sqlite3_vtab_cursor * pCursor, sqlite3_context * context, int column)
+    {
+        CarrayCursor * cursor = reinterpret_cast<CarrayCursor *>(pCursor);
+        const unsigned char * bytes = cursor->array->bytes + 16 * (cursor->rowid - 1);
+
+        switch( column )
+        {
+            case CARRAY_COLUMN_UUID_BLOB:
+            {
+                sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
+                break;
+            }
+            case CARRAY_COLUMN_UUID:
+            {
+                unsigned char text[37];
+                sqlite3UuidBlobToStr(bytes, text);
+                sqlite3_result_text(context, reinterpret_cast<char *>(text), 36, SQLITE_TRANSIENT);
+                break;
+            }
+            default:
+            {
+                // The pointer cannot be handed back out, sqlite only passes pointers from binds to functions
+                break;
+            }
+        }
+
+        return SQLITE_OK;
+    }
+
+    int carrayRowid(sqlite3_vtab_cursor * pCursor, sqlite_int64 * pRowid)
+    {
+        *pRowid = reinterpret_cast<CarrayCursor *>(pCursor)->rowid;
+        return SQLITE_OK;
+    }
+
+    int carrayFilter(sqlite3_vtab_cursor * pCursor, int idxNum, const char * idxStr, int argc, sqlite3_value ** argv)
+    {
+        CarrayCursor * cursor = reinterpret_cast<CarrayCursor *>(pCursor);
+        (void)idxStr;
+        (void)argc;
+
+        // Without the pointer xBestIndex only offers a plan too costly to be picked, so this is a query without one
+        if( idxNum == 0 )
+        {
+            sqlite3_free(pCursor->pVtab->zErrMsg);
+            pCursor->pVtab->zErrMsg = sqlite3_mprintf("uuid_carray() requires a bound array of UUIDs");
+            return SQLITE_ERROR;
+        }
+
+        cursor->array = reinterpret_cast<const UuidCarray *>(sqlite3_value_pointer(argv[0], UUID_CARRAY_POINTER_TYPE));
+        cursor->count = cursor->array != nullptr ? static_cast<sqlite3_int64>(cursor->array->count) : 0;
+        cursor->rowid = 1;
+        return SQLITE_OK;
+    }
+
+    /*
+    * The pointer argument is required. As with sqlite's own carray, a plan without it, which sqlite asks for while planning
+    * OR terms among others, is given a cost no other plan exceeds rather than an error. xFilter reports the error if it
+    * is ever run. idxNum is 1 when the pointer is handed to xFilter.
+    */
+    int carrayBestIndex(sqlite3_vtab * pVtab, sqlite3_index_info * pIdxInfo)
+    {
+        (void)pVtab;
+        int pointerConstraint = -1;
+        bool pointerUnusable = false;
+
+        for(int i = 0; i < pIdxInfo->nConstraint; i++)
+        {
+            const sqlite3_index_info::sqlite3_index_constraint & constraint = pIdxInfo->aConstraint[i];
+            if( constraint.iColumn == CARRAY_COLUMN_POINTER && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ )
+            {
+                if( constraint.usable )
+                {
+                    pointerConstraint = i;
+                }
+                else
+                {
+                    pointerUnusable = true;
+                }
+            }
+        }
+
+        if( pointerConstraint < 0 )
+        {
+            if( pointerUnusable )
+            {
+                return SQLITE_CONSTRAINT;
+            }
+
+            pIdxInfo->idxNum = 0;
+            pIdxInfo->estimatedCost = 2147483647.0;
+            pIdxInfo->estimatedRows = 2147483647;
+            return SQLITE_OK;
+        }
+
+        pIdxInfo->aConstraintUsage[pointerConstraint].argvIndex = 1;
+        pIdxInfo->aConstraintUsage[pointerConstraint].omit = 1;
+        pIdxInfo->idxNum = 1;
+
+        // Rows come out in rowid order
+        if( pIdxInfo->nOrderBy == 1 && pIdxInfo->aOrderBy[0].iColumn < 0 && !pIdxInfo->aOrderBy[0].desc )
+        {
+            pIdxInfo->orderByConsumed = 1;
+        }
+
+        pIdxInfo->estimatedCost = 1000.0;
+        pIdxInfo->estimatedRows = 1000;
+        return SQLITE_OK;
+    }
+
+    sqlite3_module carrayModule = {
+        0,                  // iVersion
+        0,                  // xCreate - eponymous only
+        carrayConnect,      // xConnect
+        carrayBestIndex,    // xBestIndex
+        carrayDisconnect,   // xDisconnect
+        0,                  // xDestroy
+        carrayOpen,         // xOpen
+        carrayClose,        // xClose
+        carrayFilter,       // xFilter
+        carrayNext,         // xNext
+        carrayEof,          // xEof
+        carrayColumn,       // xColumn
+        carrayRowid,        // xRowid
+        0,                  // xUpdate
+        0,                  // xBegin
+        0,                  // xSync
+        0,                  // xCommit
+        0,                  // xRollback
+        0,                  // xFindFunction
+        0,                  // xRename
+        0,                  // xSavepoint
+        0,                  // xRelease
+        0,                  // xRollbackTo
+        0                   // xShadowName
+    };
+}
+
+int sqlite3UuidBindCarray(sqlite3_stmt * statement, int index, const unsigned char * bytes, size_t count)
+{
+    UuidCarray * array = reinterpret_cast<UuidCarray *>(sqlite3_malloc(sizeof(UuidCarray)));
+    if( array == nullptr )
+    {
+        return SQLITE_NOMEM;
+    }
+
+    array->bytes = bytes;
+    array->count = count;
+
+    // sqlite calls sqlite3_free() on the array once it is done with it, even if binding fails
+    return sqlite3_bind_pointer(statement, index, array, UUID_CARRAY_POINTER_TYPE, sqlite3_free);
+}
+
+int sqlite3UuidCarrayInit(sqlite3 * db)
+{
+    return sqlite3_create_module(db, "uuid_carray", &carrayModule, 0);
+}
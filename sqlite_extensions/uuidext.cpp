@@ -12,137 +12,227 @@
 ******************************************************************************
 **
 ** This SQLite extension implements functions that handle RFC-4122 UUIDs
-** Three SQL functions are implemented:
+** The following SQL functions are implemented:
 **
-**     uuid()        - generate a version 4 UUID as a string
-**     uuid_str(X)   - convert a UUID X into a well-formed UUID string
-**     uuid_blob(X)  - convert a UUID X into a 16-byte blob
+**     uuid()             - generate a version 4 UUID as a string
+**     uuid7()            - generate a time-ordered version 7 UUID as a string
+**     uuid7_blob()       - generate a time-ordered version 7 UUID as a 16-byte blob
+**     uuid7_timestamp(X) - the unix time in milliseconds a version 7, 6 or 1 UUID X was generated at
+**     uuid7_bound(T, B)  - the lowest ('lo') or highest ('hi') version 7 UUID of unix time T in milliseconds, as a 16-byte blob
+**     uuid5(NS, N)       - the name-based version 5 UUID of name N in namespace UUID NS, by SHA-1, as a string
+**     uuid3(NS, N)       - the name-based version 3 UUID of name N in namespace UUID NS, by MD5, as a string
+**     uuid_str(X)        - convert a UUID X into a well-formed UUID string
+**     uuid_blob(X)       - convert a UUID X into a 16-byte blob
+**     uuid_b64(X)        - convert a UUID X into its 22 character base64url string
+**     uuid_from_b64(X)   - convert a 22 character base64url string X into a well-formed UUID string
+**     uuid_version(X)    - the version of UUID X, from its M digit
+**     uuid_variant(X)    - the variant of UUID X, from the top bits of its N digit: 0 for NCS, 1 for RFC 9562, 2 for Microsoft, 3 reserved
+**     uuid_is_valid(X)   - 1 if X is a 16-byte blob or canonical string of an RFC 9562 UUID, or the nil or max UUID, otherwise 0
+**     uuid_hash64(X)     - a stable 64-bit hash of UUID X, as a signed integer
+**     uuid_shard(X, N)   - which of N shards UUID X belongs to, from 0 to N-1, by jump consistent hash
+**     ulid()             - generate a ULID as its 26 character string
+**     ulid_blob()        - generate a ULID as a 16-byte blob
+**     ulid_to_uuid(X)    - convert a ULID X, as a string or a 16-byte blob, into a well-formed UUID string
+**     uuid_to_ulid(X)    - convert a UUID X into a ULID string
+**
+** The aggregates:
+**
+**     uuid_approx_distinct(X) - estimate the number of distinct UUIDs X, in constant memory, by HyperLogLog
+**     uuid_hll(X)             - the HyperLogLog sketch of UUIDs X, as a blob to store and combine later
+**     uuid_hll_merge(S)       - merge sketches S into the sketch of the union of their UUIDs
+**     uuid_bloom(X, B)        - a blocked Bloom filter of UUIDs X with about B bits per UUID, as a blob
+**     uuid_pack(X)            - the pack of UUIDs X: their 16-byte blobs sorted, without duplicates, in one blob
+**
+** With uuid_hll_count(S), the estimated number of distinct UUIDs in sketch S, uuid_bloom_contains(F, X), 0 if UUID X
+** is certainly not in Bloom filter F and 1 if it probably is, and uuid_pack_contains(P, X), 1 if UUID X is in pack P.
+**
+** And the collation:
+**
+**     UUID               - compare text UUIDs in any of the forms uuid_blob() accepts by their 128-bit value
+**
+** The functions dealing in text are registered for UTF-8, UTF-16LE and UTF-16BE, so no database pays for conversions.
+** Along with the table-valued function uuid_series(N [, V]), found in uuidseries.cpp, which generates N UUIDs of version V,
+** uuid_each(P), found in uuidpack.cpp, which returns the UUIDs of pack P, and uuid_carray(A), found in uuidcarray.cpp,
+** which returns the UUIDs of an array bound from C++ with sqlite3UuidBindCarray().
 ******************************************************************************
 */
 
 #include "sqlite_extensions/uuidext.hpp"
 SQLITE_EXTENSION_INIT1
 
-#include <cassert>
-#include <cstring>
-#include <cctype>
+#include "sqlite_extensions/ulid.hpp"
+#include "sqlite_extensions/uuidbloom.hpp"
+#include "sqlite_extensions/uuidcarray.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "sqlite_extensions/uuidhll.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "sqlite_extensions/uuidname.hpp"
+#include "sqlite_extensions/uuidpack.hpp"
+#include "sqlite_extensions/uuidseries.hpp"
+#include "sqlite_extensions/uuidrandom.hpp"
 
-#if !defined(SQLITE_ASCII) && !defined(SQLITE_EBCDIC)
-# define SQLITE_ASCII 1
-#endif
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 
 static const char * ERR_MSG_MALFORMED = "UUID input param was malformed";
+static const char * ERR_MSG_MALFORMED_ULID = "ULID input param was malformed";
+static const char * ERR_MSG_MALFORMED_SKETCH = "UUID sketch input param was malformed";
+static const char * ERR_MSG_MALFORMED_FILTER = "UUID filter input param was malformed";
+static const char * ERR_MSG_MALFORMED_PACK = "UUID pack input param was malformed";
 
 
 /*
-* Translates a single byte of an integer to hex.
-* This routine only works if byte really is a valid hexadecimal character:  0..9a..fA..F
+* Gets the 16-byte UUID blob a sqlite3_value holds or describes, reading text in the given encoding.
+* Blob input is returned where sqlite holds it, without copying. Text input is parsed into scratch, which must hold 16 bytes.
+* Returns nullptr if the input is not well-formed.
 */
-static unsigned char sqlite3UuidHexToInt(int byte)
+static const unsigned char * sqlite3UuidInputToBlob(sqlite3_value * value, int encoding, unsigned char * scratch)
 {
-    assert( (byte>='0' && byte<='9') ||  (byte>='a' && byte<='f') ||  (byte>='A' && byte<='F') );
-#ifdef SQLITE_ASCII
-    byte += 9*(1&(byte>>6));
-#endif
-#ifdef SQLITE_EBCDIC
-    byte += 9*(1&~(byte>>4));
-#endif
-    return (unsigned char)(byte & 0xf);
+    switch( sqlite3_value_type(value) )
+    {
+        case SQLITE_TEXT: 
+        {
+            if( encoding == SQLITE_UTF8 )
+            {
+                const unsigned char * text = sqlite3_value_text(value);
+                if( text == nullptr || sqlite3UuidStrToBlob(text, static_cast<size_t>(sqlite3_value_bytes(value)), scratch) != 0 )
+                {
+                    return nullptr;
+                }
+            }
+            else
+            {
+                const bool bigEndian = encoding == SQLITE_UTF16BE;
+                const void * text = bigEndian ? sqlite3_value_text16be(value) : sqlite3_value_text16le(value);
+                if( text == nullptr || sqlite3UuidStr16ToBlob(reinterpret_cast<const unsigned char *>(text), static_cast<size_t>(sqlite3_value_bytes16(value)), bigEndian, scratch) != 0 )
+                {
+                    return nullptr;
+                }
+            }
+
+            return scratch;
+        }
+        case SQLITE_BLOB: 
+        {
+            if( sqlite3_value_bytes(value) != 16 )
+            {
+                return nullptr;
+            }
+
+            return reinterpret_cast<const unsigned char *>(sqlite3_value_blob(value));
+        }
+        default: 
+        {
+            return nullptr;
+        }
+    }
 }
 
 /*
-* Converts a 16-byte BLOB into a well-formed RFC-4122 UUID with 8-4-4-4-12 hexidecimal digits, each representing 4 bits.
-* The output buffer should be at least 37 bytes in length and will be zero terminted.
+* Sets a text result in the given encoding from a 16-byte blob.
+*
+* The text is formatted on the stack and copied with SQLITE_TRANSIENT on purpose. sqlite copies a transient result into the
+* output register's own buffer, which it keeps between rows, so a statement producing many rows does no allocation per row.
+* Handing over a buffer from sqlite3_malloc() with sqlite3_free() as the destructor would save a 36 byte copy, but costs a
+* malloc and free on every row instead. The allocation counts in sqlite_extensions_bench show the difference.
+*/
+static void sqlite3UuidResultText(sqlite3_context * context, int encoding, const unsigned char * bytes)
+{
+    if( encoding == SQLITE_UTF8 )
+    {
+        unsigned char text[37];
+        sqlite3UuidBlobToStr(bytes, text);
+        sqlite3_result_text(context, reinterpret_cast<char *>(text), 36, SQLITE_TRANSIENT);
+    }
+    else if( encoding == SQLITE_UTF16BE )
+    {
+        unsigned char text[72];
+        sqlite3UuidBlobToStr16(bytes, true, text);
+        sqlite3_result_text16be(context, text, 72, SQLITE_TRANSIENT);
+    }
+    else
+    {
+        unsigned char text[72];
+        sqlite3UuidBlobToStr16(bytes, false, text);
+        sqlite3_result_text16le(context, text, 72, SQLITE_TRANSIENT);
+    }
+}
+
+/*
+* Gets a text argument as ASCII bytes, narrowing UTF-16 text into buffer, which holds capacity bytes. UTF-8 text is returned
+* where sqlite holds it. Returns nullptr if the argument is not text, or is UTF-16 longer than capacity.
 */
-static void sqlite3UuidBlobToStr(const unsigned char * bytes, unsigned char * result)
+static const unsigned char * sqlite3AsciiArgument(sqlite3_value * value, int encoding, unsigned char * buffer, size_t capacity, size_t & length)
 {
-    static const char digits[] = "0123456789abcdef";
+    if( sqlite3_value_type(value) != SQLITE_TEXT )
+    {
+        return nullptr;
+    }
 
-    for(int byteIndex = 0, pattern = 0x550; byteIndex < 16; byteIndex++, pattern = pattern>>1)
+    if( encoding == SQLITE_UTF8 )
     {
-        if( pattern & 1 )
-        {
-            result[0] = '-';
-            result++;
-        }
+        const unsigned char * text = sqlite3_value_text(value);
+        length = static_cast<size_t>(sqlite3_value_bytes(value));
+        return text;
+    }
 
-        unsigned byteValue = bytes[byteIndex];
-        result[0] = digits[byteValue>>4];
-        result[1] = digits[byteValue & 0xf];
-        result += 2;
+    const bool bigEndian = encoding == SQLITE_UTF16BE;
+    const void * text16 = bigEndian ? sqlite3_value_text16be(value) : sqlite3_value_text16le(value);
+    if( text16 == nullptr )
+    {
+        return nullptr;
     }
 
-    *result = 0;
+    length = sqlite3UuidNarrow16(reinterpret_cast<const unsigned char *>(text16), static_cast<size_t>(sqlite3_value_bytes16(value)), bigEndian, buffer, capacity);
+    return length == SIZE_MAX ? nullptr : buffer;
 }
 
 /*
-* Parses a zero-terminated input string into a binary UUID
-* Returns 0 on success, or non-zero if the input string is not parsable
-*/
-static int sqlite3UuidStrToBlob(const unsigned char * guidAsText, unsigned char * out)
-{
-   if( guidAsText[0]=='{' )
-   {
-      ++guidAsText;
-   }
-
-   for(size_t i = 0; i < 16; ++i)
-   {
-      if( guidAsText[0]=='-' )
-      {
-         ++guidAsText;
-      }
-      
-      if( isxdigit(guidAsText[0]) && isxdigit(guidAsText[1]) )
-      {
-         out[i] = (sqlite3UuidHexToInt(guidAsText[0]) << 4) + sqlite3UuidHexToInt(guidAsText[1]);
-         guidAsText += 2;
-      }
-      else
-      {
-         return 1;
-      }
-   }
-
-   if( guidAsText[0]=='}' )
-   {
-      ++guidAsText;
-   }
-
-   return guidAsText[0] != 0;
+* Sets a text result in the given encoding from count ASCII characters, copied with SQLITE_TRANSIENT for the same reason
+* sqlite3UuidResultText() does. At most 36 characters.
+*/
+static void sqlite3ResultAscii(sqlite3_context * context, int encoding, const unsigned char * text, size_t count)
+{
+    if( encoding == SQLITE_UTF8 )
+    {
+        sqlite3_result_text(context, reinterpret_cast<const char *>(text), static_cast<int>(count), SQLITE_TRANSIENT);
+        return;
+    }
+
+    const bool bigEndian = encoding == SQLITE_UTF16BE;
+    unsigned char text16[72];
+    sqlite3UuidWiden16(text, count, bigEndian, text16);
+    if( bigEndian )
+    {
+        sqlite3_result_text16be(context, text16, static_cast<int>(2 * count), SQLITE_TRANSIENT);
+    }
+    else
+    {
+        sqlite3_result_text16le(context, text16, static_cast<int>(2 * count), SQLITE_TRANSIENT);
+    }
 }
 
 /*
-* Convert a sqlite3_value to a a 16-byte UUID blob.
-* Sets out pointer to the blob or nullptr if the input is not well-formed.
+* Gets the 16 bytes a ULID held in a sqlite3_value describes, the same way sqlite3UuidInputToBlob() does for UUIDs.
+* Returns nullptr if the input is not a 26 character ULID or a 16-byte blob.
 */
-static void sqlite3UuidInputToBlob(sqlite3_value * value, unsigned char * out)
+static const unsigned char * sqlite3UlidInputToBlob(sqlite3_value * value, int encoding, unsigned char * scratch)
 {
-    switch( sqlite3_value_type(value) )
+    if( sqlite3_value_type(value) == SQLITE_BLOB )
     {
-        case SQLITE_TEXT: 
-        {
-            const unsigned char * text = sqlite3_value_text(value);
-            if( sqlite3UuidStrToBlob(text, out) != 0 )
-                out = nullptr;
-        }
-        case SQLITE_BLOB: 
-        {
-            if( sqlite3_value_bytes(value) == 16 )
-            {
-                const unsigned char * bytes = reinterpret_cast<const unsigned char *>(sqlite3_value_blob(value));
-                memcpy(out, bytes, 16);
-            }
-            else
-            {
-                out = nullptr;
-            }
-        }
-        default: 
-        {
-            out = nullptr;
-        }
+        return sqlite3_value_bytes(value) == 16 ? reinterpret_cast<const unsigned char *>(sqlite3_value_blob(value)) : nullptr;
+    }
+
+    unsigned char buffer[26];
+    size_t length = 0;
+    const unsigned char * text = sqlite3AsciiArgument(value, encoding, buffer, sizeof(buffer), length);
+    if( text == nullptr || sqlite3UlidStrToBlob(text, length, scratch) != 0 )
+    {
+        return nullptr;
     }
+
+    return scratch;
 }
 
 /* 
@@ -155,19 +245,161 @@ static void sqlite3UuidInputToBlob(sqlite3_value * value, unsigned char * out)
 * version is always "4" (a random UUID).  The upper three bits of N digit are the "variant".  This library only supports variant 1 (indicated by
 * values of N between '8' and 'b') as those are overwhelming the most common.  Other variants are for legacy compatibility only.
 */
+template<int encoding>
 static void sqlite3UuidFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
 {
     unsigned char bytes[16];
-    unsigned char text[37];
     (void)argc;
     (void)argv;
     
-    sqlite3_randomness(16, bytes);
-    bytes[6] = (bytes[6]&0x0f) + 0x40; // set the first nibble of the 6th byte to 4 for the version of uuid
-    bytes[8] = (bytes[8]&0x3f) + 0x80; // set the first two bits of the 8th byte to 2 for the variant
+    sqlite3UuidV4Generate(bytes, 1);
+
+    sqlite3UuidResultText(context, encoding, bytes);
+}
+
+/* 
+* Implementation of the uuid7() sql function we are adding to sqlite
+* The output will be a well-formed RFC 9562 version 7 UUID string in the same format uuid() produces, with the M digit always "7".
+*
+* Version 7 UUIDs begin with the time they were generated in milliseconds, so consecutive values land next to each other in
+* an index rather than on a random b-tree page. Values generated on the same connection are strictly increasing.
+*/
+template<int encoding>
+static void sqlite3Uuid7Func(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char bytes[16];
+    (void)argc;
+    (void)argv;
+
+    sqlite3UuidV7Generate(reinterpret_cast<Uuid7State *>(sqlite3_user_data(context)), bytes, 1);
+
+    sqlite3UuidResultText(context, encoding, bytes);
+}
+
+/* 
+* Implementation of the uuid7_blob() sql function we are adding to sqlite
+* Same as uuid7(), but the output is the 16-byte blob, which sorts in generation order with memcmp.
+*/
+static void sqlite3Uuid7BlobFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char bytes[16];
+    (void)argc;
+    (void)argv;
+
+    sqlite3UuidV7Generate(reinterpret_cast<Uuid7State *>(sqlite3_user_data(context)), bytes, 1);
+
+    sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
+}
+
+/* 
+* Implementation of the uuid7_timestamp() sql function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts.
+* The output is the unix time in milliseconds the UUID was generated at, for versions 7, 6 and 1, or NULL for versions that
+* carry no time. Versions 6 and 1 count in 100 nanoseconds, and are rounded down to the millisecond.
+*/
+template<int encoding>
+static void sqlite3Uuid7TimestampFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    int64_t milliseconds = 0;
+    if( sqlite3UuidTimestamp(bytes, milliseconds) )
+    {
+        sqlite3_result_int64(context, milliseconds);
+    }
+}
+
+/* 
+* Implementation of the uuid7_bound() sql function we are adding to sqlite
+*
+* The first input is a unix time in milliseconds, the second 'lo' or 'hi'.
+* The output is the lowest or highest version 7 UUID that can be generated in that millisecond, as a 16-byte blob. Keys
+* generated from one time to another are then the range between two bounds, which an index on the key can scan directly:
+*
+*    WHERE id BETWEEN uuid7_bound(:from, 'lo') AND uuid7_bound(:to, 'hi')
+*
+* Lower case canonical text sorts in the same order as the bytes, so uuid_str() of the bounds does the same for text keys.
+*/
+static void sqlite3Uuid7BoundFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char bytes[16];
+    (void)argc;
+
+    const sqlite3_int64 milliseconds = sqlite3_value_int64(argv[0]);
+    if( sqlite3_value_type(argv[0]) != SQLITE_INTEGER || milliseconds < 0 || milliseconds > 0xffffffffffffll )
+    {
+        sqlite3_result_error(context, "uuid7_bound() needs a unix time in milliseconds from 0 to 281474976710655", -1);
+        return;
+    }
+
+    const unsigned char * bound = sqlite3_value_text(argv[1]);
+    const bool upper = bound != nullptr && sqlite3_stricmp(reinterpret_cast<const char *>(bound), "hi") == 0;
+    if( !upper && (bound == nullptr || sqlite3_stricmp(reinterpret_cast<const char *>(bound), "lo") != 0) )
+    {
+        sqlite3_result_error(context, "uuid7_bound() needs 'lo' or 'hi' for the bound", -1);
+        return;
+    }
+
+    sqlite3UuidV7Bound(milliseconds, upper, bytes);
+    sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
+}
+
+/* 
+* Implementation of the uuid5() and uuid3() sql functions we are adding to sqlite
+*
+* The first input is the namespace, a UUID in any form uuid_blob() accepts, such as 6ba7b810-9dad-11d1-80b4-00c04fd430c8
+* for DNS names. The second is the name, hashed as the bytes of its UTF-8 text, or as is if it is a BLOB. A NULL name gives
+* NULL, so a nullable column can be passed straight in.
+* The output is the name-based UUID string, which is always the same for the same namespace and name, so rows re-imported
+* from the same source get the same keys.
+*/
+template<int encoding, int version>
+static void sqlite3UuidNameFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    unsigned char bytes[16];
+    (void)argc;
+
+    const unsigned char * namespaceBytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( namespaceBytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    if( sqlite3_value_type(argv[1]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    // Text is fetched as UTF-8 whatever the database encoding, so a name has the same UUID in every database
+    const unsigned char * name = sqlite3_value_type(argv[1]) == SQLITE_BLOB ? reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[1])) : sqlite3_value_text(argv[1]);
+    const size_t length = static_cast<size_t>(sqlite3_value_bytes(argv[1]));
+    if( name == nullptr && length != 0 )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if( version == 5 )
+    {
+        sqlite3UuidV5Generate(namespaceBytes, name, length, bytes);
+    }
+    else
+    {
+        sqlite3UuidV3Generate(namespaceBytes, name, length, bytes);
+    }
 
-    sqlite3UuidBlobToStr(bytes, text);
-    sqlite3_result_text(context, reinterpret_cast<char *>(text), 36, SQLITE_TRANSIENT);
+    sqlite3UuidResultText(context, encoding, bytes);
 }
 
 /* 
@@ -196,22 +428,20 @@ static void sqlite3UuidFunc(sqlite3_context * context, int argc, sqlite3_value *
 * version is always "4" (a random UUID).  The upper three bits of N digit are the "variant".  This library only supports variant 1 (indicated by
 * values of N between '8' and 'b') as those are overwhelming the most common.  Other variants are for legacy compatibility only.
 */
+template<int encoding>
 static void sqlite3UuidStrFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
 {
-    unsigned char bytes[16];
-    unsigned char text[37];
+    unsigned char scratch[16];
     (void)argc;
     
-    sqlite3UuidInputToBlob(argv[0], bytes);
-    
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
     if( bytes == nullptr )
     {
-        sqlite3_result_error(context, ERR_MSG_MALFORMED, sizeof(ERR_MSG_MALFORMED));
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
         return;
     }
 
-    sqlite3UuidBlobToStr(bytes, text);
-    sqlite3_result_text(context, reinterpret_cast<char *>(text), 36, SQLITE_TRANSIENT);
+    sqlite3UuidResultText(context, encoding, bytes);
 }
 
 /* 
@@ -232,47 +462,1093 @@ static void sqlite3UuidStrFunc(sqlite3_context * context, int argc, sqlite3_valu
 *     a0ee-bc99-9c0b-4ef8-bb6d-6bb9-bd38-0a11
 *     {a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}
 *
+* The 22 character base64url form from uuid_b64(), such as oO68mZwLTvi7bWu5vTgKEQ, is accepted as well.
+*
 * The output will always be a 16-byte blob.
 */
+template<int encoding>
 static void sqlite3UuidBlobFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
 {
-    unsigned char bytes[16];
+    unsigned char scratch[16];
     (void)argc;
 
-    sqlite3UuidInputToBlob(argv[0], bytes);
-   
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
     if( bytes == nullptr )
     {
-        sqlite3_result_error(context, ERR_MSG_MALFORMED, sizeof(ERR_MSG_MALFORMED));
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
         return;
     }
 
+    // For blob input this copies straight from the argument. sqlite3_result_value() would look cheaper, but it allocates
+    // a fresh copy every call, where a transient result reuses the output register's buffer.
     sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
 }
+/* 
+* Implementation of the uuid_version() function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts, or NULL, which gives NULL.
+* The output is the version from the M digit, whatever the variant: 4 for uuid(), 7 for uuid7(), and so on.
+*/
+template<int encoding>
+static void sqlite3UuidVersionFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
 
+    sqlite3_result_int(context, bytes[6] >> 4);
+}
 
 /*
-* Call this to register the extension with sqlite before using it
+* Variant by the top 3 bits of the 9th byte: 0xx is NCS, 10x RFC 9562, 110 Microsoft and 111 reserved
 */
-#ifdef _WIN32
-__declspec(dllexport)
-#endif
-int sqlite3_uuid_init(sqlite3 * db, char ** pzErrMsg, const sqlite3_api_routines * pApi)
+static const unsigned char UUID_VARIANTS[8] = {0, 0, 0, 0, 1, 1, 2, 3};
+
+/* 
+* Implementation of the uuid_variant() function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts, or NULL, which gives NULL.
+* The output is the variant from the top bits of the N digit: 0 for NCS, 1 for RFC 9562 (and 4122), which is what every
+* function here generates, 2 for Microsoft, and 3 for the reserved variant.
+*/
+template<int encoding>
+static void sqlite3UuidVariantFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
 {
-    int returnCode = SQLITE_OK;
-    SQLITE_EXTENSION_INIT2(pApi);
-    (void)pzErrMsg;
+    unsigned char scratch[16];
+    (void)argc;
 
-    returnCode = sqlite3_create_function(db, "uuid", 0, SQLITE_UTF8|SQLITE_INNOCUOUS, 0, sqlite3UuidFunc, 0, 0);
-    
-    if( returnCode == SQLITE_OK )
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
     {
-        returnCode = sqlite3_create_function(db, "uuid_str", 1, SQLITE_UTF8|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, sqlite3UuidStrFunc, 0, 0);
+        return;
     }
-    
-    if( returnCode == SQLITE_OK )
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    sqlite3_result_int(context, UUID_VARIANTS[bytes[8] >> 5]);
+}
+
+/* 
+* Implementation of the uuid_is_valid() function we are adding to sqlite
+*
+* Stricter than the other functions: the input must be a 16-byte blob, or text in the canonical 8-4-4-4-12 form in either
+* case, and hold an RFC 9562 UUID of versions 1 to 8, or be the nil or max UUID. The output is 1 if so and 0 otherwise,
+* never an error, and NULL for NULL, so CHECK(uuid_is_valid(id)) still allows a nullable column to be NULL.
+*
+* Canonical text goes through the vectorized parser only, with no allocation, so the check costs about as much as uuid_blob().
+*/
+template<int encoding>
+static void sqlite3UuidIsValidFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    const unsigned char * bytes = nullptr;
+    (void)argc;
+
+    switch( sqlite3_value_type(argv[0]) )
+    {
+        case SQLITE_NULL:
+        {
+            return;
+        }
+        case SQLITE_BLOB:
+        {
+            if( sqlite3_value_bytes(argv[0]) == 16 )
+            {
+                bytes = reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0]));
+            }
+            break;
+        }
+        case SQLITE_TEXT:
+        {
+            unsigned char buffer[36];
+            size_t length = 0;
+            const unsigned char * text = sqlite3AsciiArgument(argv[0], encoding, buffer, sizeof(buffer), length);
+            if( text != nullptr && sqlite3UuidCanonicalToBlob(text, length, scratch) == 0 )
+            {
+                bytes = scratch;
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    bool valid = false;
+    if( bytes != nullptr )
+    {
+        const int version = bytes[6] >> 4;
+        const bool rfc = (bytes[8] & 0xc0) == 0x80 && version >= 1 && version <= 8;
+        unsigned char orBytes = 0;
+        unsigned char andBytes = 0xff;
+        for(int byteIndex = 0; byteIndex < 16; byteIndex++)
+        {
+            orBytes |= bytes[byteIndex];
+            andBytes &= bytes[byteIndex];
+        }
+        valid = rfc || orBytes == 0 || andBytes == 0xff;
+    }
+
+    sqlite3_result_int(context, valid ? 1 : 0);
+}
+
+/* 
+* Implementation of the uuid_hash64() function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts, so every form of a UUID hashes the same.
+* The output is the 64-bit hash from sqlite3UuidHash64(), as sqlite's signed integer. It is stable across platforms and
+* releases, so it can be stored, or used to route rows between databases.
+*/
+template<int encoding>
+static void sqlite3UuidHash64Func(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    sqlite3_result_int64(context, static_cast<sqlite3_int64>(sqlite3UuidHash64(bytes)));
+}
+
+/* 
+* Implementation of the uuid_shard() function we are adding to sqlite
+*
+* The first input is a UUID in any form uuid_blob() accepts, the second the number of shards, from 1 to 2147483647.
+* The output is the shard from 0 to N-1 the UUID belongs to, by jump consistent hash of its uuid_hash64(). Adding a shard
+* moves only the UUIDs that now belong on the new one, which is 1 / N of them.
+*/
+template<int encoding>
+static void sqlite3UuidShardFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const sqlite3_int64 shards = sqlite3_value_int64(argv[1]);
+    if( sqlite3_value_type(argv[1]) != SQLITE_INTEGER || shards < 1 || shards > INT32_MAX )
     {
-        returnCode = sqlite3_create_function(db, "uuid_blob", 1, SQLITE_UTF8|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, sqlite3UuidBlobFunc, 0, 0);
+        sqlite3_result_error(context, "uuid_shard() needs a number of shards from 1 to 2147483647", -1);
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    sqlite3_result_int(context, sqlite3UuidShard(bytes, static_cast<int32_t>(shards)));
+}
+
+/* 
+* Step of the uuid_approx_distinct() and uuid_hll() aggregates we are adding to sqlite
+*
+* The input values can be strings or BLOBs, in any form uuid_blob() accepts. NULLs are skipped, like COUNT(DISTINCT X) does.
+* The sketch lives in the aggregate context, so each group takes the same 16KB however many rows it has.
+*/
+template<int encoding>
+static void sqlite3UuidHllStep(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    unsigned char * sketch = reinterpret_cast<unsigned char *>(sqlite3_aggregate_context(context, UUID_HLL_SKETCH_BYTES));
+    if( sketch == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    // sqlite zeroes a new aggregate context, which leaves the header to write
+    if( sketch[0] == 0 )
+    {
+        sqlite3UuidHllInit(sketch);
+    }
+
+    sqlite3UuidHllAdd(sketch + UUID_HLL_HEADER_BYTES, bytes);
+}
+
+/* 
+* Result of the uuid_approx_distinct() aggregate: the estimated number of distinct UUIDs, or 0 for no rows
+*/
+static void sqlite3UuidApproxDistinctFinal(sqlite3_context * context)
+{
+    const unsigned char * sketch = reinterpret_cast<const unsigned char *>(sqlite3_aggregate_context(context, 0));
+    if( sketch == nullptr )
+    {
+        sqlite3_result_int64(context, 0);
+        return;
+    }
+
+    sqlite3_result_int64(context, std::llround(sqlite3UuidHllEstimate(sketch + UUID_HLL_HEADER_BYTES)));
+}
+
+/* 
+* Result of the uuid_hll() aggregate: the sketch as a blob, which is an empty sketch for no rows
+*/
+static void sqlite3UuidHllFinal(sqlite3_context * context)
+{
+    unsigned char * sketch = reinterpret_cast<unsigned char *>(sqlite3_aggregate_context(context, UUID_HLL_SKETCH_BYTES));
+    if( sketch == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if( sketch[0] == 0 )
+    {
+        sqlite3UuidHllInit(sketch);
+    }
+
+    sqlite3_result_blob(context, sketch, static_cast<int>(UUID_HLL_SKETCH_BYTES), SQLITE_TRANSIENT);
+}
+
+/* 
+* Step of the uuid_hll_merge() aggregate we are adding to sqlite
+*
+* The input values must be sketches from uuid_hll() or uuid_hll_merge(), or NULL, which is skipped.
+*/
+static void sqlite3UuidHllMergeStep(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * input = sqlite3_value_type(argv[0]) == SQLITE_BLOB ? reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0])) : nullptr;
+    if( input == nullptr || !sqlite3UuidHllIsValid(input, static_cast<size_t>(sqlite3_value_bytes(argv[0]))) )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED_SKETCH, -1);
+        return;
+    }
+
+    unsigned char * sketch = reinterpret_cast<unsigned char *>(sqlite3_aggregate_context(context, UUID_HLL_SKETCH_BYTES));
+    if( sketch == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if( sketch[0] == 0 )
+    {
+        memcpy(sketch, input, UUID_HLL_SKETCH_BYTES);
+    }
+    else
+    {
+        sqlite3UuidHllMerge(sketch + UUID_HLL_HEADER_BYTES, input + UUID_HLL_HEADER_BYTES);
+    }
+}
+
+/* 
+* Result of the uuid_hll_merge() aggregate: the merged sketch as a blob, or NULL if there were no sketches to merge
+*/
+static void sqlite3UuidHllMergeFinal(sqlite3_context * context)
+{
+    const unsigned char * sketch = reinterpret_cast<const unsigned char *>(sqlite3_aggregate_context(context, 0));
+    if( sketch != nullptr )
+    {
+        sqlite3_result_blob(context, sketch, static_cast<int>(UUID_HLL_SKETCH_BYTES), SQLITE_TRANSIENT);
+    }
+}
+
+/* 
+* Implementation of the uuid_hll_count() function we are adding to sqlite
+*
+* The input value must be a sketch from uuid_hll() or uuid_hll_merge(), or NULL, which gives NULL.
+* The output is the estimated number of distinct UUIDs in it, the same uuid_approx_distinct() gives over the same rows.
+*/
+static void sqlite3UuidHllCountFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * sketch = sqlite3_value_type(argv[0]) == SQLITE_BLOB ? reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0])) : nullptr;
+    if( sketch == nullptr || !sqlite3UuidHllIsValid(sketch, static_cast<size_t>(sqlite3_value_bytes(argv[0]))) )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED_SKETCH, -1);
+        return;
+    }
+
+    sqlite3_result_int64(context, std::llround(sqlite3UuidHllEstimate(sketch + UUID_HLL_HEADER_BYTES)));
+}
+
+/*
+* Aggregate context of uuid_bloom(): the keys of the UUIDs seen so far, as the filter cannot be sized until they are all in
+*/
+struct UuidBloomBuilder
+{
+    uint64_t * keys;
+    sqlite3_uint64 count;
+    sqlite3_uint64 capacity;
+    double bitsPerKey;
+};
+
+/* 
+* Step of the uuid_bloom() aggregate we are adding to sqlite
+*
+* The first input values can be strings or BLOBs, in any form uuid_blob() accepts. NULLs are skipped.
+* The second is the number of bits per UUID, from 1 to 64, taken from the first row: 10 gives about 1% false positives.
+*/
+template<int encoding>
+static void sqlite3UuidBloomStep(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    UuidBloomBuilder * builder = reinterpret_cast<UuidBloomBuilder *>(sqlite3_aggregate_context(context, sizeof(UuidBloomBuilder)));
+    if( builder == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if( builder->bitsPerKey == 0.0 )
+    {
+        const int bitsType = sqlite3_value_type(argv[1]);
+        const double bitsPerKey = sqlite3_value_double(argv[1]);
+        if( (bitsType != SQLITE_INTEGER && bitsType != SQLITE_FLOAT) || !(bitsPerKey >= 1.0 && bitsPerKey <= 64.0) )
+        {
+            sqlite3_result_error(context, "uuid_bloom() needs from 1 to 64 bits per key", -1);
+            return;
+        }
+        builder->bitsPerKey = bitsPerKey;
+    }
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    if( builder->count == builder->capacity )
+    {
+        const sqlite3_uint64 capacity = builder->capacity == 0 ? 1024 : 2 * builder->capacity;
+        uint64_t * keys = reinterpret_cast<uint64_t *>(sqlite3_realloc64(builder->keys, capacity * sizeof(uint64_t)));
+        if( keys == nullptr )
+        {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+        builder->keys = keys;
+        builder->capacity = capacity;
+    }
+
+    builder->keys[builder->count++] = sqlite3UuidHash64(bytes);
+}
+
+/* 
+* Result of the uuid_bloom() aggregate: the filter as a blob, which is an empty filter for no rows.
+* sqlite calls this after an error in a step too, so it is where the keys are always freed.
+*/
+static void sqlite3UuidBloomFinal(sqlite3_context * context)
+{
+    UuidBloomBuilder * builder = reinterpret_cast<UuidBloomBuilder *>(sqlite3_aggregate_context(context, 0));
+    const sqlite3_uint64 count = builder != nullptr ? builder->count : 0;
+    const double bitsPerKey = builder != nullptr && builder->bitsPerKey > 0.0 ? builder->bitsPerKey : 1.0;
+
+    const size_t size = sqlite3UuidBloomBytes(static_cast<size_t>(count), bitsPerKey);
+    unsigned char * filter = size != 0 ? reinterpret_cast<unsigned char *>(sqlite3_malloc64(size)) : nullptr;
+
+    if( size == 0 )
+    {
+        sqlite3_result_error_toobig(context);
+    }
+    else if( filter == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+    }
+    else
+    {
+        sqlite3UuidBloomInit(filter, size);
+        for(sqlite3_uint64 keyIndex = 0; keyIndex < count; keyIndex++)
+        {
+            sqlite3UuidBloomInsert(filter, size, builder->keys[keyIndex]);
+        }
+        sqlite3_result_blob64(context, filter, size, sqlite3_free);
+    }
+
+    if( builder != nullptr )
+    {
+        sqlite3_free(builder->keys);
+        builder->keys = nullptr;
+    }
+}
+
+/* 
+* Implementation of the uuid_bloom_contains() function we are adding to sqlite
+*
+* The first input value must be a filter from uuid_bloom(), and the second a UUID in any form uuid_blob() accepts. Either
+* being NULL gives NULL. The output is 0 if the UUID was certainly not in the filter, and 1 if it probably was, so
+*
+*     WHERE NOT uuid_bloom_contains((SELECT filter FROM filters), :id) OR NOT EXISTS (SELECT 1 FROM t WHERE id = :id)
+*
+* only goes down the index for the few UUIDs the filter cannot rule out.
+*/
+template<int encoding>
+static void sqlite3UuidBloomContainsFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL || sqlite3_value_type(argv[1]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * filter = sqlite3_value_type(argv[0]) == SQLITE_BLOB ? reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0])) : nullptr;
+    const size_t size = static_cast<size_t>(sqlite3_value_bytes(argv[0]));
+    if( filter == nullptr || !sqlite3UuidBloomIsValid(filter, size) )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED_FILTER, -1);
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[1], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    sqlite3_result_int(context, sqlite3UuidBloomContains(filter, size, sqlite3UuidHash64(bytes)) ? 1 : 0);
+}
+
+/*
+* Aggregate context of uuid_pack(): the keys of the UUIDs seen so far, sorted once they are all in
+*/
+struct UuidPackBuilder
+{
+    UuidPackKey * keys;
+    sqlite3_uint64 count;
+    sqlite3_uint64 capacity;
+};
+
+/* 
+* Step of the uuid_pack() aggregate we are adding to sqlite
+*
+* The input values can be strings or BLOBs, in any form uuid_blob() accepts. NULLs are skipped.
+*/
+template<int encoding>
+static void sqlite3UuidPackStep(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    UuidPackBuilder * builder = reinterpret_cast<UuidPackBuilder *>(sqlite3_aggregate_context(context, sizeof(UuidPackBuilder)));
+    if( builder == nullptr )
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if( builder->count == builder->capacity )
+    {
+        const sqlite3_uint64 capacity = builder->capacity == 0 ? 64 : 2 * builder->capacity;
+        UuidPackKey * keys = reinterpret_cast<UuidPackKey *>(sqlite3_realloc64(builder->keys, capacity * sizeof(UuidPackKey)));
+        if( keys == nullptr )
+        {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+        builder->keys = keys;
+        builder->capacity = capacity;
+    }
+
+    builder->keys[builder->count++] = sqlite3UuidPackKey(bytes);
+}
+
+/* 
+* Result of the uuid_pack() aggregate: the pack as a blob, which is empty for no rows.
+* sqlite calls this after an error in a step too, so it is where the keys are always freed.
+*/
+static void sqlite3UuidPackFinal(sqlite3_context * context)
+{
+    UuidPackBuilder * builder = reinterpret_cast<UuidPackBuilder *>(sqlite3_aggregate_context(context, 0));
+    if( builder == nullptr || builder->count == 0 )
+    {
+        sqlite3_result_zeroblob(context, 0);
+    }
+    else
+    {
+        const size_t count = sqlite3UuidPackSort(builder->keys, static_cast<size_t>(builder->count));
+        unsigned char * pack = reinterpret_cast<unsigned char *>(sqlite3_malloc64(16 * count));
+        if( pack == nullptr )
+        {
+            sqlite3_result_error_nomem(context);
+        }
+        else
+        {
+            sqlite3UuidPackWrite(builder->keys, count, pack);
+            sqlite3_result_blob64(context, pack, 16 * count, sqlite3_free);
+        }
+    }
+
+    if( builder != nullptr )
+    {
+        sqlite3_free(builder->keys);
+        builder->keys = nullptr;
+    }
+}
+
+/* 
+* Implementation of the uuid_pack_contains() function we are adding to sqlite
+*
+* The first input value must be a pack from uuid_pack(), and the second a UUID in any form uuid_blob() accepts. Either
+* being NULL gives NULL. The output is 1 if the UUID is in the pack, and 0 otherwise, found by a binary search.
+*/
+template<int encoding>
+static void sqlite3UuidPackContainsFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    if( sqlite3_value_type(argv[0]) == SQLITE_NULL || sqlite3_value_type(argv[1]) == SQLITE_NULL )
+    {
+        return;
+    }
+
+    if( sqlite3_value_type(argv[0]) != SQLITE_BLOB || sqlite3_value_bytes(argv[0]) % 16 != 0 )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED_PACK, -1);
+        return;
+    }
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[1], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    // An empty pack has no pointer, but it is not read either
+    const unsigned char * pack = reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0]));
+    const size_t count = static_cast<size_t>(sqlite3_value_bytes(argv[0]) / 16);
+    sqlite3_result_int(context, sqlite3UuidPackContains(pack, count, bytes) ? 1 : 0);
+}
+
+/* 
+* Implementation of the ulid() sql function we are adding to sqlite
+* The output is a ULID: a 48-bit timestamp in milliseconds and 80 random bits, written as 26 upper case characters of
+* Crockford base32. It is 10 characters shorter than the text of a UUID, and sorts in generation order as text.
+*
+* Within a millisecond the random part is incremented rather than drawn again, so values generated on the same connection
+* are strictly increasing and consecutive rows land next to each other in an index, as with uuid7().
+*/
+template<int encoding>
+static void sqlite3UlidFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char bytes[16];
+    (void)argc;
+    (void)argv;
+
+    unsigned char text[26];
+    sqlite3UlidGenerate(reinterpret_cast<UlidState *>(sqlite3_user_data(context)), bytes, 1);
+    sqlite3UlidBlobToStr(bytes, text);
+
+    sqlite3ResultAscii(context, encoding, text, 26);
+}
+
+/* 
+* Implementation of the ulid_blob() sql function we are adding to sqlite
+* Same as ulid(), but the output is the 16-byte blob, which sorts in generation order with memcmp.
+*/
+static void sqlite3UlidBlobFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char bytes[16];
+    (void)argc;
+    (void)argv;
+
+    sqlite3UlidGenerate(reinterpret_cast<UlidState *>(sqlite3_user_data(context)), bytes, 1);
+
+    sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
+}
+
+/* 
+* Implementation of the ulid_to_uuid() function we are adding to sqlite
+*
+* The input value can be a 26 character ULID, in either case and with the Crockford aliases I, L and O, or a 16-byte blob.
+* The output is the UUID string with the same 128 bits, in the format uuid_str() produces. ULIDs carry no version or variant,
+* so neither is set.
+*/
+template<int encoding>
+static void sqlite3UlidToUuidFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const unsigned char * bytes = sqlite3UlidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED_ULID, -1);
+        return;
+    }
+
+    sqlite3UuidResultText(context, encoding, bytes);
+}
+
+/* 
+* Implementation of the uuid_to_ulid() function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts.
+* The output is the 26 character ULID with the same 128 bits. Converting a version 7 UUID keeps its order, since both start
+* with a 48-bit timestamp in milliseconds.
+*/
+template<int encoding>
+static void sqlite3UuidToUlidFunc(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    unsigned char text[26];
+    sqlite3UlidBlobToStr(bytes, text);
+    sqlite3ResultAscii(context, encoding, text, 26);
+}
+
+/* 
+* Implementation of the uuid_b64() function we are adding to sqlite
+*
+* The input value can be a string or a BLOB, in any form uuid_blob() accepts.
+* The output is the 16 bytes as 22 characters of base64url without padding, safe in URLs and JSON without escaping.
+* It is 14 characters shorter than uuid_str(), but does not sort in the same order: declare the column COLLATE UUID to
+* index it by value.
+*/
+template<int encoding>
+static void sqlite3UuidB64Func(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char scratch[16];
+    (void)argc;
+
+    const unsigned char * bytes = sqlite3UuidInputToBlob(argv[0], encoding, scratch);
+    if( bytes == nullptr )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    unsigned char text[22];
+    sqlite3UuidBlobToB64(bytes, text);
+    sqlite3ResultAscii(context, encoding, text, 22);
+}
+
+/* 
+* Implementation of the uuid_from_b64() function we are adding to sqlite
+*
+* The input value must be the 22 characters of base64url uuid_b64() produces. Unlike uuid_str(), no other form is accepted,
+* so it doubles as a check that a value is in the compact form.
+* The output is the well-formed UUID string, in the format uuid_str() produces.
+*/
+template<int encoding>
+static void sqlite3UuidFromB64Func(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+    unsigned char buffer[22];
+    unsigned char bytes[16];
+    size_t length = 0;
+    (void)argc;
+
+    const unsigned char * text = sqlite3AsciiArgument(argv[0], encoding, buffer, sizeof(buffer), length);
+    if( text == nullptr || sqlite3UuidB64ToBlob(text, length, bytes) != 0 )
+    {
+        sqlite3_result_error(context, ERR_MSG_MALFORMED, -1);
+        return;
+    }
+
+    sqlite3UuidResultText(context, encoding, bytes);
+}
+
+/*
+* Implementation of the UUID collation we are adding to sqlite
+*
+* Text in any of the forms uuid_str() and uuid_blob() accept is compared by the 16-byte value it describes, which orders the
+* same way memcmp() orders the blobs. So "{A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11}" equals "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11",
+* and a column or index declared COLLATE UUID finds either from the other without calling a function on every row.
+*
+* Collations cannot fail, so text that is not a UUID sorts after every UUID, and byte by byte among itself.
+* Canonical 36 character text takes the vectorized parser, so the common case costs two parses and a memcmp.
+*/
+template<int encoding>
+static int sqlite3UuidCollate(void * userData, int leftLength, const void * left, int rightLength, const void * right)
+{
+    unsigned char leftBytes[16];
+    unsigned char rightBytes[16];
+    (void)userData;
+
+    int leftResult;
+    int rightResult;
+    if( encoding == SQLITE_UTF8 )
+    {
+        leftResult = sqlite3UuidStrToBlob(reinterpret_cast<const unsigned char *>(left), static_cast<size_t>(leftLength), leftBytes);
+        rightResult = sqlite3UuidStrToBlob(reinterpret_cast<const unsigned char *>(right), static_cast<size_t>(rightLength), rightBytes);
+    }
+    else
+    {
+        const bool bigEndian = encoding == SQLITE_UTF16BE;
+        leftResult = sqlite3UuidStr16ToBlob(reinterpret_cast<const unsigned char *>(left), static_cast<size_t>(leftLength), bigEndian, leftBytes);
+        rightResult = sqlite3UuidStr16ToBlob(reinterpret_cast<const unsigned char *>(right), static_cast<size_t>(rightLength), bigEndian, rightBytes);
+    }
+
+    if( leftResult == 0 && rightResult == 0 )
+    {
+        return memcmp(leftBytes, rightBytes, 16);
+    }
+
+    if( leftResult == 0 || rightResult == 0 )
+    {
+        return leftResult == 0 ? -1 : 1;
+    }
+
+    const int compared = memcmp(left, right, static_cast<size_t>(leftLength < rightLength ? leftLength : rightLength));
+    return compared != 0 ? compared : leftLength - rightLength;
+}
+
+/*
+* Every function taking or returning text, and the collation, is registered once for each of sqlite's text encodings, and sqlite calls the one
+* matching the database. Text then goes straight between the database and the UTF-16 kernels, rather than sqlite converting
+* it to UTF-8 for the argument and back again for the result on every call.
+*/
+typedef void (*UuidSqlFunction)(sqlite3_context *, int, sqlite3_value **);
+
+struct UuidTextFunctions
+{
+    int encoding;
+    UuidSqlFunction uuid;
+    UuidSqlFunction uuid7;
+    UuidSqlFunction uuid7Timestamp;
+    UuidSqlFunction uuid5;
+    UuidSqlFunction uuid3;
+    UuidSqlFunction uuidStr;
+    UuidSqlFunction uuidBlob;
+    UuidSqlFunction uuidVersion;
+    UuidSqlFunction uuidVariant;
+    UuidSqlFunction uuidIsValid;
+    UuidSqlFunction uuidHash64;
+    UuidSqlFunction uuidShard;
+    UuidSqlFunction ulid;
+    UuidSqlFunction ulidToUuid;
+    UuidSqlFunction uuidToUlid;
+    UuidSqlFunction uuidB64;
+    UuidSqlFunction uuidFromB64;
+    UuidSqlFunction uuidHllStep;
+    UuidSqlFunction uuidBloomStep;
+    UuidSqlFunction uuidBloomContains;
+    UuidSqlFunction uuidPackStep;
+    UuidSqlFunction uuidPackContains;
+    int (*collate)(void *, int, const void *, int, const void *);
+};
+
+static const UuidTextFunctions TEXT_FUNCTIONS[] = {
+    {SQLITE_UTF8, sqlite3UuidFunc<SQLITE_UTF8>, sqlite3Uuid7Func<SQLITE_UTF8>, sqlite3Uuid7TimestampFunc<SQLITE_UTF8>, sqlite3UuidNameFunc<SQLITE_UTF8, 5>, sqlite3UuidNameFunc<SQLITE_UTF8, 3>,
+        sqlite3UuidStrFunc<SQLITE_UTF8>, sqlite3UuidBlobFunc<SQLITE_UTF8>,
+        sqlite3UuidVersionFunc<SQLITE_UTF8>, sqlite3UuidVariantFunc<SQLITE_UTF8>, sqlite3UuidIsValidFunc<SQLITE_UTF8>,
+        sqlite3UuidHash64Func<SQLITE_UTF8>, sqlite3UuidShardFunc<SQLITE_UTF8>,
+        sqlite3UlidFunc<SQLITE_UTF8>, sqlite3UlidToUuidFunc<SQLITE_UTF8>, sqlite3UuidToUlidFunc<SQLITE_UTF8>,
+        sqlite3UuidB64Func<SQLITE_UTF8>, sqlite3UuidFromB64Func<SQLITE_UTF8>,
+        sqlite3UuidHllStep<SQLITE_UTF8>, sqlite3UuidBloomStep<SQLITE_UTF8>, sqlite3UuidBloomContainsFunc<SQLITE_UTF8>,
+        sqlite3UuidPackStep<SQLITE_UTF8>, sqlite3UuidPackContainsFunc<SQLITE_UTF8>, sqlite3UuidCollate<SQLITE_UTF8>},
+    {SQLITE_UTF16LE, sqlite3UuidFunc<SQLITE_UTF16LE>, sqlite3Uuid7Func<SQLITE_UTF16LE>, sqlite3Uuid7TimestampFunc<SQLITE_UTF16LE>, sqlite3UuidNameFunc<SQLITE_UTF16LE, 5>, sqlite3UuidNameFunc<SQLITE_UTF16LE, 3>,
+        sqlite3UuidStrFunc<SQLITE_UTF16LE>, sqlite3UuidBlobFunc<SQLITE_UTF16LE>,
+        sqlite3UuidVersionFunc<SQLITE_UTF16LE>, sqlite3UuidVariantFunc<SQLITE_UTF16LE>, sqlite3UuidIsValidFunc<SQLITE_UTF16LE>,
+        sqlite3UuidHash64Func<SQLITE_UTF16LE>, sqlite3UuidShardFunc<SQLITE_UTF16LE>,
+        sqlite3UlidFunc<SQLITE_UTF16LE>, sqlite3UlidToUuidFunc<SQLITE_UTF16LE>, sqlite3UuidToUlidFunc<SQLITE_UTF16LE>,
+        sqlite3UuidB64Func<SQLITE_UTF16LE>, sqlite3UuidFromB64Func<SQLITE_UTF16LE>,
+        sqlite3UuidHllStep<SQLITE_UTF16LE>, sqlite3UuidBloomStep<SQLITE_UTF16LE>, sqlite3UuidBloomContainsFunc<SQLITE_UTF16LE>,
+        sqlite3UuidPackStep<SQLITE_UTF16LE>, sqlite3UuidPackContainsFunc<SQLITE_UTF16LE>, sqlite3UuidCollate<SQLITE_UTF16LE>},
+    {SQLITE_UTF16BE, sqlite3UuidFunc<SQLITE_UTF16BE>, sqlite3Uuid7Func<SQLITE_UTF16BE>, sqlite3Uuid7TimestampFunc<SQLITE_UTF16BE>, sqlite3UuidNameFunc<SQLITE_UTF16BE, 5>, sqlite3UuidNameFunc<SQLITE_UTF16BE, 3>,
+        sqlite3UuidStrFunc<SQLITE_UTF16BE>, sqlite3UuidBlobFunc<SQLITE_UTF16BE>,
+        sqlite3UuidVersionFunc<SQLITE_UTF16BE>, sqlite3UuidVariantFunc<SQLITE_UTF16BE>, sqlite3UuidIsValidFunc<SQLITE_UTF16BE>,
+        sqlite3UuidHash64Func<SQLITE_UTF16BE>, sqlite3UuidShardFunc<SQLITE_UTF16BE>,
+        sqlite3UlidFunc<SQLITE_UTF16BE>, sqlite3UlidToUuidFunc<SQLITE_UTF16BE>, sqlite3UuidToUlidFunc<SQLITE_UTF16BE>,
+        sqlite3UuidB64Func<SQLITE_UTF16BE>, sqlite3UuidFromB64Func<SQLITE_UTF16BE>,
+        sqlite3UuidHllStep<SQLITE_UTF16BE>, sqlite3UuidBloomStep<SQLITE_UTF16BE>, sqlite3UuidBloomContainsFunc<SQLITE_UTF16BE>,
+        sqlite3UuidPackStep<SQLITE_UTF16BE>, sqlite3UuidPackContainsFunc<SQLITE_UTF16BE>, sqlite3UuidCollate<SQLITE_UTF16BE>}
+};
+
+
+/*
+* Call this to register the extension with sqlite before using it
+*/
+#ifdef _WIN32
+__declspec(dllexport)
+#endif
+int sqlite3_uuid_init(sqlite3 * db, char ** pzErrMsg, const sqlite3_api_routines * pApi)
+{
+    int returnCode = SQLITE_OK;
+    SQLITE_EXTENSION_INIT2(pApi);
+    (void)pzErrMsg;
+
+    for(const UuidTextFunctions & functions : TEXT_FUNCTIONS)
+    {
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid", 0, functions.encoding|SQLITE_INNOCUOUS, 0, functions.uuid, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid7_timestamp", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuid7Timestamp, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid5", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuid5, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid3", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuid3, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_str", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidStr, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_blob", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidBlob, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_version", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidVersion, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_variant", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidVariant, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_is_valid", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidIsValid, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_hash64", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidHash64, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_shard", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidShard, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "ulid_to_uuid", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.ulidToUuid, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_to_ulid", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidToUlid, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_b64", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidB64, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_from_b64", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidFromB64, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_approx_distinct", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, 0, functions.uuidHllStep, sqlite3UuidApproxDistinctFinal);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_hll", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, 0, functions.uuidHllStep, sqlite3UuidHllFinal);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_bloom", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, 0, functions.uuidBloomStep, sqlite3UuidBloomFinal);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_bloom_contains", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidBloomContains, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_pack", 1, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, 0, functions.uuidPackStep, sqlite3UuidPackFinal);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_function(db, "uuid_pack_contains", 2, functions.encoding|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, functions.uuidPackContains, 0, 0);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            returnCode = sqlite3_create_collation(db, "UUID", functions.encoding, 0, functions.collate);
+        }
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        returnCode = sqlite3_create_function(db, "uuid_hll_merge", 1, SQLITE_UTF8|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, 0, sqlite3UuidHllMergeStep, sqlite3UuidHllMergeFinal);
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        returnCode = sqlite3_create_function(db, "uuid_hll_count", 1, SQLITE_UTF8|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, sqlite3UuidHllCountFunc, 0, 0);
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        returnCode = sqlite3UuidEachInit(db);
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        returnCode = sqlite3UuidCarrayInit(db);
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        returnCode = sqlite3_create_function(db, "uuid7_bound", 2, SQLITE_UTF8|SQLITE_INNOCUOUS|SQLITE_DETERMINISTIC, 0, sqlite3Uuid7BoundFunc, 0, 0);
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        // Everything generating version 7 UUIDs on this connection shares one counter: uuid7 in each encoding, uuid7_blob
+        // and uuid_series. Each registration below owns one reference, and sqlite calls the destructor when a registration
+        // fails too, so only the references never handed over are dropped here.
+        const int stateUsers = 5;
+        int handedOver = 0;
+
+        Uuid7State * state = sqlite3Uuid7StateCreate(stateUsers);
+        if( state == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        for(const UuidTextFunctions & functions : TEXT_FUNCTIONS)
+        {
+            if( returnCode == SQLITE_OK )
+            {
+                handedOver++;
+                returnCode = sqlite3_create_function_v2(db, "uuid7", 0, functions.encoding|SQLITE_INNOCUOUS, state, functions.uuid7, 0, 0, sqlite3Uuid7StateRelease);
+            }
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            handedOver++;
+            returnCode = sqlite3_create_function_v2(db, "uuid7_blob", 0, SQLITE_UTF8|SQLITE_INNOCUOUS, state, sqlite3Uuid7BlobFunc, 0, 0, sqlite3Uuid7StateRelease);
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            handedOver++;
+            returnCode = sqlite3UuidSeriesInit(db, state);
+        }
+
+        for( ; handedOver < stateUsers; handedOver++ )
+        {
+            sqlite3Uuid7StateRelease(state);
+        }
+    }
+
+    if( returnCode == SQLITE_OK )
+    {
+        // The ULID generators share their own state the same way: ulid in each encoding and ulid_blob
+        const int stateUsers = 4;
+        int handedOver = 0;
+
+        UlidState * state = sqlite3UlidStateCreate(stateUsers);
+        if( state == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        for(const UuidTextFunctions & functions : TEXT_FUNCTIONS)
+        {
+            if( returnCode == SQLITE_OK )
+            {
+                handedOver++;
+                returnCode = sqlite3_create_function_v2(db, "ulid", 0, functions.encoding|SQLITE_INNOCUOUS, state, functions.ulid, 0, 0, sqlite3UlidStateRelease);
+            }
+        }
+
+        if( returnCode == SQLITE_OK )
+        {
+            handedOver++;
+            returnCode = sqlite3_create_function_v2(db, "ulid_blob", 0, SQLITE_UTF8|SQLITE_INNOCUOUS, state, sqlite3UlidBlobFunc, 0, 0, sqlite3UlidStateRelease);
+        }
+
+        for( ; handedOver < stateUsers; handedOver++ )
+        {
+            sqlite3UlidStateRelease(state);
+        }
     }
 
     return returnCode;
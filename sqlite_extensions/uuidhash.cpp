@@ -0,0 +1,78 @@
+/*
+** Hashing and shard routing of UUIDs, for splitting UUID-keyed data across several databases.
+**
+** sqlite3UuidHash64() follows wyhash (final version 4, by Wang Yi, released into the public domain) for a 16-byte input
+** with seed 0 and the default secret. Bytes are read little-endian whatever the platform, so the hash of a UUID is the
+** same everywhere.
+*/
+
+#include "sqlite_extensions/uuidhash.hpp"
+
+namespace
+{
+    const uint64_t WYHASH_SECRET[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+    inline uint64_t readLittleEndian32(const unsigned char * bytes)
+    {
+        return uint64_t(bytes[0]) | (uint64_t(bytes[1]) << 8) | (uint64_t(bytes[2]) << 16) | (uint64_t(bytes[3]) << 24);
+    }
+
+    /*
+    * The 128-bit product of a and b, low half in a and high half in b
+    */
+    inline void multiply(uint64_t & a, uint64_t & b)
+    {
+#ifdef __SIZEOF_INT128__
+        const __uint128_t product = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(product);
+        b = static_cast<uint64_t>(product >> 64);
+#else
+        const uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+        const uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+        const uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        const uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+        a = (middle << 32) | static_cast<uint32_t>(lowLow);
+        b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+    }
+
+    inline uint64_t mix(uint64_t a, uint64_t b)
+    {
+        multiply(a, b);
+        return a ^ b;
+    }
+}
+
+uint64_t sqlite3UuidHash64(const unsigned char * bytes)
+{
+    const uint64_t length = 16;
+    uint64_t seed = mix(WYHASH_SECRET[0], WYHASH_SECRET[1]);
+
+    uint64_t a = (readLittleEndian32(bytes) << 32) | readLittleEndian32(bytes + 8);
+    uint64_t b = (readLittleEndian32(bytes + 12) << 32) | readLittleEndian32(bytes + 4);
+
+    a ^= WYHASH_SECRET[1];
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ WYHASH_SECRET[0] ^ length, b ^ WYHASH_SECRET[1]);
+}
+
+int32_t sqlite3UuidJumpHash(uint64_t key, int32_t buckets)
+{
+    int64_t bucket = -1;
+    int64_t jump = 0;
+
+    while( jump < buckets )
+    {
+        bucket = jump;
+        key = key * 2862933555777941757ull + 1;
+        jump = static_cast<int64_t>((bucket + 1) * (double(int64_t(1) << 31) / double((key >> 33) + 1)));
+    }
+
+    return static_cast<int32_t>(bucket);
+}
+
+int32_t sqlite3UuidShard(const unsigned char * bytes, int32_t shards)
+{
+    return sqlite3UuidJumpHash(sqlite3UuidHash64(bytes), shards);
+}
@@ -0,0 +1,172 @@
+/*
+** HyperLogLog sketches of sets of UUIDs, behind uuid_approx_distinct(), uuid_hll(), uuid_hll_merge() and uuid_hll_count().
+**
+** The layout follows HyperLogLog++ (Heule, Nunkesser and Hall): a 64-bit hash, the top UUID_HLL_PRECISION bits of which
+** pick a register, which keeps the highest rank, one more than the leading zeros, of the remaining bits seen in it.
+** Instead of HyperLogLog++'s empirical bias correction tables, the count is estimated with Ertl's improved raw estimator
+** ("New cardinality estimation algorithms for HyperLogLog sketches", 2017), which is unbiased from zero to beyond 2^64
+** without any tables or switching between estimators.
+*/
+
+#include "sqlite_extensions/uuidhll.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // The ranks of the 64 - UUID_HLL_PRECISION bits below the register index go up to one more than their count
+    const int HLL_RANK_BITS = 64 - UUID_HLL_PRECISION;
+    const unsigned char HLL_MAX_RANK = HLL_RANK_BITS + 1;
+
+    const unsigned char HLL_HEADER[UUID_HLL_HEADER_BYTES] = {'U', 'H', 1, UUID_HLL_PRECISION};
+
+    inline uint64_t readBigEndian64(const unsigned char * bytes)
+    {
+        uint64_t value = 0;
+        for(int byteIndex = 0; byteIndex < 8; byteIndex++)
+        {
+            value = (value << 8) | bytes[byteIndex];
+        }
+        return value;
+    }
+
+    inline int leadingZeros(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        for( ; (value & 0x8000000000000000ull) == 0; value <<= 1)
+        {
+            zeros++;
+        }
+        return zeros;
+#endif
+    }
+
+    /*
+    * sigma(x) of Ertl's estimator, for the registers still at zero
+    */
+    double sigma(double x)
+    {
+        if( x == 1.0 )
+        {
+            return INFINITY;
+        }
+
+        double y = 1.0;
+        double z = x;
+        double previous;
+        do
+        {
+            x *= x;
+            previous = z;
+            z += x * y;
+            y += y;
+        } while( z != previous );
+
+        return z;
+    }
+
+    /*
+    * tau(x) of Ertl's estimator, for the registers at the highest rank
+    */
+    double tau(double x)
+    {
+        if( x == 0.0 || x == 1.0 )
+        {
+            return 0.0;
+        }
+
+        double y = 1.0;
+        double z = 1.0 - x;
+        double previous;
+        do
+        {
+            x = std::sqrt(x);
+            previous = z;
+            y *= 0.5;
+            z -= (1.0 - x) * (1.0 - x) * y;
+        } while( z != previous );
+
+        return z / 3.0;
+    }
+}
+
+uint64_t sqlite3UuidHllHash(const unsigned char * bytes)
+{
+    const int version = bytes[6] >> 4;
+    if( (bytes[8] & 0xc0) != 0x80 || (version != 3 && version != 4 && version != 5) )
+    {
+        return sqlite3UuidHash64(bytes);
+    }
+
+    // The register from the first 14 bits and the rank from the last 50, steering clear of the version and variant bits
+    const uint64_t indexMask = ~uint64_t(0) << HLL_RANK_BITS;
+    return (readBigEndian64(bytes) & indexMask) | (readBigEndian64(bytes + 8) & ~indexMask);
+}
+
+void sqlite3UuidHllInit(unsigned char * sketch)
+{
+    memcpy(sketch, HLL_HEADER, UUID_HLL_HEADER_BYTES);
+    memset(sketch + UUID_HLL_HEADER_BYTES, 0, UUID_HLL_REGISTERS);
+}
+
+bool sqlite3UuidHllIsValid(const unsigned char * sketch, size_t size)
+{
+    if( size != UUID_HLL_SKETCH_BYTES || memcmp(sketch, HLL_HEADER, UUID_HLL_HEADER_BYTES) != 0 )
+    {
+        return false;
+    }
+
+    unsigned char highest = 0;
+    for(size_t registerIndex = 0; registerIndex < UUID_HLL_REGISTERS; registerIndex++)
+    {
+        highest = sketch[UUID_HLL_HEADER_BYTES + registerIndex] > highest ? sketch[UUID_HLL_HEADER_BYTES + registerIndex] : highest;
+    }
+    return highest <= HLL_MAX_RANK;
+}
+
+void sqlite3UuidHllAdd(unsigned char * registers, const unsigned char * bytes)
+{
+    const uint64_t hash = sqlite3UuidHllHash(bytes);
+    const size_t registerIndex = static_cast<size_t>(hash >> HLL_RANK_BITS);
+    const uint64_t rest = hash << UUID_HLL_PRECISION;
+    const unsigned char rank = rest == 0 ? HLL_MAX_RANK : static_cast<unsigned char>(leadingZeros(rest) + 1);
+
+    if( rank > registers[registerIndex] )
+    {
+        registers[registerIndex] = rank;
+    }
+}
+
+void sqlite3UuidHllMerge(unsigned char * registers, const unsigned char * otherRegisters)
+{
+    // Written to be vectorized, into one byte-wise maximum instruction per vector of registers
+    for(size_t registerIndex = 0; registerIndex < UUID_HLL_REGISTERS; registerIndex++)
+    {
+        registers[registerIndex] = otherRegisters[registerIndex] > registers[registerIndex] ? otherRegisters[registerIndex] : registers[registerIndex];
+    }
+}
+
+double sqlite3UuidHllEstimate(const unsigned char * registers)
+{
+    uint32_t counts[HLL_MAX_RANK + 1] = {};
+    for(size_t registerIndex = 0; registerIndex < UUID_HLL_REGISTERS; registerIndex++)
+    {
+        counts[registers[registerIndex]]++;
+    }
+
+    const double m = static_cast<double>(UUID_HLL_REGISTERS);
+    double z = m * tau(1.0 - counts[HLL_MAX_RANK] / m);
+    for(int rank = HLL_RANK_BITS; rank >= 1; rank--)
+    {
+        z = 0.5 * (z + counts[rank]);
+    }
+    z += m * sigma(counts[0] / m);
+
+    // alpha for an unbounded number of registers, 1 / (2 ln 2)
+    return 0.5 / std::log(2.0) * m * m / z;
+}
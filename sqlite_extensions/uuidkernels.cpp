@@ -0,0 +1,984 @@
+/*
+** Kernels shared by the UUID extension's SQL functions and table-valued functions: generation, formatting and parsing.
+** Formatting has SSE2, SSSE3 and AVX2 versions, and parsing of the canonical form SSE2 and SSSE3 versions, selected at runtime
+** for the cpu, with the scalar routines as their reference. The compact base64url form has SSSE3 versions both ways.
+**
+** The formatting and parsing routines were based upon https://sqlite.org/src/file/ext/misc/uuid.c, whose author disclaims
+** copyright to the source code.
+*/
+
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "sqlite_extensions/uuidrandom.hpp"
+
+#include "sqlite3ext.h"
+SQLITE_EXTENSION_INIT3
+
+#include <chrono>
+#include <cstring>
+
+// The vectorized kernels are compiled for their instruction sets with target attributes and picked at runtime
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+# define UUID_KERNELS_X86 1
+# define UUID_TARGET(isa) __attribute__((target(isa)))
+# include <immintrin.h>
+#endif
+
+/*
+* The counter occupies the 12 bits of rand_a and the top 30 bits of rand_b (RFC 9562 section 6.2, method 1).
+* It is seeded with a random value whose top bit is clear at the start of every millisecond, which leaves at least
+* 2^41 increments of headroom before it would overflow into the timestamp.
+*/
+static const int UUID7_COUNTER_BITS = 42;
+static const uint64_t UUID7_COUNTER_SEED_MASK = (uint64_t(1) << (UUID7_COUNTER_BITS - 1)) - 1;
+
+Uuid7State * sqlite3Uuid7StateCreate(int refCount)
+{
+    Uuid7State * state = reinterpret_cast<Uuid7State *>(sqlite3_malloc(sizeof(Uuid7State)));
+    if( state != nullptr )
+    {
+        state->lastMilliseconds = 0;
+        state->counter = 0;
+        state->refCount = refCount;
+    }
+
+    return state;
+}
+
+void sqlite3Uuid7StateRelease(void * pointer)
+{
+    Uuid7State * state = reinterpret_cast<Uuid7State *>(pointer);
+
+    if( --state->refCount == 0 )
+    {
+        sqlite3_free(state);
+    }
+}
+
+void sqlite3UuidV4Generate(unsigned char * bytes, size_t count)
+{
+    sqlite3UuidRandomness(16 * count, bytes);
+
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++, bytes += 16)
+    {
+        bytes[6] = (bytes[6]&0x0f) + 0x40; // set the first nibble of the 6th byte to 4 for the version of uuid
+        bytes[8] = (bytes[8]&0x3f) + 0x80; // set the first two bits of the 8th byte to 2 for the variant
+    }
+}
+
+/*
+* Version 7 UUIDs are laid out per RFC 9562:
+*
+*    48 bits unix timestamp in milliseconds | 4 bits version | 42 bits counter | 2 bits variant | 32 bits random
+*
+* (the variant bits sit in the middle of the counter, at the top of the 9th byte).
+* If the clock has not advanced, or has gone backwards, the previous timestamp is reused and the counter incremented,
+* so the output of a single state is always strictly increasing. Should the counter ever overflow, the timestamp
+* is advanced by a millisecond, borrowing from the future as the RFC allows.
+*/
+void sqlite3UuidV7Generate(Uuid7State * state, unsigned char * bytes, size_t count)
+{
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    sqlite3UuidRandomness(16 * count, bytes);
+
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++, bytes += 16)
+    {
+        if( now > state->lastMilliseconds )
+        {
+            uint64_t seed = 0;
+            for(int byteIndex = 6; byteIndex < 12; byteIndex++)
+            {
+                seed = (seed << 8) | bytes[byteIndex];
+            }
+
+            state->lastMilliseconds = now;
+            state->counter = seed & UUID7_COUNTER_SEED_MASK;
+        }
+        else
+        {
+            state->counter++;
+
+            if( state->counter >> UUID7_COUNTER_BITS )
+            {
+                state->lastMilliseconds++;
+                state->counter = 0;
+            }
+        }
+
+        const uint64_t milliseconds = static_cast<uint64_t>(state->lastMilliseconds);
+        const uint64_t counter = state->counter;
+
+        bytes[0] = static_cast<unsigned char>(milliseconds >> 40);
+        bytes[1] = static_cast<unsigned char>(milliseconds >> 32);
+        bytes[2] = static_cast<unsigned char>(milliseconds >> 24);
+        bytes[3] = static_cast<unsigned char>(milliseconds >> 16);
+        bytes[4] = static_cast<unsigned char>(milliseconds >> 8);
+        bytes[5] = static_cast<unsigned char>(milliseconds);
+        bytes[6] = static_cast<unsigned char>(0x70 | ((counter >> 38) & 0x0f)); // version 7 in the first nibble
+        bytes[7] = static_cast<unsigned char>(counter >> 30);
+        bytes[8] = static_cast<unsigned char>(0x80 | ((counter >> 24) & 0x3f)); // variant 1 in the first two bits
+        bytes[9] = static_cast<unsigned char>(counter >> 16);
+        bytes[10] = static_cast<unsigned char>(counter >> 8);
+        bytes[11] = static_cast<unsigned char>(counter);
+        // bytes 12 through 15 keep their random values
+    }
+}
+
+/*
+* Versions 1 and 6 count 100 nanosecond intervals from the start of the Gregorian calendar, 1582-10-15, in 60 bits: version 1
+* with the low 32 bits first, then the middle 16 and the top 12, and version 6 from the top down. Version 7 starts with the
+* unix time in milliseconds.
+*/
+static const int64_t GREGORIAN_TO_UNIX_INTERVALS = 0x01b21dd213814000ll;
+
+bool sqlite3UuidTimestamp(const unsigned char * bytes, int64_t & milliseconds)
+{
+    if( (bytes[8] & 0xc0) != 0x80 )
+    {
+        return false;
+    }
+
+    uint64_t high = 0;
+    for(int byteIndex = 0; byteIndex < 6; byteIndex++)
+    {
+        high = (high << 8) | bytes[byteIndex];
+    }
+    const uint64_t timeHigh = (uint64_t(bytes[6] & 0x0f) << 8) | bytes[7];
+
+    int64_t intervals;
+    switch( bytes[6] >> 4 )
+    {
+        case 7:
+            milliseconds = static_cast<int64_t>(high);
+            return true;
+        case 6:
+            intervals = static_cast<int64_t>((high << 12) | timeHigh);
+            break;
+        case 1:
+            intervals = static_cast<int64_t>((timeHigh << 48) | ((high & 0xffff) << 32) | (high >> 16));
+            break;
+        default:
+            return false;
+    }
+
+    // Rounded down, so times before 1970 land in the millisecond they started in
+    const int64_t sinceUnixEpoch = intervals - GREGORIAN_TO_UNIX_INTERVALS;
+    milliseconds = sinceUnixEpoch / 10000 - (sinceUnixEpoch % 10000 < 0 ? 1 : 0);
+    return true;
+}
+
+/*
+* The lower bound has every bit after the timestamp clear and the upper bound every bit set, other than the version and variant
+*/
+void sqlite3UuidV7Bound(int64_t milliseconds, bool upper, unsigned char * bytes)
+{
+    const uint64_t timestamp = static_cast<uint64_t>(milliseconds);
+    for(int byteIndex = 0; byteIndex < 6; byteIndex++)
+    {
+        bytes[byteIndex] = static_cast<unsigned char>(timestamp >> (40 - 8 * byteIndex));
+    }
+
+    memset(bytes + 6, upper ? 0xff : 0x00, 10);
+    bytes[6] = static_cast<unsigned char>((bytes[6] & 0x0f) | 0x70);
+    bytes[8] = static_cast<unsigned char>((bytes[8] & 0x3f) | 0x80);
+}
+
+/*
+* Converts a 16-byte BLOB into a well-formed RFC-4122 UUID with 8-4-4-4-12 hexidecimal digits, each representing 4 bits.
+* The output buffer should be at least 37 bytes in length and will be zero terminted.
+* This is the reference the vectorized kernels below are tested against.
+*/
+void sqlite3UuidBlobToStrScalar(const unsigned char * bytes, unsigned char * result)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for(int byteIndex = 0, pattern = 0x550; byteIndex < 16; byteIndex++, pattern = pattern>>1)
+    {
+        if( pattern & 1 )
+        {
+            result[0] = '-';
+            result++;
+        }
+
+        unsigned byteValue = bytes[byteIndex];
+        result[0] = digits[byteValue>>4];
+        result[1] = digits[byteValue & 0xf];
+        result += 2;
+    }
+
+    *result = 0;
+}
+
+static void sqlite3UuidBlobsToStrsScalar(const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    unsigned char text[37];
+
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+    {
+        sqlite3UuidBlobToStrScalar(bytes + 16 * uuidIndex, text);
+        memcpy(result + 36 * uuidIndex, text, 36);
+    }
+}
+
+#ifdef UUID_KERNELS_X86
+/*
+* Vectorized formatting.
+*
+* Every kernel splits the 16 input bytes into high and low nibbles and interleaves them, giving the 32 hex digits as two
+* 16-byte vectors: digits 0-15 and digits 16-31. The dashes then go in at output positions 8, 13, 18 and 23:
+*
+*    output  0-15:  digits 0-7   '-'  digits 8-11   '-'  digits 12-13
+*    output 16-31:  digits 14-15 '-'  digits 16-19  '-'  digits 20-27
+*    output 32-35:  digits 28-31
+*/
+
+/*
+* SSE2 only has arithmetic, so nibbles become digits by adding '0', plus the gap up to 'a' where they are above 9,
+* and the dashes are placed with fixed size copies.
+*/
+UUID_TARGET("sse2") static inline __m128i sqlite3UuidNibblesToHexSse2(__m128i nibbles)
+{
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(nibbles, _mm_add_epi8(letters, _mm_set1_epi8('0')));
+}
+
+UUID_TARGET("sse2") static void sqlite3UuidBlobsToStrsSse2(const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    const __m128i lowNibbles = _mm_set1_epi8(0x0f);
+    unsigned char digits[32];
+
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++, bytes += 16, result += 36)
+    {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+        const __m128i high = _mm_and_si128(_mm_srli_epi16(input, 4), lowNibbles);
+        const __m128i low = _mm_and_si128(input, lowNibbles);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(digits), sqlite3UuidNibblesToHexSse2(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(digits + 16), sqlite3UuidNibblesToHexSse2(_mm_unpackhi_epi8(high, low)));
+
+        memcpy(result, digits, 8);
+        result[8] = '-';
+        memcpy(result + 9, digits + 8, 4);
+        result[13] = '-';
+        memcpy(result + 14, digits + 12, 4);
+        result[18] = '-';
+        memcpy(result + 19, digits + 16, 4);
+        result[23] = '-';
+        memcpy(result + 24, digits + 20, 12);
+    }
+}
+
+/*
+* SSSE3 and AVX2 look the digits up with a byte shuffle, then shuffle them into place around the dashes.
+* An index with the top bit set makes the shuffle write a zero, which leaves room to OR in the dashes or the other half.
+*/
+#define UUID_Z -128
+#define UUID_FORMAT_SHUFFLES \
+    const __m128i formatDigits = _mm_setr_epi8('0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'); \
+    const __m128i formatFirstFromLow = _mm_setr_epi8(0,1,2,3,4,5,6,7,UUID_Z,8,9,10,11,UUID_Z,12,13); \
+    const __m128i formatSecondFromLow = _mm_setr_epi8(14,15,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z); \
+    const __m128i formatSecondFromHigh = _mm_setr_epi8(UUID_Z,UUID_Z,UUID_Z,0,1,2,3,UUID_Z,4,5,6,7,8,9,10,11); \
+    const __m128i formatFirstDashes = _mm_setr_epi8(0,0,0,0,0,0,0,0,'-',0,0,0,0,'-',0,0); \
+    const __m128i formatSecondDashes = _mm_setr_epi8(0,0,'-',0,0,0,0,'-',0,0,0,0,0,0,0,0)
+
+UUID_TARGET("ssse3") static void sqlite3UuidBlobsToStrsSsse3(const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    UUID_FORMAT_SHUFFLES;
+    const __m128i lowNibbles = _mm_set1_epi8(0x0f);
+
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++, bytes += 16, result += 36)
+    {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+        const __m128i high = _mm_shuffle_epi8(formatDigits, _mm_and_si128(_mm_srli_epi16(input, 4), lowNibbles));
+        const __m128i low = _mm_shuffle_epi8(formatDigits, _mm_and_si128(input, lowNibbles));
+        const __m128i digitsLow = _mm_unpacklo_epi8(high, low);
+        const __m128i digitsHigh = _mm_unpackhi_epi8(high, low);
+
+        const __m128i first = _mm_or_si128(_mm_shuffle_epi8(digitsLow, formatFirstFromLow), formatFirstDashes);
+        const __m128i second = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(digitsLow, formatSecondFromLow),
+                                                         _mm_shuffle_epi8(digitsHigh, formatSecondFromHigh)), formatSecondDashes);
+        const int last = _mm_cvtsi128_si32(_mm_srli_si128(digitsHigh, 12));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result), first);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 16), second);
+        memcpy(result + 32, &last, 4);
+    }
+}
+
+/*
+* AVX2 shuffles within each 128-bit lane, so the SSSE3 steps run on two UUIDs at once, one per lane
+*/
+UUID_TARGET("avx2") static void sqlite3UuidBlobsToStrsAvx2(const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    UUID_FORMAT_SHUFFLES;
+    const __m256i digits = _mm256_broadcastsi128_si256(formatDigits);
+    const __m256i firstFromLow = _mm256_broadcastsi128_si256(formatFirstFromLow);
+    const __m256i secondFromLow = _mm256_broadcastsi128_si256(formatSecondFromLow);
+    const __m256i secondFromHigh = _mm256_broadcastsi128_si256(formatSecondFromHigh);
+    const __m256i firstDashes = _mm256_broadcastsi128_si256(formatFirstDashes);
+    const __m256i secondDashes = _mm256_broadcastsi128_si256(formatSecondDashes);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+
+    size_t uuidIndex = 0;
+    for( ; uuidIndex + 2 <= count; uuidIndex += 2, bytes += 32, result += 72)
+    {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes));
+        const __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibbles));
+        const __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(input, lowNibbles));
+        const __m256i digitsLow = _mm256_unpacklo_epi8(high, low);
+        const __m256i digitsHigh = _mm256_unpackhi_epi8(high, low);
+
+        const __m256i first = _mm256_or_si256(_mm256_shuffle_epi8(digitsLow, firstFromLow), firstDashes);
+        const __m256i second = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(digitsLow, secondFromLow),
+                                                               _mm256_shuffle_epi8(digitsHigh, secondFromHigh)), secondDashes);
+        const __m256i last = _mm256_srli_si256(digitsHigh, 12);
+        const int lastOfFirst = _mm256_extract_epi32(last, 0);
+        const int lastOfSecond = _mm256_extract_epi32(last, 4);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result), _mm256_castsi256_si128(first));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 16), _mm256_castsi256_si128(second));
+        memcpy(result + 32, &lastOfFirst, 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 36), _mm256_extracti128_si256(first, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 52), _mm256_extracti128_si256(second, 1));
+        memcpy(result + 68, &lastOfSecond, 4);
+    }
+
+    sqlite3UuidBlobsToStrsSsse3(bytes, count - uuidIndex, result);
+}
+
+#undef UUID_FORMAT_SHUFFLES
+#undef UUID_Z
+#endif
+
+UuidSimdLevel sqlite3UuidSimdSupported()
+{
+#ifdef UUID_KERNELS_X86
+    static const UuidSimdLevel supported = []()
+    {
+        __builtin_cpu_init();
+        if( __builtin_cpu_supports("avx2") )
+        {
+            return UUID_SIMD_AVX2;
+        }
+        if( __builtin_cpu_supports("ssse3") )
+        {
+            return UUID_SIMD_SSSE3;
+        }
+        return __builtin_cpu_supports("sse2") ? UUID_SIMD_SSE2 : UUID_SIMD_SCALAR;
+    }();
+
+    return supported;
+#else
+    return UUID_SIMD_SCALAR;
+#endif
+}
+
+void sqlite3UuidBlobsToStrsWith(UuidSimdLevel level, const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    switch( level )
+    {
+#ifdef UUID_KERNELS_X86
+        case UUID_SIMD_AVX2:
+            sqlite3UuidBlobsToStrsAvx2(bytes, count, result);
+            break;
+        case UUID_SIMD_SSSE3:
+            sqlite3UuidBlobsToStrsSsse3(bytes, count, result);
+            break;
+        case UUID_SIMD_SSE2:
+            sqlite3UuidBlobsToStrsSse2(bytes, count, result);
+            break;
+#endif
+        default:
+            sqlite3UuidBlobsToStrsScalar(bytes, count, result);
+            break;
+    }
+}
+
+/*
+* A single UUID gains nothing from the second AVX2 lane, so it goes straight to the SSSE3 kernel where there is one
+*/
+void sqlite3UuidBlobToStr(const unsigned char * bytes, unsigned char * result)
+{
+    static const UuidSimdLevel level = sqlite3UuidSimdSupported() < UUID_SIMD_SSSE3 ? sqlite3UuidSimdSupported() : UUID_SIMD_SSSE3;
+
+    sqlite3UuidBlobsToStrsWith(level, bytes, 1, result);
+    result[36] = 0;
+}
+
+void sqlite3UuidBlobsToStrs(const unsigned char * bytes, size_t count, unsigned char * result)
+{
+    sqlite3UuidBlobsToStrsWith(sqlite3UuidSimdSupported(), bytes, count, result);
+}
+
+/*
+* The 22 character form is the 16 bytes in the base64url alphabet of RFC 4648, without padding. The last character carries
+* only 2 of the 128 bits, and its other 4 must be zero, so every UUID has exactly one form.
+*/
+static const char BASE64URL_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/*
+* Value of every byte as a base64url digit, or -1 if it is not one
+*/
+static const signed char BASE64URL_VALUES[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1, 52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1,
+    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14, 15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,63,
+    -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40, 41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+void sqlite3UuidBlobToB64Scalar(const unsigned char * bytes, unsigned char * result)
+{
+    // Five whole groups of 3 bytes to 4 characters, then the last byte to 2
+    for(int group = 0; group < 5; group++, bytes += 3, result += 4)
+    {
+        const uint32_t bits = (uint32_t(bytes[0]) << 16) | (uint32_t(bytes[1]) << 8) | bytes[2];
+        result[0] = static_cast<unsigned char>(BASE64URL_ALPHABET[bits >> 18]);
+        result[1] = static_cast<unsigned char>(BASE64URL_ALPHABET[(bits >> 12) & 63]);
+        result[2] = static_cast<unsigned char>(BASE64URL_ALPHABET[(bits >> 6) & 63]);
+        result[3] = static_cast<unsigned char>(BASE64URL_ALPHABET[bits & 63]);
+    }
+
+    result[0] = static_cast<unsigned char>(BASE64URL_ALPHABET[bytes[0] >> 2]);
+    result[1] = static_cast<unsigned char>(BASE64URL_ALPHABET[(bytes[0] & 3) << 4]);
+}
+
+int sqlite3UuidB64ToBlobScalar(const unsigned char * text, size_t length, unsigned char * out)
+{
+    if( length != 22 )
+    {
+        return 1;
+    }
+
+    int values[22];
+    for(int charIndex = 0; charIndex < 22; charIndex++)
+    {
+        values[charIndex] = BASE64URL_VALUES[text[charIndex]];
+        if( values[charIndex] < 0 )
+        {
+            return 1;
+        }
+    }
+
+    if( values[21] & 15 )
+    {
+        return 1;
+    }
+
+    for(int group = 0; group < 5; group++)
+    {
+        const int * digits = values + 4 * group;
+        const uint32_t bits = (uint32_t(digits[0]) << 18) | (uint32_t(digits[1]) << 12) | (uint32_t(digits[2]) << 6) | uint32_t(digits[3]);
+        out[3 * group] = static_cast<unsigned char>(bits >> 16);
+        out[3 * group + 1] = static_cast<unsigned char>(bits >> 8);
+        out[3 * group + 2] = static_cast<unsigned char>(bits);
+    }
+
+    out[15] = static_cast<unsigned char>((values[20] << 2) | (values[21] >> 4));
+    return 0;
+}
+
+#ifdef UUID_KERNELS_X86
+/*
+* Vectorized base64url, after Wojciech Muła's SSSE3 base64 codecs. A vector of 12 bytes holds 16 characters' worth of bits,
+* so the 22 characters are handled as characters 0-15 from bytes 0-11, and characters 16-21 from bytes 12-15 with zero
+* bytes after them.
+*
+* Encoding shuffles each group of 3 bytes into a 32-bit lane and moves the four 6-bit values into a byte each with one
+* multiply-high and one multiply-low. A value becomes a character by adding the offset for its range of the alphabet, which
+* a shuffle looks up from a small index computed with a saturating subtract and a compare.
+*/
+#define UUID_Z -128
+UUID_TARGET("ssse3") static inline __m128i sqlite3UuidBytesToB64Ssse3(__m128i shuffled)
+{
+    const __m128i high = _mm_mulhi_epu16(_mm_and_si128(shuffled, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    const __m128i low = _mm_mullo_epi16(_mm_and_si128(shuffled, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    const __m128i values = _mm_or_si128(high, low);
+
+    // 13 for 'A'-'Z', 0 for 'a'-'z', 1 to 10 for '0'-'9', 11 for '-' and 12 for '_'
+    __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0);
+    return _mm_add_epi8(values, _mm_shuffle_epi8(offsets, range));
+}
+
+UUID_TARGET("ssse3") static void sqlite3UuidBlobToB64Ssse3(const unsigned char * bytes, unsigned char * result)
+{
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    const __m128i head = _mm_shuffle_epi8(input, _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10));
+    const __m128i tail = _mm_shuffle_epi8(input, _mm_setr_epi8(13,12,14,13, UUID_Z,15,UUID_Z,UUID_Z, UUID_Z,UUID_Z,UUID_Z,UUID_Z, UUID_Z,UUID_Z,UUID_Z,UUID_Z));
+
+    unsigned char tailText[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result), sqlite3UuidBytesToB64Ssse3(head));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(tailText), sqlite3UuidBytesToB64Ssse3(tail));
+    memcpy(result + 16, tailText, 6);
+}
+
+/*
+* Decoding validates and converts 16 characters at a time with range compares, in the same way as the hex parser, then packs
+* four 6-bit values into 3 bytes per 32-bit lane with two multiply-adds and gathers the bytes with a shuffle.
+* Characters 16-21 are read with an overlapping load ending at the last character and shifted down, with 'A', which is
+* zero, shifted in behind them.
+*/
+UUID_TARGET("ssse3") static inline bool sqlite3UuidB64ToBytesSsse3(__m128i text, __m128i & bytes)
+{
+    const __m128i upper = _mm_sub_epi8(text, _mm_set1_epi8('A'));
+    const __m128i lower = _mm_sub_epi8(text, _mm_set1_epi8('a'));
+    const __m128i digits = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    const __m128i isUpper = _mm_cmpeq_epi8(_mm_min_epu8(upper, _mm_set1_epi8(25)), upper);
+    const __m128i isLower = _mm_cmpeq_epi8(_mm_min_epu8(lower, _mm_set1_epi8(25)), lower);
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    const __m128i isDash = _mm_cmpeq_epi8(text, _mm_set1_epi8('-'));
+    const __m128i isUnderscore = _mm_cmpeq_epi8(text, _mm_set1_epi8('_'));
+
+    const __m128i valid = _mm_or_si128(_mm_or_si128(isUpper, isLower), _mm_or_si128(_mm_or_si128(isDigit, isDash), isUnderscore));
+    if( _mm_movemask_epi8(valid) != 0xffff )
+    {
+        return false;
+    }
+
+    __m128i values = _mm_and_si128(isUpper, upper);
+    values = _mm_or_si128(values, _mm_and_si128(isLower, _mm_add_epi8(lower, _mm_set1_epi8(26))));
+    values = _mm_or_si128(values, _mm_and_si128(isDigit, _mm_add_epi8(digits, _mm_set1_epi8(52))));
+    values = _mm_or_si128(values, _mm_and_si128(isDash, _mm_set1_epi8(62)));
+    values = _mm_or_si128(values, _mm_and_si128(isUnderscore, _mm_set1_epi8(63)));
+
+    // Pairs of values into 12 bits, pairs of those into 24, then the 3 low bytes of each lane in big-endian order
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    bytes = _mm_shuffle_epi8(lanes, _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, UUID_Z,UUID_Z,UUID_Z,UUID_Z));
+    return true;
+}
+
+UUID_TARGET("ssse3") static int sqlite3UuidB64ToBlobSsse3(const unsigned char * text, unsigned char * out)
+{
+    const __m128i headText = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+    const __m128i tailText = _mm_or_si128(_mm_srli_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 6)), 10),
+                                          _mm_setr_epi8(0,0,0,0,0,0,'A','A','A','A','A','A','A','A','A','A'));
+
+    __m128i head;
+    __m128i tail;
+    if( !sqlite3UuidB64ToBytesSsse3(headText, head) || !sqlite3UuidB64ToBytesSsse3(tailText, tail) )
+    {
+        return 1;
+    }
+
+    // Byte 4 of the tail holds the 4 bits of the last character past the end of the UUID
+    unsigned char tailBytes[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(tailBytes), tail);
+    if( tailBytes[4] != 0 )
+    {
+        return 1;
+    }
+
+    unsigned char headBytes[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(headBytes), head);
+    memcpy(out, headBytes, 12);
+    memcpy(out + 12, tailBytes, 4);
+    return 0;
+}
+#undef UUID_Z
+#endif
+
+void sqlite3UuidBlobToB64With(UuidSimdLevel level, const unsigned char * bytes, unsigned char * result)
+{
+#ifdef UUID_KERNELS_X86
+    if( level >= UUID_SIMD_SSSE3 )
+    {
+        sqlite3UuidBlobToB64Ssse3(bytes, result);
+        return;
+    }
+#else
+    (void)level;
+#endif
+
+    sqlite3UuidBlobToB64Scalar(bytes, result);
+}
+
+void sqlite3UuidBlobToB64(const unsigned char * bytes, unsigned char * result)
+{
+    sqlite3UuidBlobToB64With(sqlite3UuidSimdSupported(), bytes, result);
+}
+
+int sqlite3UuidB64ToBlobWith(UuidSimdLevel level, const unsigned char * text, size_t length, unsigned char * out)
+{
+#ifdef UUID_KERNELS_X86
+    if( length == 22 && level >= UUID_SIMD_SSSE3 )
+    {
+        return sqlite3UuidB64ToBlobSsse3(text, out);
+    }
+#else
+    (void)level;
+#endif
+
+    return sqlite3UuidB64ToBlobScalar(text, length, out);
+}
+
+int sqlite3UuidB64ToBlob(const unsigned char * text, size_t length, unsigned char * out)
+{
+    return sqlite3UuidB64ToBlobWith(sqlite3UuidSimdSupported(), text, length, out);
+}
+
+/*
+* Value of every byte as a hexadecimal digit, or -1 if it is not one
+*/
+static const signed char HEX_VALUES[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+/*
+* Parses any of the accepted forms: 32 hexadecimal digits, upper or lower case, optionally surrounded by {...} and with
+* an optional "-" before any pair of digits, or 22 characters of base64url. This is the reference the vectorized kernels
+* are tested against.
+*/
+int sqlite3UuidStrToBlobScalar(const unsigned char * guidAsText, size_t length, unsigned char * out)
+{
+   // No hexadecimal form is 22 characters long, as the shortest is 32
+   if( length == 22 )
+   {
+      return sqlite3UuidB64ToBlobScalar(guidAsText, length, out);
+   }
+
+   const unsigned char * end = guidAsText + length;
+
+   if( guidAsText < end && guidAsText[0]=='{' )
+   {
+      ++guidAsText;
+   }
+
+   for(size_t i = 0; i < 16; ++i)
+   {
+      if( guidAsText < end && guidAsText[0]=='-' )
+      {
+         ++guidAsText;
+      }
+
+      if( end - guidAsText < 2 )
+      {
+         return 1;
+      }
+
+      const int high = HEX_VALUES[guidAsText[0]];
+      const int low = HEX_VALUES[guidAsText[1]];
+      if( (high | low) < 0 )
+      {
+         return 1;
+      }
+
+      out[i] = static_cast<unsigned char>((high << 4) | low);
+      guidAsText += 2;
+   }
+
+   if( guidAsText < end && guidAsText[0]=='}' )
+   {
+      ++guidAsText;
+   }
+
+   return guidAsText != end;
+}
+
+#ifdef UUID_KERNELS_X86
+/*
+* Vectorized parsing of the canonical 8-4-4-4-12 form only. Anything else is left to the scalar parser.
+*
+* The 32 digits are gathered into two vectors, digits 0-15 and 16-31, and validated together: a byte is a digit if
+* subtracting '0' leaves at most 9, or a letter if, once lower cased, subtracting 'a' leaves at most 5. The values are then
+* packed, two nibbles to a byte. The dashes are checked separately, by position.
+*/
+
+/*
+* Validates 16 hex digits and converts them to nibble values. Returns false if any byte is not a hex digit.
+*/
+UUID_TARGET("sse2") static inline bool sqlite3UuidHexToNibblesSse2(__m128i text, __m128i & nibbles)
+{
+    const __m128i digits = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    const __m128i letters = _mm_sub_epi8(_mm_or_si128(text, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+
+    nibbles = _mm_or_si128(_mm_and_si128(isDigit, digits), _mm_and_si128(isLetter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+    return _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == 0xffff;
+}
+
+/*
+* Byte positions of the dashes in the canonical form, as movemask bits of the first and second 16 bytes
+*/
+static const int CANONICAL_FIRST_DASHES = (1 << 8) | (1 << 13);
+static const int CANONICAL_SECOND_DASHES = (1 << (18 - 16)) | (1 << (23 - 16));
+
+/*
+* SSE2 gathers the digits with fixed size copies and packs the nibbles with shifts
+*/
+UUID_TARGET("sse2") static int sqlite3UuidCanonicalToBlobSse2(const unsigned char * text, unsigned char * out)
+{
+    const __m128i dash = _mm_set1_epi8('-');
+    const int firstDashes = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text)), dash));
+    const int secondDashes = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 16)), dash));
+    if( (firstDashes & CANONICAL_FIRST_DASHES) != CANONICAL_FIRST_DASHES || (secondDashes & CANONICAL_SECOND_DASHES) != CANONICAL_SECOND_DASHES )
+    {
+        return 1;
+    }
+
+    unsigned char digits[32];
+    memcpy(digits, text, 8);
+    memcpy(digits + 8, text + 9, 4);
+    memcpy(digits + 12, text + 14, 4);
+    memcpy(digits + 16, text + 19, 4);
+    memcpy(digits + 20, text + 24, 12);
+
+    __m128i first;
+    __m128i second;
+    if( !sqlite3UuidHexToNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)), first) ||
+        !sqlite3UuidHexToNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits + 16)), second) )
+    {
+        return 1;
+    }
+
+    // Each 16-bit lane holds a high nibble in its low byte and a low nibble in its high byte
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    first = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(first, lowBytes), 4), _mm_srli_epi16(first, 8));
+    second = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(second, lowBytes), 4), _mm_srli_epi16(second, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(first, second));
+    return 0;
+}
+
+/*
+* SSSE3 gathers the digits with byte shuffles from three overlapping loads, at offsets 0, 16 and 20,
+* and packs the nibbles with a multiply-add
+*/
+#define UUID_Z -128
+UUID_TARGET("ssse3") static int sqlite3UuidCanonicalToBlobSsse3(const unsigned char * text, unsigned char * out)
+{
+    const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+    const __m128i middle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 16));
+    const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 20));
+
+    const __m128i dash = _mm_set1_epi8('-');
+    const int firstDashes = _mm_movemask_epi8(_mm_cmpeq_epi8(head, dash));
+    const int secondDashes = _mm_movemask_epi8(_mm_cmpeq_epi8(middle, dash));
+    if( (firstDashes & CANONICAL_FIRST_DASHES) != CANONICAL_FIRST_DASHES || (secondDashes & CANONICAL_SECOND_DASHES) != CANONICAL_SECOND_DASHES )
+    {
+        return 1;
+    }
+
+    const __m128i firstFromHead = _mm_setr_epi8(0,1,2,3,4,5,6,7,9,10,11,12,14,15,UUID_Z,UUID_Z);
+    const __m128i firstFromMiddle = _mm_setr_epi8(UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,0,1);
+    const __m128i secondFromMiddle = _mm_setr_epi8(3,4,5,6,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z,UUID_Z);
+    const __m128i secondFromTail = _mm_setr_epi8(UUID_Z,UUID_Z,UUID_Z,UUID_Z,4,5,6,7,8,9,10,11,12,13,14,15);
+
+    __m128i first;
+    __m128i second;
+    if( !sqlite3UuidHexToNibblesSse2(_mm_or_si128(_mm_shuffle_epi8(head, firstFromHead), _mm_shuffle_epi8(middle, firstFromMiddle)), first) ||
+        !sqlite3UuidHexToNibblesSse2(_mm_or_si128(_mm_shuffle_epi8(middle, secondFromMiddle), _mm_shuffle_epi8(tail, secondFromTail)), second) )
+    {
+        return 1;
+    }
+
+    // Multiply each high nibble by 16 and add its low nibble
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights)));
+    return 0;
+}
+#undef UUID_Z
+#endif
+
+int sqlite3UuidStrToBlobWith(UuidSimdLevel level, const unsigned char * guidAsText, size_t length, unsigned char * out)
+{
+    if( length == 22 )
+    {
+        return sqlite3UuidB64ToBlobWith(level, guidAsText, length, out);
+    }
+
+#ifdef UUID_KERNELS_X86
+    if( length == 36 )
+    {
+        if( level >= UUID_SIMD_SSSE3 )
+        {
+            if( sqlite3UuidCanonicalToBlobSsse3(guidAsText, out) == 0 )
+            {
+                return 0;
+            }
+        }
+        else if( level == UUID_SIMD_SSE2 )
+        {
+            if( sqlite3UuidCanonicalToBlobSse2(guidAsText, out) == 0 )
+            {
+                return 0;
+            }
+        }
+    }
+#else
+    (void)level;
+#endif
+
+    // Braces, dashes in other places, or invalid input
+    return sqlite3UuidStrToBlobScalar(guidAsText, length, out);
+}
+
+int sqlite3UuidStrToBlob(const unsigned char * guidAsText, size_t length, unsigned char * out)
+{
+    return sqlite3UuidStrToBlobWith(sqlite3UuidSimdSupported(), guidAsText, length, out);
+}
+
+int sqlite3UuidCanonicalToBlobWith(UuidSimdLevel level, const unsigned char * guidAsText, size_t length, unsigned char * out)
+{
+    if( length != 36 )
+    {
+        return 1;
+    }
+
+#ifdef UUID_KERNELS_X86
+    if( level >= UUID_SIMD_SSSE3 )
+    {
+        return sqlite3UuidCanonicalToBlobSsse3(guidAsText, out);
+    }
+    if( level == UUID_SIMD_SSE2 )
+    {
+        return sqlite3UuidCanonicalToBlobSse2(guidAsText, out);
+    }
+#else
+    (void)level;
+#endif
+
+    // With the dashes in place, the 32 other characters can only be parsed as digits
+    if( guidAsText[8] != '-' || guidAsText[13] != '-' || guidAsText[18] != '-' || guidAsText[23] != '-' )
+    {
+        return 1;
+    }
+
+    return sqlite3UuidStrToBlobScalar(guidAsText, length, out);
+}
+
+int sqlite3UuidCanonicalToBlob(const unsigned char * guidAsText, size_t length, unsigned char * out)
+{
+    return sqlite3UuidCanonicalToBlobWith(sqlite3UuidSimdSupported(), guidAsText, length, out);
+}
+
+/*
+* Every accepted form is ASCII, so UTF-16 text is handled by converting between code units and bytes around the 8-bit kernels.
+* On x86 both directions are vectorized with SSE2, which every x86-64 cpu has: widening interleaves the characters with
+* zero bytes, narrowing packs code units to bytes with unsigned saturation. Saturation turns any code unit outside of
+* ASCII into a byte that is not a digit, dash or brace, so it still fails to parse.
+*/
+static const size_t UUID_LONGEST_TEXT = 2 + 16 * 3;
+
+#ifdef UUID_KERNELS_X86
+/*
+* Widens 16 characters at a time, the last block overlapping the one before when count is not a multiple of 16.
+* count must be at least 16.
+*/
+UUID_TARGET("sse2") static void sqlite3UuidWidenSse2(const unsigned char * text, size_t count, bool bigEndian, unsigned char * result)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for(size_t offset = 0; offset < count; offset += 16)
+    {
+        if( offset + 16 > count )
+        {
+            offset = count - 16;
+        }
+
+        const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + offset));
+        const __m128i low = bigEndian ? _mm_unpacklo_epi8(zero, characters) : _mm_unpacklo_epi8(characters, zero);
+        const __m128i high = bigEndian ? _mm_unpackhi_epi8(zero, characters) : _mm_unpackhi_epi8(characters, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 2 * offset), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 2 * offset + 16), high);
+    }
+}
+
+/*
+* Narrows whole blocks of 16 code units, returning how many were done
+*/
+UUID_TARGET("sse2") static size_t sqlite3UuidNarrowSse2(const unsigned char * text16, size_t units, bool bigEndian, unsigned char * text)
+{
+    size_t i = 0;
+    for( ; i + 16 <= units; i += 16)
+    {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text16 + 2 * i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text16 + 2 * i + 16));
+        if( bigEndian )
+        {
+            low = _mm_or_si128(_mm_slli_epi16(low, 8), _mm_srli_epi16(low, 8));
+            high = _mm_or_si128(_mm_slli_epi16(high, 8), _mm_srli_epi16(high, 8));
+        }
+
+        // Code units from 0x8000 up are negative to the signed pack and become 0, which is not accepted either
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(text + i), _mm_packus_epi16(low, high));
+    }
+    return i;
+}
+#endif
+
+void sqlite3UuidWiden16(const unsigned char * text, size_t count, bool bigEndian, unsigned char * result)
+{
+#ifdef UUID_KERNELS_X86
+    if( count >= 16 && sqlite3UuidSimdSupported() >= UUID_SIMD_SSE2 )
+    {
+        sqlite3UuidWidenSse2(text, count, bigEndian, result);
+        return;
+    }
+#endif
+
+    for(size_t i = 0; i < count; i++)
+    {
+        result[2 * i + (bigEndian ? 0 : 1)] = 0;
+        result[2 * i + (bigEndian ? 1 : 0)] = text[i];
+    }
+}
+
+size_t sqlite3UuidNarrow16(const unsigned char * text16, size_t length, bool bigEndian, unsigned char * text, size_t capacity)
+{
+    const size_t units = length / 2;
+    if( (length & 1) != 0 || units > capacity )
+    {
+        return SIZE_MAX;
+    }
+
+    size_t i = 0;
+
+#ifdef UUID_KERNELS_X86
+    if( sqlite3UuidSimdSupported() >= UUID_SIMD_SSE2 )
+    {
+        i = sqlite3UuidNarrowSse2(text16, units, bigEndian, text);
+    }
+#endif
+
+    for( ; i < units; i++)
+    {
+        const unsigned unit = bigEndian ? (text16[2 * i] << 8) | text16[2 * i + 1] : (text16[2 * i + 1] << 8) | text16[2 * i];
+        text[i] = static_cast<unsigned char>(unit > 0xFF ? 0xFF : unit);
+    }
+
+    return units;
+}
+
+void sqlite3UuidBlobToStr16(const unsigned char * bytes, bool bigEndian, unsigned char * result)
+{
+    unsigned char text[37];
+    sqlite3UuidBlobToStr(bytes, text);
+    sqlite3UuidWiden16(text, 36, bigEndian, result);
+}
+
+int sqlite3UuidStr16ToBlob(const unsigned char * guidAsText, size_t length, bool bigEndian, unsigned char * out)
+{
+    unsigned char text[UUID_LONGEST_TEXT];
+    const size_t units = sqlite3UuidNarrow16(guidAsText, length, bigEndian, text, UUID_LONGEST_TEXT);
+    if( units == SIZE_MAX )
+    {
+        return 1;
+    }
+
+    return sqlite3UuidStrToBlob(text, units, out);
+}
@@ -0,0 +1,477 @@
+/*
+** Name-based UUIDs: version 5 from SHA-1 and version 3 from MD5 (RFC 9562 sections 5.3 and 5.5).
+**
+** Both hash the namespace UUID followed by the name, which is rarely more than a block or two, so the message is padded one
+** 64-byte block at a time as it is hashed rather than copied whole. SHA-1 has a portable version, and one using the SHA
+** extensions selected at runtime. The SHA-1 round instructions have a latency of several cycles, and each depends on the
+** last, so the batch API hashes two names at once with their instructions interleaved to fill the gaps.
+** MD5 is only there for existing version 3 identifiers, and is portable only.
+*/
+
+#include "sqlite_extensions/uuidname.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+# define UUID_KERNELS_X86 1
+# define UUID_TARGET(isa) __attribute__((target(isa)))
+# include <immintrin.h>
+#endif
+
+/*
+* Number of 64-byte blocks the padded message takes: the 16 namespace bytes and the name, a 0x80 byte, and an 8 byte length
+*/
+static size_t sqlite3UuidNameBlocks(size_t length)
+{
+    return (16 + length + 8) / 64 + 1;
+}
+
+/*
+* Fills block with block blockIndex of the padded message: the namespace, the name, a 0x80 byte, zeros, and the length in
+* bits in the last 8 bytes of the last block, big-endian for SHA-1 and little-endian for MD5
+*/
+static void sqlite3UuidNameBlock(const unsigned char * namespaceBytes, const unsigned char * name, size_t length, size_t blockIndex,
+                                 bool bigEndianLength, unsigned char * block)
+{
+    const size_t total = 16 + length;
+    const size_t start = 64 * blockIndex;
+    const size_t end = start + 64;
+    memset(block, 0, 64);
+
+    if( start < 16 )
+    {
+        memcpy(block, namespaceBytes + start, 16 - start);
+    }
+
+    const size_t nameStart = start < 16 ? 16 : start;
+    const size_t nameEnd = end < total ? end : total;
+    if( nameStart < nameEnd )
+    {
+        memcpy(block + (nameStart - start), name + (nameStart - 16), nameEnd - nameStart);
+    }
+
+    if( total >= start && total < end )
+    {
+        block[total - start] = 0x80;
+    }
+
+    if( blockIndex + 1 == sqlite3UuidNameBlocks(length) )
+    {
+        const uint64_t bits = static_cast<uint64_t>(total) * 8;
+        for(int byteIndex = 0; byteIndex < 8; byteIndex++)
+        {
+            block[56 + byteIndex] = static_cast<unsigned char>(bits >> (bigEndianLength ? 56 - 8 * byteIndex : 8 * byteIndex));
+        }
+    }
+}
+
+/*
+* Turns the first 16 bytes of a digest into a UUID of the given version and variant 1
+*/
+static void sqlite3UuidFromDigest(const unsigned char * digest, int version, unsigned char * out)
+{
+    memcpy(out, digest, 16);
+    out[6] = static_cast<unsigned char>((out[6] & 0x0f) | (version << 4));
+    out[8] = static_cast<unsigned char>((out[8] & 0x3f) | 0x80);
+}
+
+static const uint32_t SHA1_INITIAL_STATE[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+static inline uint32_t sqlite3UuidRotateLeft(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void sqlite3UuidSha1CompressScalar(uint32_t * state, const unsigned char * block)
+{
+    uint32_t words[80];
+    for(int wordIndex = 0; wordIndex < 16; wordIndex++)
+    {
+        words[wordIndex] = (uint32_t(block[4 * wordIndex]) << 24) | (uint32_t(block[4 * wordIndex + 1]) << 16) |
+                           (uint32_t(block[4 * wordIndex + 2]) << 8) | uint32_t(block[4 * wordIndex + 3]);
+    }
+    for(int wordIndex = 16; wordIndex < 80; wordIndex++)
+    {
+        words[wordIndex] = sqlite3UuidRotateLeft(words[wordIndex - 3] ^ words[wordIndex - 8] ^ words[wordIndex - 14] ^ words[wordIndex - 16], 1);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    for(int round = 0; round < 80; round++)
+    {
+        uint32_t mixed;
+        uint32_t constant;
+        if( round < 20 )
+        {
+            mixed = (b & c) | (~b & d);
+            constant = 0x5a827999;
+        }
+        else if( round < 40 )
+        {
+            mixed = b ^ c ^ d;
+            constant = 0x6ed9eba1;
+        }
+        else if( round < 60 )
+        {
+            mixed = (b & c) | (b & d) | (c & d);
+            constant = 0x8f1bbcdc;
+        }
+        else
+        {
+            mixed = b ^ c ^ d;
+            constant = 0xca62c1d6;
+        }
+
+        const uint32_t next = sqlite3UuidRotateLeft(a, 5) + mixed + e + constant + words[round];
+        e = d;
+        d = c;
+        c = sqlite3UuidRotateLeft(b, 30);
+        b = a;
+        a = next;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+static void sqlite3UuidSha1Digest(const uint32_t * state, unsigned char * digest)
+{
+    for(int wordIndex = 0; wordIndex < 5; wordIndex++)
+    {
+        for(int byteIndex = 0; byteIndex < 4; byteIndex++)
+        {
+            digest[4 * wordIndex + byteIndex] = static_cast<unsigned char>(state[wordIndex] >> (24 - 8 * byteIndex));
+        }
+    }
+}
+
+#ifdef UUID_KERNELS_X86
+/*
+* SHA-1 with the SHA extensions, after the sequence in Intel's white paper "New Instructions Supporting the Secure Hash
+* Algorithm on Intel Architecture Processors": 20 groups of 4 rounds, each one sha1rnds4, with the message schedule for
+* later groups computed by sha1msg1, sha1msg2 and xors alongside. ABCD holds a-d with a in the top lane, and the E
+* registers alternate between the e for the next group and the previous ABCD.
+*
+* Every step is done for each of LANES independent blocks before moving on, so with two lanes the two dependency chains
+* are interleaved. The lane loops are unrolled away.
+*/
+#define UUID_SHA1_LANES(statement) _Pragma("GCC unroll 2") for(int lane = 0; lane < LANES; lane++) { statement; }
+
+template<int LANES>
+UUID_TARGET("sha,sse4.1") static void sqlite3UuidSha1CompressShaNi(uint32_t * const * states, const unsigned char * const * blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ll, 0x08090a0b0c0d0e0fll);
+
+    __m128i abcd[LANES];
+    __m128i abcdSaved[LANES];
+    __m128i e0[LANES];
+    __m128i e0Saved[LANES];
+    __m128i e1[LANES];
+    __m128i message0[LANES];
+    __m128i message1[LANES];
+    __m128i message2[LANES];
+    __m128i message3[LANES];
+
+    UUID_SHA1_LANES(
+        abcd[lane] = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(states[lane])), 0x1b);
+        e0[lane] = _mm_set_epi32(static_cast<int>(states[lane][4]), 0, 0, 0);
+        abcdSaved[lane] = abcd[lane];
+        e0Saved[lane] = e0[lane];
+        message0[lane] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[lane])), byteSwap);
+        message1[lane] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[lane] + 16)), byteSwap);
+        message2[lane] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[lane] + 32)), byteSwap);
+        message3[lane] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[lane] + 48)), byteSwap))
+
+    // Rounds 0-15 take the message words as they are
+    UUID_SHA1_LANES(
+        e0[lane] = _mm_add_epi32(e0[lane], message0[lane]);
+        e1[lane] = abcd[lane];
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e0[lane], 0))
+    UUID_SHA1_LANES(
+        e1[lane] = _mm_sha1nexte_epu32(e1[lane], message1[lane]);
+        e0[lane] = abcd[lane];
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e1[lane], 0);
+        message0[lane] = _mm_sha1msg1_epu32(message0[lane], message1[lane]))
+    UUID_SHA1_LANES(
+        e0[lane] = _mm_sha1nexte_epu32(e0[lane], message2[lane]);
+        e1[lane] = abcd[lane];
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e0[lane], 0);
+        message1[lane] = _mm_sha1msg1_epu32(message1[lane], message2[lane]);
+        message0[lane] = _mm_xor_si128(message0[lane], message2[lane]))
+
+    // From here every group finishes the schedule for the next group and carries on the schedule for the ones after
+#define UUID_SHA1_GROUP(eCurrent, eOther, current, next, afterNext, previous, function) \
+    UUID_SHA1_LANES( \
+        eCurrent[lane] = _mm_sha1nexte_epu32(eCurrent[lane], current[lane]); \
+        eOther[lane] = abcd[lane]; \
+        next[lane] = _mm_sha1msg2_epu32(next[lane], current[lane]); \
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], eCurrent[lane], function); \
+        previous[lane] = _mm_sha1msg1_epu32(previous[lane], current[lane]); \
+        afterNext[lane] = _mm_xor_si128(afterNext[lane], current[lane]))
+
+    UUID_SHA1_GROUP(e1, e0, message3, message0, message1, message2, 0)
+    UUID_SHA1_GROUP(e0, e1, message0, message1, message2, message3, 0)
+    UUID_SHA1_GROUP(e1, e0, message1, message2, message3, message0, 1)
+    UUID_SHA1_GROUP(e0, e1, message2, message3, message0, message1, 1)
+    UUID_SHA1_GROUP(e1, e0, message3, message0, message1, message2, 1)
+    UUID_SHA1_GROUP(e0, e1, message0, message1, message2, message3, 1)
+    UUID_SHA1_GROUP(e1, e0, message1, message2, message3, message0, 1)
+    UUID_SHA1_GROUP(e0, e1, message2, message3, message0, message1, 2)
+    UUID_SHA1_GROUP(e1, e0, message3, message0, message1, message2, 2)
+    UUID_SHA1_GROUP(e0, e1, message0, message1, message2, message3, 2)
+    UUID_SHA1_GROUP(e1, e0, message1, message2, message3, message0, 2)
+    UUID_SHA1_GROUP(e0, e1, message2, message3, message0, message1, 2)
+    UUID_SHA1_GROUP(e1, e0, message3, message0, message1, message2, 3)
+    UUID_SHA1_GROUP(e0, e1, message0, message1, message2, message3, 3)
+#undef UUID_SHA1_GROUP
+
+    // Rounds 68-79 only finish the schedule
+    UUID_SHA1_LANES(
+        e1[lane] = _mm_sha1nexte_epu32(e1[lane], message1[lane]);
+        e0[lane] = abcd[lane];
+        message2[lane] = _mm_sha1msg2_epu32(message2[lane], message1[lane]);
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e1[lane], 3);
+        message3[lane] = _mm_xor_si128(message3[lane], message1[lane]))
+    UUID_SHA1_LANES(
+        e0[lane] = _mm_sha1nexte_epu32(e0[lane], message2[lane]);
+        e1[lane] = abcd[lane];
+        message3[lane] = _mm_sha1msg2_epu32(message3[lane], message2[lane]);
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e0[lane], 3))
+    UUID_SHA1_LANES(
+        e1[lane] = _mm_sha1nexte_epu32(e1[lane], message3[lane]);
+        e0[lane] = abcd[lane];
+        abcd[lane] = _mm_sha1rnds4_epu32(abcd[lane], e1[lane], 3))
+
+    UUID_SHA1_LANES(
+        e0[lane] = _mm_sha1nexte_epu32(e0[lane], e0Saved[lane]);
+        abcd[lane] = _mm_add_epi32(abcd[lane], abcdSaved[lane]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(states[lane]), _mm_shuffle_epi32(abcd[lane], 0x1b));
+        states[lane][4] = static_cast<uint32_t>(_mm_extract_epi32(e0[lane], 3)))
+}
+#undef UUID_SHA1_LANES
+#endif
+
+bool sqlite3UuidShaNiSupported()
+{
+#ifdef UUID_KERNELS_X86
+    static const bool supported = []()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    }();
+
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void sqlite3UuidV5GenerateWith(bool shaNi, const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out)
+{
+    uint32_t state[5];
+    memcpy(state, SHA1_INITIAL_STATE, sizeof(state));
+
+    unsigned char block[64];
+    const size_t blocks = sqlite3UuidNameBlocks(length);
+    for(size_t blockIndex = 0; blockIndex < blocks; blockIndex++)
+    {
+        sqlite3UuidNameBlock(namespaceBytes, name, length, blockIndex, true, block);
+#ifdef UUID_KERNELS_X86
+        if( shaNi )
+        {
+            uint32_t * states[1] = {state};
+            const unsigned char * blockPointers[1] = {block};
+            sqlite3UuidSha1CompressShaNi<1>(states, blockPointers);
+            continue;
+        }
+#else
+        (void)shaNi;
+#endif
+        sqlite3UuidSha1CompressScalar(state, block);
+    }
+
+    unsigned char digest[20];
+    sqlite3UuidSha1Digest(state, digest);
+    sqlite3UuidFromDigest(digest, 5, out);
+}
+
+void sqlite3UuidV5Generate(const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out)
+{
+    sqlite3UuidV5GenerateWith(sqlite3UuidShaNiSupported(), namespaceBytes, name, length, out);
+}
+
+/*
+* Names are taken in pairs, whose blocks are hashed together for as long as both have blocks left. The rest of the longer
+* name, and the last name of an odd count, are hashed on their own.
+*/
+void sqlite3UuidV5GenerateBatchWith(bool shaNi, const unsigned char * namespaceBytes, const unsigned char * const * names, const size_t * lengths,
+                                    size_t count, unsigned char * out)
+{
+    size_t nameIndex = 0;
+
+#ifdef UUID_KERNELS_X86
+    if( shaNi )
+    {
+        for( ; nameIndex + 2 <= count; nameIndex += 2)
+        {
+            uint32_t stateFirst[5];
+            uint32_t stateSecond[5];
+            memcpy(stateFirst, SHA1_INITIAL_STATE, sizeof(stateFirst));
+            memcpy(stateSecond, SHA1_INITIAL_STATE, sizeof(stateSecond));
+            uint32_t * states[2] = {stateFirst, stateSecond};
+
+            unsigned char blockFirst[64];
+            unsigned char blockSecond[64];
+            const unsigned char * blocks[2] = {blockFirst, blockSecond};
+
+            const size_t blocksFirst = sqlite3UuidNameBlocks(lengths[nameIndex]);
+            const size_t blocksSecond = sqlite3UuidNameBlocks(lengths[nameIndex + 1]);
+            const size_t longest = blocksFirst > blocksSecond ? blocksFirst : blocksSecond;
+            for(size_t blockIndex = 0; blockIndex < longest; blockIndex++)
+            {
+                const bool first = blockIndex < blocksFirst;
+                const bool second = blockIndex < blocksSecond;
+                if( first )
+                {
+                    sqlite3UuidNameBlock(namespaceBytes, names[nameIndex], lengths[nameIndex], blockIndex, true, blockFirst);
+                }
+                if( second )
+                {
+                    sqlite3UuidNameBlock(namespaceBytes, names[nameIndex + 1], lengths[nameIndex + 1], blockIndex, true, blockSecond);
+                }
+
+                if( first && second )
+                {
+                    sqlite3UuidSha1CompressShaNi<2>(states, blocks);
+                }
+                else
+                {
+                    sqlite3UuidSha1CompressShaNi<1>(first ? states : states + 1, first ? blocks : blocks + 1);
+                }
+            }
+
+            unsigned char digest[20];
+            sqlite3UuidSha1Digest(stateFirst, digest);
+            sqlite3UuidFromDigest(digest, 5, out + 16 * nameIndex);
+            sqlite3UuidSha1Digest(stateSecond, digest);
+            sqlite3UuidFromDigest(digest, 5, out + 16 * (nameIndex + 1));
+        }
+    }
+#endif
+
+    for( ; nameIndex < count; nameIndex++)
+    {
+        sqlite3UuidV5GenerateWith(shaNi, namespaceBytes, names[nameIndex], lengths[nameIndex], out + 16 * nameIndex);
+    }
+}
+
+void sqlite3UuidV5GenerateBatch(const unsigned char * namespaceBytes, const unsigned char * const * names, const size_t * lengths,
+                                size_t count, unsigned char * out)
+{
+    sqlite3UuidV5GenerateBatchWith(sqlite3UuidShaNiSupported(), namespaceBytes, names, lengths, count, out);
+}
+
+/*
+* MD5 as in RFC 1321, little-endian throughout
+*/
+static const uint32_t MD5_SINES[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static const int MD5_SHIFTS[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+static void sqlite3UuidMd5Compress(uint32_t * state, const unsigned char * block)
+{
+    uint32_t words[16];
+    for(int wordIndex = 0; wordIndex < 16; wordIndex++)
+    {
+        words[wordIndex] = uint32_t(block[4 * wordIndex]) | (uint32_t(block[4 * wordIndex + 1]) << 8) |
+                           (uint32_t(block[4 * wordIndex + 2]) << 16) | (uint32_t(block[4 * wordIndex + 3]) << 24);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+
+    for(int round = 0; round < 64; round++)
+    {
+        uint32_t mixed;
+        int wordIndex;
+        if( round < 16 )
+        {
+            mixed = (b & c) | (~b & d);
+            wordIndex = round;
+        }
+        else if( round < 32 )
+        {
+            mixed = (d & b) | (~d & c);
+            wordIndex = (5 * round + 1) % 16;
+        }
+        else if( round < 48 )
+        {
+            mixed = b ^ c ^ d;
+            wordIndex = (3 * round + 5) % 16;
+        }
+        else
+        {
+            mixed = c ^ (b | ~d);
+            wordIndex = (7 * round) % 16;
+        }
+
+        const uint32_t next = b + sqlite3UuidRotateLeft(a + mixed + MD5_SINES[round] + words[wordIndex], MD5_SHIFTS[round]);
+        a = d;
+        d = c;
+        c = b;
+        b = next;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+void sqlite3UuidV3Generate(const unsigned char * namespaceBytes, const unsigned char * name, size_t length, unsigned char * out)
+{
+    uint32_t state[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+    unsigned char block[64];
+    const size_t blocks = sqlite3UuidNameBlocks(length);
+    for(size_t blockIndex = 0; blockIndex < blocks; blockIndex++)
+    {
+        sqlite3UuidNameBlock(namespaceBytes, name, length, blockIndex, false, block);
+        sqlite3UuidMd5Compress(state, block);
+    }
+
+    unsigned char digest[16];
+    for(int wordIndex = 0; wordIndex < 4; wordIndex++)
+    {
+        for(int byteIndex = 0; byteIndex < 4; byteIndex++)
+        {
+            digest[4 * wordIndex + byteIndex] = static_cast<unsigned char>(state[wordIndex] >> (8 * byteIndex));
+        }
+    }
+
+    sqlite3UuidFromDigest(digest, 3, out);
+}
@@ -0,0 +1,363 @@
+/*
+** Packs of UUIDs, sorted sets of them in one blob, and the uuid_each table-valued function that unnests them:
+**
+**     SELECT uuid, uuid_blob FROM uuid_each(P)
+**
+** produces one row for each UUID of pack P, in order, numbered by rowid from 1, as both a string and a 16-byte blob.
+** One row holding the pack of a user's groups replaces a junction table row for each of them, for example
+**
+**     SELECT groups.name FROM users, uuid_each(users.group_ids) AS member JOIN groups ON groups.id = member.uuid_blob
+**
+** The cursor reads each UUID straight out of the pack argument, without copying it, so a join that unnests a pack for
+** every outer row costs no more than reading them. The pack is checked to be sorted once per scan, so the rows can be
+** handed out as already ordered by uuid_blob.
+*/
+
+#include "sqlite_extensions/uuidpack.hpp"
+SQLITE_EXTENSION_INIT3
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Spelled out rather than a loop, which compilers turn into a single load and byte swap
+    inline uint64_t readBigEndian64(const unsigned char * bytes)
+    {
+        return (uint64_t(bytes[0]) << 56) | (uint64_t(bytes[1]) << 48) | (uint64_t(bytes[2]) << 40) | (uint64_t(bytes[3]) << 32) |
+            (uint64_t(bytes[4]) << 24) | (uint64_t(bytes[5]) << 16) | (uint64_t(bytes[6]) << 8) | uint64_t(bytes[7]);
+    }
+
+    inline void writeBigEndian64(uint64_t value, unsigned char * bytes)
+    {
+        for(int byteIndex = 7; byteIndex >= 0; byteIndex--)
+        {
+            bytes[byteIndex] = static_cast<unsigned char>(value);
+            value >>= 8;
+        }
+    }
+
+    inline bool keyLess(const UuidPackKey & left, const UuidPackKey & right)
+    {
+        return left.high < right.high || (left.high == right.high && left.low < right.low);
+    }
+
+    inline bool keyEqual(const UuidPackKey & left, const UuidPackKey & right)
+    {
+        return left.high == right.high && left.low == right.low;
+    }
+}
+
+UuidPackKey sqlite3UuidPackKey(const unsigned char * bytes)
+{
+    return UuidPackKey{readBigEndian64(bytes), readBigEndian64(bytes + 8)};
+}
+
+size_t sqlite3UuidPackSort(UuidPackKey * keys, size_t count)
+{
+    std::sort(keys, keys + count, keyLess);
+    return static_cast<size_t>(std::unique(keys, keys + count, keyEqual) - keys);
+}
+
+void sqlite3UuidPackWrite(const UuidPackKey * keys, size_t count, unsigned char * pack)
+{
+    for(size_t keyIndex = 0; keyIndex < count; keyIndex++)
+    {
+        writeBigEndian64(keys[keyIndex].high, pack + 16 * keyIndex);
+        writeBigEndian64(keys[keyIndex].low, pack + 16 * keyIndex + 8);
+    }
+}
+
+bool sqlite3UuidPackContains(const unsigned char * pack, size_t count, const unsigned char * bytes)
+{
+    if( count == 0 )
+    {
+        return false;
+    }
+
+    // Narrows down on the last UUID not above the one searched for. The number of steps depends only on count, and each
+    // step moves the base by a mask rather than a branch, which would be mispredicted half of the time.
+    const UuidPackKey key = sqlite3UuidPackKey(bytes);
+    const unsigned char * base = pack;
+    size_t remaining = count;
+
+    while( remaining > 1 )
+    {
+        const size_t half = remaining / 2;
+        const UuidPackKey probe = sqlite3UuidPackKey(base + 16 * half);
+        const size_t notAbove = static_cast<size_t>((probe.high < key.high) | ((probe.high == key.high) & (probe.low <= key.low)));
+        base += (size_t(0) - notAbove) & (16 * half);
+        remaining -= half;
+    }
+
+    return memcmp(base, bytes, 16) == 0;
+}
+
+bool sqlite3UuidPackIsSorted(const unsigned char * pack, size_t count)
+{
+    for(size_t uuidIndex = 1; uuidIndex < count; uuidIndex++)
+    {
+        if( memcmp(pack + 16 * (uuidIndex - 1), pack + 16 * uuidIndex, 16) >= 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace
+{
+    enum EachColumn
+    {
+        EACH_COLUMN_UUID = 0,
+        EACH_COLUMN_UUID_BLOB,
+        EACH_COLUMN_PACK
+    };
+
+    struct EachCursor
+    {
+        sqlite3_vtab_cursor base;
+        sqlite3_value * pack;       // the argument to xFilter, not a copy
+        const unsigned char * bytes;
+        sqlite3_int64 count;
+        sqlite3_int64 rowid;
+    };
+
+    int eachConnect(sqlite3 * db, void * pAux, int argc, const char * const * argv, sqlite3_vtab ** ppVtab, char ** pzErr)
+    {
+        (void)pAux;
+        (void)argc;
+        (void)argv;
+        (void)pzErr;
+
+        int returnCode = sqlite3_declare_vtab(db, "CREATE TABLE x(uuid TEXT, uuid_blob BLOB, pack HIDDEN)");
+        if( returnCode != SQLITE_OK )
+        {
+            return returnCode;
+        }
+
+        sqlite3_vtab * table = reinterpret_cast<sqlite3_vtab *>(sqlite3_malloc(sizeof(sqlite3_vtab)));
+        if( table == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        memset(table, 0, sizeof(sqlite3_vtab));
+        sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+
+        *ppVtab = table;
+        return SQLITE_OK;
+    }
+
+    int eachDisconnect(sqlite3_vtab * pVtab)
+    {
+        sqlite3_free(pVtab);
+        return SQLITE_OK;
+    }
+
+    int eachOpen(sqlite3_vtab * pVtab, sqlite3_vtab_cursor ** ppCursor)
+    {
+        (void)pVtab;
+
+        EachCursor * cursor = reinterpret_cast<EachCursor *>(sqlite3_malloc(sizeof(EachCursor)));
+        if( cursor == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        memset(cursor, 0, sizeof(EachCursor));
+        *ppCursor = &cursor->base;
+        return SQLITE_OK;
+    }
+
+    int eachClose(sqlite3_vtab_cursor * pCursor)
+    {
+        sqlite3_free(pCursor);
+        return SQLITE_OK;
+    }
+
+    int eachNext(sqlite3_vtab_cursor * pCursor)
+    {
+        reinterpret_cast<EachCursor *>(pCursor)->rowid++;
+        return SQLITE_OK;
+    }
+
+    int eachEof(sqlite3_vtab_cursor * pCursor)
+    {
+        EachCursor * cursor = reinterpret_cast<EachCursor *>(pCursor);
+        return cursor->rowid > cursor->count;
+    }
+
+    int eachColumn(sqlite3_vtab_cursor * pCursor, sqlite3_context * context, int column)
+    {
+        EachCursor * cursor = reinterpret_cast<EachCursor *>(pCursor);
+        const unsigned char * bytes = cursor->bytes + 16 * (cursor->rowid - 1);
+
+        switch( column )
+        {
+            case EACH_COLUMN_UUID:
+            {
+                unsigned char text[37];
+                sqlite3UuidBlobToStr(bytes, text);
+                sqlite3_result_text(context, reinterpret_cast<char *>(text), 36, SQLITE_TRANSIENT);
+                break;
+            }
+            case EACH_COLUMN_UUID_BLOB:
+            {
+                sqlite3_result_blob(context, bytes, 16, SQLITE_TRANSIENT);
+                break;
+            }
+            default:
+            {
+                sqlite3_result_value(context, cursor->pack);
+                break;
+            }
+        }
+
+        return SQLITE_OK;
+    }
+
+    int eachRowid(sqlite3_vtab_cursor * pCursor, sqlite_int64 * pRowid)
+    {
+        *pRowid = reinterpret_cast<EachCursor *>(pCursor)->rowid;
+        return SQLITE_OK;
+    }
+
+    /*
+    * Reads the pack in place for the scan. NULL is an empty pack. idxNum is 1 when xBestIndex was given the pack.
+    *
+    * The argument is the register sqlite evaluated it into, which is left alone until the statement evaluates it again for
+    * the next xFilter, so its blob stays put for the whole scan.
+    */
+    int eachFilter(sqlite3_vtab_cursor * pCursor, int idxNum, const char * idxStr, int argc, sqlite3_value ** argv)
+    {
+        EachCursor * cursor = reinterpret_cast<EachCursor *>(pCursor);
+        (void)idxStr;
+        (void)argc;
+
+        cursor->pack = nullptr;
+        cursor->bytes = nullptr;
+        cursor->count = 0;
+        cursor->rowid = 1;
+
+        // Without a pack xBestIndex only offers a plan too costly to be picked, so this is a query without one
+        if( idxNum == 0 )
+        {
+            sqlite3_free(pCursor->pVtab->zErrMsg);
+            pCursor->pVtab->zErrMsg = sqlite3_mprintf("uuid_each() requires a pack of UUIDs");
+            return SQLITE_ERROR;
+        }
+
+        cursor->pack = argv[0];
+
+        const int packType = sqlite3_value_type(argv[0]);
+        if( packType == SQLITE_NULL )
+        {
+            return SQLITE_OK;
+        }
+
+        cursor->bytes = reinterpret_cast<const unsigned char *>(sqlite3_value_blob(argv[0]));
+        const int size = sqlite3_value_bytes(argv[0]);
+        cursor->count = size / 16;
+
+        if( packType != SQLITE_BLOB || size % 16 != 0 || !sqlite3UuidPackIsSorted(cursor->bytes, static_cast<size_t>(cursor->count)) )
+        {
+            cursor->count = 0;
+            sqlite3_free(pCursor->pVtab->zErrMsg);
+            pCursor->pVtab->zErrMsg = sqlite3_mprintf("uuid_each() needs a pack of sorted 16-byte UUIDs, as uuid_pack() makes");
+            return SQLITE_ERROR;
+        }
+
+        return SQLITE_OK;
+    }
+
+    /*
+    * The pack argument is required. A plan without it, which sqlite asks for while planning OR terms among others, is given
+    * a cost no other plan exceeds rather than an error, and xFilter reports the error if it is ever run.
+    */
+    int eachBestIndex(sqlite3_vtab * pVtab, sqlite3_index_info * pIdxInfo)
+    {
+        (void)pVtab;
+        int packConstraint = -1;
+        bool packUnusable = false;
+
+        for(int i = 0; i < pIdxInfo->nConstraint; i++)
+        {
+            const sqlite3_index_info::sqlite3_index_constraint & constraint = pIdxInfo->aConstraint[i];
+            if( constraint.iColumn == EACH_COLUMN_PACK && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ )
+            {
+                if( constraint.usable )
+                {
+                    packConstraint = i;
+                }
+                else
+                {
+                    packUnusable = true;
+                }
+            }
+        }
+
+        if( packConstraint < 0 )
+        {
+            // A pack from another table in a join has to wait for a plan that supplies it
+            if( packUnusable )
+            {
+                return SQLITE_CONSTRAINT;
+            }
+
+            pIdxInfo->idxNum = 0;
+            pIdxInfo->estimatedCost = 2147483647.0;
+            pIdxInfo->estimatedRows = 2147483647;
+            return SQLITE_OK;
+        }
+
+        pIdxInfo->aConstraintUsage[packConstraint].argvIndex = 1;
+        pIdxInfo->aConstraintUsage[packConstraint].omit = 1;
+        pIdxInfo->idxNum = 1;
+
+        // Rows come out in rowid order, which is the order of the bytes too
+        if( pIdxInfo->nOrderBy == 1 && !pIdxInfo->aOrderBy[0].desc
+            && (pIdxInfo->aOrderBy[0].iColumn < 0 || pIdxInfo->aOrderBy[0].iColumn == EACH_COLUMN_UUID_BLOB) )
+        {
+            pIdxInfo->orderByConsumed = 1;
+        }
+
+        pIdxInfo->estimatedCost = 100.0;
+        pIdxInfo->estimatedRows = 100;
+        return SQLITE_OK;
+    }
+
+    sqlite3_module eachModule = {
+        0,                  // iVersion
+        0,                  // xCreate - eponymous only
+        eachConnect,        // xConnect
+        eachBestIndex,      // xBestIndex
+        eachDisconnect,     // xDisconnect
+        0,                  // xDestroy
+        eachOpen,           // xOpen
+        eachClose,          // xClose
+        eachFilter,         // xFilter
+        eachNext,           // xNext
+        eachEof,            // xEof
+        eachColumn,         // xColumn
+        eachRowid,          // xRowid
+        0,                  // xUpdate
+        0,                  // xBegin
+        0,                  // xSync
+        0,                  // xCommit
+        0,                  // xRollback
+        0,                  // xFindFunction
+        0,                  // xRename
+        0,                  // xSavepoint
+        0,                  // xRelease
+        0,                  // xRollbackTo
+        0                   // xShadowName
+    };
+}
+
+int sqlite3UuidEachInit(sqlite3 * db)
+{
+    return sqlite3_create_module(db, "uuid_each", &eachModule, 0);
+}
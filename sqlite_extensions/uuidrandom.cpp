@@ -0,0 +1,197 @@
+/*
+** Thread-local randomness pool for the UUID extension.
+**
+** Every thread keeps a buffer of ChaCha20 keystream (RFC 8439 block function, with the original 64-bit block counter and nonce).
+** The key is drawn from getrandom(2) where available, falling back to sqlite3_randomness() elsewhere, and is replaced
+** every POOL_RESEED_INTERVAL refills. Bytes are wiped from the buffer as they are handed out.
+**
+** A child process inherits a copy of every pool, which would make it repeat the parent's UUIDs. A pthread_atfork() handler
+** bumps a process-wide generation number in the child, and a pool whose generation is stale reseeds before its next use.
+*/
+
+#include "sqlite_extensions/uuidrandom.hpp"
+
+#include "sqlite3ext.h"
+SQLITE_EXTENSION_INIT3
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#ifdef __linux__
+# include <sys/random.h>
+#endif
+#ifndef _WIN32
+# include <pthread.h>
+#endif
+
+namespace
+{
+    const size_t CHACHA_BLOCK_BYTES = 64;
+    const size_t POOL_BYTES = 64 * CHACHA_BLOCK_BYTES;
+    const unsigned POOL_RESEED_INTERVAL = 256;
+
+    struct RandomPool
+    {
+        uint32_t key[8];
+        uint64_t nonce;
+        uint64_t blockCounter;
+        unsigned refillsSinceSeed;
+        unsigned generation;
+        size_t offset;
+        unsigned char buffer[POOL_BYTES];
+    };
+
+    // Zero initialized, so the first use on every thread sees a stale generation and seeds itself
+    thread_local RandomPool threadPool;
+
+    std::atomic<unsigned> processGeneration(1);
+    std::once_flag forkHandlerOnce;
+
+    void onForkChild()
+    {
+        processGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline uint32_t rotateLeft(uint32_t value, int bits)
+    {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    inline void quarterRound(uint32_t & a, uint32_t & b, uint32_t & c, uint32_t & d)
+    {
+        a += b; d ^= a; d = rotateLeft(d, 16);
+        c += d; b ^= c; b = rotateLeft(b, 12);
+        a += b; d ^= a; d = rotateLeft(d, 8);
+        c += d; b ^= c; b = rotateLeft(b, 7);
+    }
+
+    /*
+    * Writes one 64-byte block of ChaCha20 keystream for the pool's key, nonce and current block counter
+    */
+    void chachaBlock(const RandomPool & pool, uint64_t blockCounter, unsigned char * out)
+    {
+        uint32_t input[16] = {
+            0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, // "expand 32-byte k"
+            pool.key[0], pool.key[1], pool.key[2], pool.key[3],
+            pool.key[4], pool.key[5], pool.key[6], pool.key[7],
+            static_cast<uint32_t>(blockCounter), static_cast<uint32_t>(blockCounter >> 32),
+            static_cast<uint32_t>(pool.nonce), static_cast<uint32_t>(pool.nonce >> 32)
+        };
+
+        uint32_t x[16];
+        memcpy(x, input, sizeof(x));
+
+        for(int round = 0; round < 10; round++)
+        {
+            quarterRound(x[0], x[4], x[8],  x[12]);
+            quarterRound(x[1], x[5], x[9],  x[13]);
+            quarterRound(x[2], x[6], x[10], x[14]);
+            quarterRound(x[3], x[7], x[11], x[15]);
+            quarterRound(x[0], x[5], x[10], x[15]);
+            quarterRound(x[1], x[6], x[11], x[12]);
+            quarterRound(x[2], x[7], x[8],  x[13]);
+            quarterRound(x[3], x[4], x[9],  x[14]);
+        }
+
+        for(int word = 0; word < 16; word++)
+        {
+            const uint32_t value = x[word] + input[word];
+            out[4 * word + 0] = static_cast<unsigned char>(value);
+            out[4 * word + 1] = static_cast<unsigned char>(value >> 8);
+            out[4 * word + 2] = static_cast<unsigned char>(value >> 16);
+            out[4 * word + 3] = static_cast<unsigned char>(value >> 24);
+        }
+    }
+
+    /*
+    * Fills out with seed material from the operating system
+    */
+    void osRandomness(unsigned char * out, size_t count)
+    {
+#ifdef __linux__
+        size_t filled = 0;
+        while( filled < count )
+        {
+            const ssize_t got = getrandom(out + filled, count - filled, 0);
+            if( got <= 0 )
+            {
+                break;
+            }
+            filled += static_cast<size_t>(got);
+        }
+
+        if( filled == count )
+        {
+            return;
+        }
+#endif
+        // sqlite's own generator is seeded from the VFS. It is also copied by fork(), so ask it to reseed first.
+        sqlite3_randomness(0, nullptr);
+        sqlite3_randomness(static_cast<int>(count), out);
+    }
+
+    void seed(RandomPool & pool, unsigned generation)
+    {
+#ifndef _WIN32
+        std::call_once(forkHandlerOnce, [](){ pthread_atfork(nullptr, nullptr, onForkChild); });
+#endif
+        unsigned char material[sizeof(pool.key) + sizeof(pool.nonce)];
+        osRandomness(material, sizeof(material));
+        memcpy(pool.key, material, sizeof(pool.key));
+        memcpy(&pool.nonce, material + sizeof(pool.key), sizeof(pool.nonce));
+        memset(material, 0, sizeof(material));
+
+        pool.blockCounter = 0;
+        pool.refillsSinceSeed = 0;
+        pool.generation = generation;
+    }
+
+    void refill(RandomPool & pool)
+    {
+        const unsigned generation = processGeneration.load(std::memory_order_relaxed);
+        if( pool.generation != generation || pool.refillsSinceSeed >= POOL_RESEED_INTERVAL )
+        {
+            seed(pool, generation);
+        }
+
+        for(size_t block = 0; block < POOL_BYTES / CHACHA_BLOCK_BYTES; block++)
+        {
+            chachaBlock(pool, pool.blockCounter++, pool.buffer + block * CHACHA_BLOCK_BYTES);
+        }
+
+        pool.refillsSinceSeed++;
+        pool.offset = 0;
+    }
+}
+
+void sqlite3UuidRandomness(size_t count, void * out)
+{
+    RandomPool & pool = threadPool;
+    unsigned char * destination = reinterpret_cast<unsigned char *>(out);
+
+    // A fork since the last call invalidates whatever is left in the buffer
+    if( pool.generation != processGeneration.load(std::memory_order_relaxed) )
+    {
+        pool.offset = POOL_BYTES;
+    }
+
+    while( count > 0 )
+    {
+        if( pool.offset == POOL_BYTES )
+        {
+            refill(pool);
+        }
+
+        const size_t available = POOL_BYTES - pool.offset;
+        const size_t taken = count < available ? count : available;
+
+        memcpy(destination, pool.buffer + pool.offset, taken);
+        memset(pool.buffer + pool.offset, 0, taken);
+
+        pool.offset += taken;
+        destination += taken;
+        count -= taken;
+    }
+}
@@ -0,0 +1,508 @@
+/*
+** The uuid_series table-valued function generates UUIDs in bulk:
+**
+**     SELECT uuid, uuid_blob FROM uuid_series(N [, V])
+**
+** produces N rows, numbered by rowid from 1 to N, each holding a freshly generated UUID of version V (4, the default, or 7)
+** as both a string and a 16-byte blob. It is the bulk equivalent of calling uuid() once per row, for example
+**
+**     INSERT INTO t(id) SELECT uuid_blob FROM uuid_series(1e7)
+**
+** Rather than generating one UUID per row, the cursor fills a block of UUIDS_PER_BLOCK at a time from a single draw on the
+** randomness pool, and formats the whole block into text at once, and only when the uuid column is actually read.
+**
+** Constraints on rowid are pushed down through xBestIndex, and so are LIMIT/OFFSET unless the rows are to be sorted by
+** something other than rowid, so only the rows that will be returned are generated.
+*/
+
+#include "sqlite_extensions/uuidseries.hpp"
+SQLITE_EXTENSION_INIT3
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    const int UUIDS_PER_BLOCK = 256;
+
+    enum SeriesColumn
+    {
+        SERIES_COLUMN_UUID = 0,
+        SERIES_COLUMN_UUID_BLOB,
+        SERIES_COLUMN_COUNT,
+        SERIES_COLUMN_VERSION
+    };
+
+    // Bits of idxNum, saying which arguments xFilter receives, in this order
+    enum SeriesPlan
+    {
+        SERIES_PLAN_COUNT = 0x01,
+        SERIES_PLAN_VERSION = 0x02,
+        SERIES_PLAN_ROWID_EQ = 0x04,
+        SERIES_PLAN_ROWID_LOWER = 0x08,
+        SERIES_PLAN_ROWID_UPPER = 0x10,
+        SERIES_PLAN_LIMIT = 0x20,
+        SERIES_PLAN_OFFSET = 0x40
+    };
+
+    // Bits of idxStr, saying whether the matching rowid bound is exclusive
+    enum SeriesBoundFlags
+    {
+        SERIES_LOWER_EXCLUSIVE = 0x01,
+        SERIES_UPPER_EXCLUSIVE = 0x02
+    };
+
+    struct SeriesTable
+    {
+        sqlite3_vtab base;
+        Uuid7State * state;
+    };
+
+    struct SeriesCursor
+    {
+        sqlite3_vtab_cursor base;
+        Uuid7State * state;
+        int version;
+        sqlite3_int64 rowid;
+        sqlite3_int64 lastRowid;
+        sqlite3_int64 blockFirstRowid;
+        int blockCount;
+        bool blockFormatted;
+        unsigned char bytes[16 * UUIDS_PER_BLOCK];
+        unsigned char text[36 * UUIDS_PER_BLOCK];
+    };
+
+    int seriesConnect(sqlite3 * db, void * pAux, int argc, const char * const * argv, sqlite3_vtab ** ppVtab, char ** pzErr)
+    {
+        (void)argc;
+        (void)argv;
+        (void)pzErr;
+
+        int returnCode = sqlite3_declare_vtab(db, "CREATE TABLE x(uuid TEXT, uuid_blob BLOB, n HIDDEN, version HIDDEN)");
+        if( returnCode != SQLITE_OK )
+        {
+            return returnCode;
+        }
+
+        SeriesTable * table = reinterpret_cast<SeriesTable *>(sqlite3_malloc(sizeof(SeriesTable)));
+        if( table == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        memset(table, 0, sizeof(SeriesTable));
+        table->state = reinterpret_cast<Uuid7State *>(pAux);
+        sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+
+        *ppVtab = &table->base;
+        return SQLITE_OK;
+    }
+
+    int seriesDisconnect(sqlite3_vtab * pVtab)
+    {
+        sqlite3_free(pVtab);
+        return SQLITE_OK;
+    }
+
+    int seriesOpen(sqlite3_vtab * pVtab, sqlite3_vtab_cursor ** ppCursor)
+    {
+        SeriesCursor * cursor = reinterpret_cast<SeriesCursor *>(sqlite3_malloc(sizeof(SeriesCursor)));
+        if( cursor == nullptr )
+        {
+            return SQLITE_NOMEM;
+        }
+
+        cursor->state = reinterpret_cast<SeriesTable *>(pVtab)->state;
+        cursor->version = 4;
+        cursor->rowid = 1;
+        cursor->lastRowid = 0;
+        cursor->blockFirstRowid = 1;
+        cursor->blockCount = 0;
+        cursor->blockFormatted = false;
+
+        *ppCursor = &cursor->base;
+        return SQLITE_OK;
+    }
+
+    int seriesClose(sqlite3_vtab_cursor * pCursor)
+    {
+        sqlite3_free(pCursor);
+        return SQLITE_OK;
+    }
+
+    /*
+    * Generates the block of UUIDs starting at the cursor's current rowid
+    */
+    void seriesFillBlock(SeriesCursor * cursor)
+    {
+        const sqlite3_int64 remaining = cursor->lastRowid - cursor->rowid + 1;
+        cursor->blockCount = remaining < UUIDS_PER_BLOCK ? static_cast<int>(remaining) : UUIDS_PER_BLOCK;
+        cursor->blockFirstRowid = cursor->rowid;
+        cursor->blockFormatted = false;
+
+        if( cursor->version == 7 )
+        {
+            sqlite3UuidV7Generate(cursor->state, cursor->bytes, static_cast<size_t>(cursor->blockCount));
+        }
+        else
+        {
+            sqlite3UuidV4Generate(cursor->bytes, static_cast<size_t>(cursor->blockCount));
+        }
+    }
+
+    int seriesNext(sqlite3_vtab_cursor * pCursor)
+    {
+        SeriesCursor * cursor = reinterpret_cast<SeriesCursor *>(pCursor);
+
+        cursor->rowid++;
+        if( cursor->rowid <= cursor->lastRowid && cursor->rowid - cursor->blockFirstRowid >= cursor->blockCount )
+        {
+            seriesFillBlock(cursor);
+        }
+
+        return SQLITE_OK;
+    }
+
+    int seriesEof(sqlite3_vtab_cursor * pCursor)
+    {
+        SeriesCursor * cursor = reinterpret_cast<SeriesCursor *>(pCursor);
+        return cursor->rowid > cursor->lastRowid;
+    }
+
+    int seriesColumn(sqlite3_vtab_cursor * pCursor, sqlite3_context * context, int column)
+    {
+        SeriesCursor * cursor = reinterpret_cast<SeriesCursor *>(pCursor);
+        const sqlite3_int64 blockIndex = cursor->rowid - cursor->blockFirstRowid;
+
+        switch( column )
+        {
+            case SERIES_COLUMN_UUID:
+            {
+                if( !cursor->blockFormatted )
+                {
+                    sqlite3UuidBlobsToStrs(cursor->bytes, static_cast<size_t>(cursor->blockCount), cursor->text);
+                    cursor->blockFormatted = true;
+                }
+
+                sqlite3_result_text(context, reinterpret_cast<char *>(cursor->text + 36 * blockIndex), 36, SQLITE_TRANSIENT);
+                break;
+            }
+            case SERIES_COLUMN_UUID_BLOB:
+            {
+                sqlite3_result_blob(context, cursor->bytes + 16 * blockIndex, 16, SQLITE_TRANSIENT);
+                break;
+            }
+            case SERIES_COLUMN_COUNT:
+            {
+                sqlite3_result_int64(context, cursor->lastRowid);
+                break;
+            }
+            default:
+            {
+                sqlite3_result_int(context, cursor->version);
+                break;
+            }
+        }
+
+        return SQLITE_OK;
+    }
+
+    int seriesRowid(sqlite3_vtab_cursor * pCursor, sqlite_int64 * pRowid)
+    {
+        *pRowid = reinterpret_cast<SeriesCursor *>(pCursor)->rowid;
+        return SQLITE_OK;
+    }
+
+    /*
+    * Works out which rows to generate from the arguments and any pushed down constraints, then generates the first block
+    */
+    int seriesFilter(sqlite3_vtab_cursor * pCursor, int idxNum, const char * idxStr, int argc, sqlite3_value ** argv)
+    {
+        SeriesCursor * cursor = reinterpret_cast<SeriesCursor *>(pCursor);
+        const int boundFlags = idxStr ? idxStr[0] - '0' : 0;
+        int argIndex = 0;
+        (void)argc;
+
+        sqlite3_int64 count = 0;
+        sqlite3_int64 first = 1;
+        cursor->version = 4;
+
+        // Without a count xBestIndex only offers a plan too costly to be picked, so this is a query without one
+        if( !(idxNum & SERIES_PLAN_COUNT) )
+        {
+            sqlite3_free(pCursor->pVtab->zErrMsg);
+            pCursor->pVtab->zErrMsg = sqlite3_mprintf("uuid_series() requires the number of UUIDs to generate");
+            return SQLITE_ERROR;
+        }
+
+        count = sqlite3_value_int64(argv[argIndex++]);
+
+        if( idxNum & SERIES_PLAN_VERSION )
+        {
+            sqlite3_value * version = argv[argIndex++];
+            if( sqlite3_value_type(version) != SQLITE_NULL )
+            {
+                cursor->version = sqlite3_value_int(version);
+            }
+
+            if( cursor->version != 4 && cursor->version != 7 )
+            {
+                sqlite3_free(pCursor->pVtab->zErrMsg);
+                pCursor->pVtab->zErrMsg = sqlite3_mprintf("uuid_series() can only generate version 4 or 7 UUIDs");
+                return SQLITE_ERROR;
+            }
+        }
+
+        sqlite3_int64 last = count;
+
+        if( idxNum & SERIES_PLAN_ROWID_EQ )
+        {
+            const sqlite3_int64 rowid = sqlite3_value_int64(argv[argIndex++]);
+            if( rowid > first )
+            {
+                first = rowid;
+            }
+            if( rowid < last )
+            {
+                last = rowid;
+            }
+        }
+
+        if( idxNum & SERIES_PLAN_ROWID_LOWER )
+        {
+            sqlite3_int64 lower = sqlite3_value_int64(argv[argIndex++]);
+            if( boundFlags & SERIES_LOWER_EXCLUSIVE )
+            {
+                lower = lower < INT64_MAX ? lower + 1 : lower;
+            }
+            if( lower > first )
+            {
+                first = lower;
+            }
+        }
+
+        if( idxNum & SERIES_PLAN_ROWID_UPPER )
+        {
+            sqlite3_int64 upper = sqlite3_value_int64(argv[argIndex++]);
+            if( boundFlags & SERIES_UPPER_EXCLUSIVE )
+            {
+                upper = upper > INT64_MIN ? upper - 1 : upper;
+            }
+            if( upper < last )
+            {
+                last = upper;
+            }
+        }
+
+        // OFFSET is consumed here, after the rowid constraints. LIMIT only saves work, sqlite still applies it.
+        sqlite3_int64 limit = -1;
+        if( idxNum & SERIES_PLAN_LIMIT )
+        {
+            limit = sqlite3_value_int64(argv[argIndex++]);
+        }
+
+        if( idxNum & SERIES_PLAN_OFFSET )
+        {
+            const sqlite3_int64 offset = sqlite3_value_int64(argv[argIndex++]);
+            if( offset > 0 )
+            {
+                first = offset < last - first + 1 ? first + offset : last + 1;
+            }
+        }
+
+        if( limit >= 0 && limit < last - first + 1 )
+        {
+            last = first + limit - 1;
+        }
+
+        cursor->rowid = first;
+        cursor->lastRowid = last;
+        cursor->blockCount = 0;
+
+        if( cursor->rowid <= cursor->lastRowid )
+        {
+            seriesFillBlock(cursor);
+        }
+
+        return SQLITE_OK;
+    }
+
+    /*
+    * The count argument is required. The version, rowid bounds, LIMIT and OFFSET are all optional.
+    * Arguments are handed to xFilter in the order of the SeriesPlan bits.
+    *
+    * sqlite also asks for plans without the count, for one term of an OR for instance, so a missing count is not an error
+    * here: that plan is given a cost no other plan exceeds, and xFilter reports the error if it is ever run.
+    */
+    int seriesBestIndex(sqlite3_vtab * pVtab, sqlite3_index_info * pIdxInfo)
+    {
+        (void)pVtab;
+
+        enum { COUNT = 0, VERSION, ROWID_EQ, ROWID_LOWER, ROWID_UPPER, LIMIT, OFFSET, SLOTS };
+        int constraintFor[SLOTS];
+        int boundFlags = 0;
+        bool countUnusable = false;
+
+        for(int slot = 0; slot < SLOTS; slot++)
+        {
+            constraintFor[slot] = -1;
+        }
+
+        for(int i = 0; i < pIdxInfo->nConstraint; i++)
+        {
+            const sqlite3_index_info::sqlite3_index_constraint & constraint = pIdxInfo->aConstraint[i];
+
+            if( constraint.op == SQLITE_INDEX_CONSTRAINT_LIMIT || constraint.op == SQLITE_INDEX_CONSTRAINT_OFFSET )
+            {
+                if( constraint.usable )
+                {
+                    constraintFor[constraint.op == SQLITE_INDEX_CONSTRAINT_LIMIT ? LIMIT : OFFSET] = i;
+                }
+                continue;
+            }
+
+            if( constraint.iColumn == SERIES_COLUMN_COUNT && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ )
+            {
+                if( !constraint.usable )
+                {
+                    countUnusable = true;
+                }
+                else
+                {
+                    constraintFor[COUNT] = i;
+                }
+            }
+            else if( constraint.iColumn == SERIES_COLUMN_VERSION && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ && constraint.usable )
+            {
+                constraintFor[VERSION] = i;
+            }
+            else if( constraint.iColumn < 0 && constraint.usable )
+            {
+                switch( constraint.op )
+                {
+                    case SQLITE_INDEX_CONSTRAINT_EQ:
+                        constraintFor[ROWID_EQ] = i;
+                        break;
+                    case SQLITE_INDEX_CONSTRAINT_GT:
+                        constraintFor[ROWID_LOWER] = i;
+                        boundFlags |= SERIES_LOWER_EXCLUSIVE;
+                        break;
+                    case SQLITE_INDEX_CONSTRAINT_GE:
+                        constraintFor[ROWID_LOWER] = i;
+                        boundFlags &= ~SERIES_LOWER_EXCLUSIVE;
+                        break;
+                    case SQLITE_INDEX_CONSTRAINT_LT:
+                        constraintFor[ROWID_UPPER] = i;
+                        boundFlags |= SERIES_UPPER_EXCLUSIVE;
+                        break;
+                    case SQLITE_INDEX_CONSTRAINT_LE:
+                        constraintFor[ROWID_UPPER] = i;
+                        boundFlags &= ~SERIES_UPPER_EXCLUSIVE;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        if( constraintFor[COUNT] < 0 )
+        {
+            // A count that depends on another table in a join has to wait for a plan that supplies it
+            if( countUnusable )
+            {
+                return SQLITE_CONSTRAINT;
+            }
+
+            pIdxInfo->idxNum = 0;
+            pIdxInfo->estimatedCost = 2147483647.0;
+            pIdxInfo->estimatedRows = 2147483647;
+            return SQLITE_OK;
+        }
+
+        // Rows come out in rowid order. LIMIT and OFFSET count rows in the order they are returned, so they can only be
+        // used when sqlite wants them in that order, or in none, rather than sorting them afterwards.
+        const bool rowidOrder = pIdxInfo->nOrderBy == 1 && pIdxInfo->aOrderBy[0].iColumn < 0 && !pIdxInfo->aOrderBy[0].desc;
+        if( pIdxInfo->nOrderBy > 0 && !rowidOrder )
+        {
+            constraintFor[LIMIT] = -1;
+            constraintFor[OFFSET] = -1;
+        }
+
+        int argvIndex = 0;
+        int idxNum = 0;
+        for(int slot = 0; slot < SLOTS; slot++)
+        {
+            if( constraintFor[slot] >= 0 )
+            {
+                pIdxInfo->aConstraintUsage[constraintFor[slot]].argvIndex = ++argvIndex;
+                pIdxInfo->aConstraintUsage[constraintFor[slot]].omit = 1;
+                idxNum |= 1 << slot;
+            }
+        }
+
+        // OFFSET can only be consumed if every other constraint is, otherwise rows would be skipped before sqlite filtered them
+        for(int i = 0; i < pIdxInfo->nConstraint; i++)
+        {
+            const sqlite3_index_info::sqlite3_index_constraint & constraint = pIdxInfo->aConstraint[i];
+            if( constraint.op != SQLITE_INDEX_CONSTRAINT_LIMIT && constraint.op != SQLITE_INDEX_CONSTRAINT_OFFSET
+                && pIdxInfo->aConstraintUsage[i].argvIndex == 0 && (idxNum & SERIES_PLAN_OFFSET) )
+            {
+                pIdxInfo->aConstraintUsage[constraintFor[OFFSET]].omit = 0;
+                break;
+            }
+        }
+
+        pIdxInfo->idxNum = idxNum;
+        pIdxInfo->idxStr = sqlite3_mprintf("%d", boundFlags);
+        pIdxInfo->needToFreeIdxStr = 1;
+
+        if( rowidOrder )
+        {
+            pIdxInfo->orderByConsumed = 1;
+        }
+
+        const bool rowidBounded = (idxNum & (SERIES_PLAN_ROWID_EQ | SERIES_PLAN_ROWID_LOWER | SERIES_PLAN_ROWID_UPPER | SERIES_PLAN_LIMIT)) != 0;
+        pIdxInfo->estimatedCost = rowidBounded ? 10.0 : 1000.0;
+        pIdxInfo->estimatedRows = (idxNum & SERIES_PLAN_ROWID_EQ) ? 1 : (rowidBounded ? 10 : 1000);
+        if( idxNum & SERIES_PLAN_ROWID_EQ )
+        {
+            pIdxInfo->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+        }
+
+        return SQLITE_OK;
+    }
+
+    sqlite3_module seriesModule = {
+        0,                  // iVersion
+        0,                  // xCreate - eponymous only
+        seriesConnect,      // xConnect
+        seriesBestIndex,    // xBestIndex
+        seriesDisconnect,   // xDisconnect
+        0,                  // xDestroy
+        seriesOpen,         // xOpen
+        seriesClose,        // xClose
+        seriesFilter,       // xFilter
+        seriesNext,         // xNext
+        seriesEof,          // xEof
+        seriesColumn,       // xColumn
+        seriesRowid,        // xRowid
+        0,                  // xUpdate
+        0,                  // xBegin
+        0,                  // xSync
+        0,                  // xCommit
+        0,                  // xRollback
+        0,                  // xFindFunction
+        0,                  // xRename
+        0,                  // xSavepoint
+        0,                  // xRelease
+        0,                  // xRollbackTo
+        0                   // xShadowName
+    };
+}
+
+int sqlite3UuidSeriesInit(sqlite3 * db, Uuid7State * state)
+{
+    return sqlite3_create_module_v2(db, "uuid_series", &seriesModule, state, sqlite3Uuid7StateRelease);
+}
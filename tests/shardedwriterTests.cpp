@@ -0,0 +1,197 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuid.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "shardedwriter.hpp"
+#include "sqlitehelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    /*
+    * A fresh directory for the shard databases, removed again at the end of the test
+    */
+    struct ShardDirectory
+    {
+        std::filesystem::path path;
+
+        ShardDirectory()
+            : path(std::filesystem::temp_directory_path() / ("shardedwriter-" + randomUuid().toString()))
+        {
+            std::filesystem::create_directories(path);
+        }
+
+        ~ShardDirectory()
+        {
+            std::filesystem::remove_all(path);
+        }
+
+        static Uuid randomUuid()
+        {
+            Uuid uuid;
+            Uuid::generate({&uuid, 1});
+            return uuid;
+        }
+    };
+
+    /*
+    * A random UUID that uuid_shard() puts on the given shard
+    */
+    Uuid uuidOnShard(int shard, int shards)
+    {
+        Uuid uuid;
+        do
+        {
+            Uuid::generate({&uuid, 1});
+        }
+        while( sqlite3UuidShard(uuid.bytes.data(), shards) != shard );
+        return uuid;
+    }
+}
+
+TEST_CASE("The sharded writer routes rows by uuid_shard() and merges what it reads back", "[shardedwriter]")
+{
+    registerUuidExtension();
+
+    ShardDirectory directory;
+    const std::string basePath = (directory.path / "users").string();
+    const int shards = 4;
+
+    SECTION("Every row is written to the shard uuid_shard() gives, and is there after flush()")
+    {
+        std::vector<Uuid> uuids(1000);
+        Uuid::generate(uuids);
+        {
+            ShardedWriter writer(basePath, shards, "CREATE TABLE IF NOT EXISTS users(id BLOB PRIMARY KEY, name TEXT NOT NULL)",
+                "INSERT INTO users VALUES (?1, ?2)");
+
+            for(size_t uuidIndex = 0; uuidIndex < uuids.size(); uuidIndex++)
+            {
+                writer.insert(uuids[uuidIndex], {std::string("user") + std::to_string(uuidIndex)});
+            }
+            writer.flush();
+
+            int64_t total = 0;
+            for( const SqlRow & row : writer.query("SELECT count(*) FROM users") )
+            {
+                total += std::get<int64_t>(row[0]);
+            }
+            REQUIRE( total == 1000 );
+        }
+
+        for(int shard = 0; shard < shards; shard++)
+        {
+            sqlite3 * db = open_database(basePath + "-" + std::to_string(shard) + ".db");
+            REQUIRE( queryInt(db, "SELECT count(*) FROM users") > 0 );
+            REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE uuid_shard(id, 4) <> " + std::to_string(shard)) == 0 );
+            sqlite3_close(db);
+        }
+    }
+
+    SECTION("Integers and reals from different shards merge in order of value, as sqlite orders them")
+    {
+        ShardedWriter writer(basePath, 2, "CREATE TABLE IF NOT EXISTS scores(id BLOB PRIMARY KEY, score)", "INSERT INTO scores VALUES (?1, ?2)");
+
+        const std::vector<SqlValue> scores = {
+            int64_t(1), 1.5, int64_t(2), -0.5, int64_t(-1), 2.5, std::monostate(), std::string("b"), int64_t(9007199254740993),
+            9007199254740992.0, std::vector<unsigned char>{0x01}, std::string("a"), int64_t(3), 0.25, std::monostate(), int64_t(0)
+        };
+        for(size_t scoreIndex = 0; scoreIndex < scores.size(); scoreIndex++)
+        {
+            writer.insert(uuidOnShard(static_cast<int>(scoreIndex % 2), 2), {scores[scoreIndex]});
+        }
+        writer.flush();
+
+        // The order sqlite gives them all in one table
+        sqlite3 * db = open_database(":memory:");
+        exec(db, "CREATE TABLE scores(score)");
+        Statement insert(db, "INSERT INTO scores VALUES (?)");
+        for( const SqlValue & score : scores )
+        {
+            switch( score.index() )
+            {
+                case 0: sqlite3_bind_null(insert.handle(), 1); break;
+                case 1: insert.bind(1, static_cast<sqlite3_int64>(std::get<int64_t>(score))); break;
+                case 2: sqlite3_bind_double(insert.handle(), 1, std::get<double>(score)); break;
+                case 3: insert.bind(1, std::get<std::string>(score)); break;
+                default: sqlite3_bind_blob(insert.handle(), 1, std::get<std::vector<unsigned char>>(score).data(), 1, SQLITE_TRANSIENT); break;
+            }
+            insert.step();
+            insert.reset();
+        }
+
+        std::vector<SqlValue> expected;
+        Statement ordered(db, "SELECT score FROM scores ORDER BY score");
+        while( ordered.step() )
+        {
+            if( ordered.columnIsNull(0) )
+            {
+                expected.push_back(std::monostate());
+            }
+            else if( sqlite3_column_type(ordered.handle(), 0) == SQLITE_INTEGER )
+            {
+                expected.push_back(static_cast<int64_t>(ordered.columnInt(0)));
+            }
+            else if( sqlite3_column_type(ordered.handle(), 0) == SQLITE_FLOAT )
+            {
+                expected.push_back(sqlite3_column_double(ordered.handle(), 0));
+            }
+            else if( sqlite3_column_type(ordered.handle(), 0) == SQLITE_TEXT )
+            {
+                expected.push_back(ordered.columnText(0));
+            }
+            else
+            {
+                expected.push_back(std::vector<unsigned char>{0x01});
+            }
+        }
+
+        std::vector<SqlValue> merged;
+        for( SqlRow & row : writer.query("SELECT score FROM scores ORDER BY score", 0) )
+        {
+            merged.push_back(row[0]);
+        }
+
+        REQUIRE( merged.size() == scores.size() );
+        REQUIRE( merged == expected );
+
+        sqlite3_close(db);
+    }
+
+    SECTION("A row that fails to insert is rethrown by the next insert(), once")
+    {
+        ShardedWriter writer(basePath, 1, "CREATE TABLE IF NOT EXISTS users(id BLOB PRIMARY KEY, name TEXT NOT NULL)",
+            "INSERT INTO users VALUES (?1, ?2)");
+
+        writer.insert(uuidOnShard(0, 1), {std::monostate()});
+
+        // The writer thread fails the row in the background, so insert until it has
+        bool rethrown = false;
+        for(int attempt = 0; attempt < 5000 && !rethrown; attempt++)
+        {
+            try
+            {
+                writer.insert(uuidOnShard(0, 1), {std::string("user")});
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            catch( const std::runtime_error & e )
+            {
+                rethrown = std::string(e.what()).find("NOT NULL") != std::string::npos;
+            }
+        }
+        REQUIRE( rethrown );
+
+        REQUIRE_NOTHROW( writer.insert(uuidOnShard(0, 1), {std::string("user")}) );
+        REQUIRE_NOTHROW( writer.flush() );
+    }
+}
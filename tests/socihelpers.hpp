@@ -0,0 +1,59 @@
+#ifndef TESTS_SOCI_HELPERS_HPP
+#define TESTS_SOCI_HELPERS_HPP
+
+#include "catch/catch.hpp"
+
+#include <soci/soci.h>
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+/*
+* Runs test against a new in-memory database in each text encoding sqlite has, or in only the ones given. Each encoding
+* is a section of its own, so sections inside test are run in every encoding rather than only the first.
+*/
+inline void forEachEncoding(const std::function<void(soci::session &)> & test,
+    std::initializer_list<const char *> encodings = {"UTF-8", "UTF-16le", "UTF-16be"})
+{
+    for( const std::string encoding : encodings )
+    {
+        DYNAMIC_SECTION("In a " << encoding << " database")
+        {
+            soci::session session("sqlite3", ":memory:");
+            session << "PRAGMA encoding = '" + encoding + "'";
+
+            std::string actualEncoding;
+            session << "PRAGMA encoding", soci::into(actualEncoding);
+            REQUIRE( actualEncoding == encoding );
+
+            test(session);
+        }
+    }
+}
+
+/*
+* Requires each of statements to fail
+*/
+inline void requireRejected(soci::session & session, std::initializer_list<const char *> statements)
+{
+    for( const char * statement : statements )
+    {
+        INFO(statement);
+        REQUIRE_THROWS_AS((session << statement), soci::soci_error);
+    }
+}
+
+/*
+* Requires the first column of the row statement returns to be NULL
+*/
+inline void requireNull(soci::session & session, const std::string & statement)
+{
+    INFO(statement);
+    std::string value;
+    soci::indicator indicator = soci::i_ok;
+    session << statement, soci::into(value, indicator);
+    REQUIRE( indicator == soci::i_null );
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuid.hpp"
+#include "sqlitehelpers.hpp"
+#include "testhelpers.hpp"
+#include "uuidsoci.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("Statements bind and read UUIDs as blobs", "[sqlitehelpers]")
+{
+    registerUuidExtension();
+
+    sqlite3 * db = open_database(":memory:");
+    exec(db, "CREATE TABLE users(id BLOB PRIMARY KEY)");
+
+    SECTION("A bound Uuid is stored as a 16-byte blob and read back as the same Uuid")
+    {
+        Uuid uuid;
+        Uuid::generate({&uuid, 1});
+
+        Statement insert(db, "INSERT INTO users VALUES (?1)");
+        insert.bind(1, uuid);
+        insert.step();
+
+        Statement select(db, "SELECT id, typeof(id), length(id), uuid_str(id) FROM users");
+        REQUIRE( select.step() );
+        REQUIRE( select.columnUuid(0) == uuid );
+        REQUIRE( select.columnText(1) == "blob" );
+        REQUIRE( select.columnInt(2) == 16 );
+        REQUIRE( select.columnText(3) == uuid.toString() );
+    }
+
+    SECTION("A bound span of Uuids is inserted in one step through uuid_carray(), and read back in order")
+    {
+        std::vector<Uuid> uuids(1000);
+        Uuid::generate(uuids);
+
+        Statement insert(db, "INSERT INTO users SELECT uuid_blob FROM uuid_carray(?1)");
+        insert.bind(1, std::span<const Uuid>(uuids));
+        REQUIRE_FALSE( insert.step() );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users") == 1000 );
+
+        // An empty span inserts nothing
+        insert.reset();
+        insert.bind(1, std::span<const Uuid>());
+        REQUIRE_FALSE( insert.step() );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users") == 1000 );
+
+        std::vector<Uuid> keys;
+        Statement select(db, "SELECT id FROM users ORDER BY id");
+        read_uuids(select, 0, keys);
+
+        std::sort(uuids.begin(), uuids.end());
+        REQUIRE( keys == uuids );
+    }
+
+    SECTION("Reading anything but a 16-byte blob as a Uuid throws")
+    {
+        Statement select(db, "SELECT 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11', NULL, x'a0eebc999c0b4ef8bb6d6bb9bd380a', randomblob(16)");
+        REQUIRE( select.step() );
+        REQUIRE_THROWS_AS( select.columnUuid(0), std::runtime_error );
+        REQUIRE_THROWS_AS( select.columnUuid(1), std::runtime_error );
+        REQUIRE_THROWS_AS( select.columnUuid(2), std::runtime_error );
+        REQUIRE_NOTHROW( select.columnUuid(3) );
+    }
+
+    sqlite3_close(db);
+}
+
+TEST_CASE("Uuids go through soci one row at a time", "[sqlitehelpers]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+    session << "CREATE TABLE users(id BLOB PRIMARY KEY)";
+
+    // Has a zero byte in the middle, which would cut a raw std::string short
+    const Uuid uuid = *Uuid::fromString("a0eebc99-9c0b-4ef8-0000-6bb9bd380a11");
+    session << "INSERT INTO users VALUES (uuid_blob(:id))", soci::use(uuid);
+
+    std::string type;
+    Uuid read;
+    session << "SELECT typeof(id) FROM users", soci::into(type);
+    session << "SELECT uuid_str(id) FROM users", soci::into(read);
+    REQUIRE( type == "blob" );
+    REQUIRE( read == uuid );
+
+    REQUIRE_THROWS_AS((session << "SELECT 'not a guid'", soci::into(read)), soci::soci_error);
+}
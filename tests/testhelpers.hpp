@@ -0,0 +1,36 @@
+#ifndef TESTS_TEST_HELPERS_HPP
+#define TESTS_TEST_HELPERS_HPP
+
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlitehelpers.hpp"
+
+#include <sqlite3.h>
+
+#include <string>
+
+/*
+* Registers the UUID extension with every connection opened from now on
+*
+* Sqlite does something very odd where they require you to make an extension registration function that returns an int and takes three params,
+* while also requiring you to pass it as a function that returns void and takes none. See https://www.sqlite.org/c3ref/auto_extension.html
+*/
+inline void registerUuidExtension()
+{
+    typedef void(*pfnInitExtensionFunction)(void);
+    pfnInitExtensionFunction init = (pfnInitExtensionFunction)sqlite3_uuid_init;
+    sqlite3_auto_extension(init);
+}
+
+/*
+* Runs sql on a connection and returns the first column of its first row as an integer
+*/
+inline sqlite3_int64 queryInt(sqlite3 * db, const std::string & sql)
+{
+    Statement statement(db, sql);
+    REQUIRE( statement.step() );
+    return statement.columnInt(0);
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/ulid.hpp"
+#include "sqlite_extensions/uuidext.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("The ULID base32 kernels match the scalar reference", "[ulid]")
+{
+    std::mt19937 generator(20240305);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    // The example from the ULID spec
+    const unsigned char bytes[16] = {0x01, 0x56, 0x3e, 0x3a, 0xb5, 0xd3, 0xd6, 0x76, 0x4c, 0x61, 0xef, 0xb9, 0x93, 0x02, 0xbd, 0x5b};
+    const std::string text = "01ARZ3NDEKTSV4RRFFQ69G5FAV";
+
+    for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+    {
+        INFO("SIMD level " << level);
+        const UuidSimdLevel simdLevel = static_cast<UuidSimdLevel>(level);
+
+        SECTION("Known values convert both ways")
+        {
+            unsigned char result[27] = {};
+            sqlite3UlidBlobToStrWith(simdLevel, bytes, result);
+            REQUIRE( std::string(reinterpret_cast<char *>(result)) == text );
+
+            unsigned char out[16];
+            REQUIRE( sqlite3UlidStrToBlobWith(simdLevel, reinterpret_cast<const unsigned char *>(text.data()), text.size(), out) == 0 );
+            REQUIRE( memcmp(out, bytes, 16) == 0 );
+
+            const std::string aliased = "0iarz3ndektsv4rrffq69g5fav";
+            REQUIRE( sqlite3UlidStrToBlobWith(simdLevel, reinterpret_cast<const unsigned char *>(aliased.data()), aliased.size(), out) == 0 );
+            REQUIRE( memcmp(out, bytes, 16) == 0 );
+        }
+
+        SECTION("Random values round trip, and every kernel agrees on every corrupted character")
+        {
+            for(int ulidIndex = 0; ulidIndex < 1000; ulidIndex++)
+            {
+                unsigned char random[16];
+                for( unsigned char & byte : random )
+                {
+                    byte = static_cast<unsigned char>(distribution(generator));
+                }
+
+                unsigned char encoded[26];
+                unsigned char expected[26];
+                sqlite3UlidBlobToStrWith(simdLevel, random, encoded);
+                sqlite3UlidBlobToStrWith(UUID_SIMD_SCALAR, random, expected);
+                REQUIRE( memcmp(encoded, expected, 26) == 0 );
+
+                unsigned char out[16];
+                REQUIRE( sqlite3UlidStrToBlobWith(simdLevel, encoded, 26, out) == 0 );
+                REQUIRE( memcmp(out, random, 16) == 0 );
+
+                unsigned char corrupted[26];
+                memcpy(corrupted, encoded, 26);
+                corrupted[ulidIndex % 26] = static_cast<unsigned char>(distribution(generator));
+                unsigned char scalarOut[16];
+                const int scalarResult = sqlite3UlidStrToBlobWith(UUID_SIMD_SCALAR, corrupted, 26, scalarOut);
+                REQUIRE( sqlite3UlidStrToBlobWith(simdLevel, corrupted, 26, out) == scalarResult );
+                if( scalarResult == 0 )
+                {
+                    REQUIRE( memcmp(out, scalarOut, 16) == 0 );
+                }
+            }
+        }
+
+        SECTION("Malformed input is rejected")
+        {
+            unsigned char out[16];
+            const char * malformed[] = {
+                "01ARZ3NDEKTSV4RRFFQ69G5FA",
+                "01ARZ3NDEKTSV4RRFFQ69G5FAVV",
+                "01ARZ3NDEKTSV4RRFFQ69G5FAU",
+                "01ARZ3NDEKTSV4RRFFQ69G5-AV",
+                "80000000000000000000000000"
+            };
+
+            for( const std::string form : malformed )
+            {
+                INFO(form);
+                REQUIRE( sqlite3UlidStrToBlobWith(simdLevel, reinterpret_cast<const unsigned char *>(form.data()), form.size(), out) != 0 );
+            }
+        }
+    }
+}
+
+TEST_CASE("ULIDs are generated in order", "[ulid]")
+{
+    UlidState * state = sqlite3UlidStateCreate(1);
+    REQUIRE( state != nullptr );
+
+    SECTION("A batch is strictly increasing, as bytes and as text")
+    {
+        std::vector<unsigned char> bytes(16 * 10000);
+        sqlite3UlidGenerate(state, bytes.data(), 10000);
+
+        std::string previous;
+        for(size_t ulidIndex = 0; ulidIndex < 10000; ulidIndex++)
+        {
+            unsigned char text[26];
+            sqlite3UlidBlobToStr(bytes.data() + 16 * ulidIndex, text);
+            const std::string current(reinterpret_cast<char *>(text), 26);
+            if( ulidIndex > 0 )
+            {
+                REQUIRE( memcmp(bytes.data() + 16 * (ulidIndex - 1), bytes.data() + 16 * ulidIndex, 16) < 0 );
+                REQUIRE( previous < current );
+            }
+            previous = current;
+        }
+    }
+
+    SECTION("Running out of random values moves on to the next millisecond")
+    {
+        unsigned char first[16];
+        sqlite3UlidGenerate(state, first, 1);
+        state->lastMilliseconds += 1000;
+        state->randomHigh = 0xffff;
+        state->randomLow = UINT64_MAX;
+
+        unsigned char second[16];
+        sqlite3UlidGenerate(state, second, 1);
+        REQUIRE( state->lastMilliseconds == static_cast<int64_t>(((uint64_t(second[0]) << 40) | (uint64_t(second[1]) << 32) | (uint64_t(second[2]) << 24) |
+            (uint64_t(second[3]) << 16) | (uint64_t(second[4]) << 8) | second[5])) );
+        REQUIRE( memcmp(second + 6, "\0\0\0\0\0\0\0\0\0\0", 10) == 0 );
+    }
+
+    sqlite3UlidStateRelease(state);
+}
+
+TEST_CASE("The UUID SQlite extension converts between ULIDs and UUIDs", "[ulid]")
+{
+    registerUuidExtension();
+
+    forEachEncoding([](soci::session & session)
+    {
+        SECTION("Generated ULIDs are increasing text of 26 characters")
+        {
+            int count = 0;
+            int increasing = 0;
+            session << "CREATE TABLE ids(id TEXT)";
+            session << "INSERT INTO ids SELECT ulid() FROM uuid_series(10000)";
+            session << "SELECT count(*), sum(id > previous) FROM (SELECT id, lag(id) OVER (ORDER BY rowid) AS previous FROM ids)",
+                soci::into(count), soci::into(increasing);
+            REQUIRE( count == 10000 );
+            REQUIRE( increasing == 9999 );
+
+            int length = 0;
+            int blobLength = 0;
+            session << "SELECT length(ulid()), length(ulid_blob())", soci::into(length), soci::into(blobLength);
+            REQUIRE( length == 26 );
+            REQUIRE( blobLength == 16 );
+        }
+
+        SECTION("Conversions round trip")
+        {
+            std::string uuid;
+            std::string ulid;
+            session << "SELECT ulid_to_uuid('01arz3ndektsv4rrffq69g5fav'), uuid_to_ulid('{01563E3A-B5D3-D676-4C61-EFB99302BD5B}')", soci::into(uuid), soci::into(ulid);
+            REQUIRE( uuid == "01563e3a-b5d3-d676-4c61-efb99302bd5b" );
+            REQUIRE( ulid == "01ARZ3NDEKTSV4RRFFQ69G5FAV" );
+
+            int same = 0;
+            session << "SELECT count(*) FROM uuid_series(1000) WHERE ulid_to_uuid(uuid_to_ulid(uuid)) = uuid AND ulid_to_uuid(uuid_blob(uuid)) = uuid", soci::into(same);
+            REQUIRE( same == 1000 );
+        }
+
+        SECTION("Bad input is rejected")
+        {
+            requireRejected(session, {
+                "SELECT ulid_to_uuid('01ARZ3NDEKTSV4RRFFQ69G5FAU')",
+                "SELECT ulid_to_uuid('81ARZ3NDEKTSV4RRFFQ69G5FAV')",
+                "SELECT ulid_to_uuid(x'0156')",
+                "SELECT uuid_to_ulid('not a guid')"
+            });
+        }
+    });
+}
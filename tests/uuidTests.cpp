@@ -0,0 +1,144 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuid.hpp"
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+
+namespace
+{
+    constexpr Uuid EXAMPLE = *Uuid::fromString("A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11");
+
+    constexpr std::array<char, Uuid::TEXT_LENGTH> formatAtCompileTime(const Uuid & uuid)
+    {
+        std::array<char, Uuid::TEXT_LENGTH> text = {};
+        uuid.toChars(text.data(), text.data() + text.size());
+        return text;
+    }
+
+    // Parsed and formatted entirely by the compiler
+    static_assert(EXAMPLE.bytes[0] == 0xa0 && EXAMPLE.bytes[15] == 0x11 && EXAMPLE.version() == 4);
+    static_assert(std::string_view(formatAtCompileTime(EXAMPLE).data(), Uuid::TEXT_LENGTH) == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+    static_assert(!Uuid::fromString("a0eebc999c0b4ef8bb6d6bb9bd380a11"));
+    static_assert(!Uuid::fromString("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1g"));
+    static_assert(Uuid().isNil() && Uuid() < EXAMPLE);
+}
+
+TEST_CASE("Uuid values parse, format, compare and hash", "[uuid]")
+{
+    SECTION("Parsing and formatting at run time match the compiler, and allocate nothing")
+    {
+        const std::optional<Uuid> parsed = Uuid::fromString("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+        REQUIRE( parsed );
+        REQUIRE( *parsed == EXAMPLE );
+
+        char text[40];
+        memset(text, 'x', sizeof(text));
+        const std::to_chars_result result = EXAMPLE.toChars(text, text + sizeof(text));
+        REQUIRE( result.ec == std::errc() );
+        REQUIRE( result.ptr == text + 36 );
+        REQUIRE( std::string(text, result.ptr) == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+        REQUIRE( text[36] == 'x' );
+
+        REQUIRE( EXAMPLE.toChars(text, text + 35).ec == std::errc::value_too_large );
+        REQUIRE( EXAMPLE.toString() == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+    }
+
+    SECTION("Only the canonical form is accepted")
+    {
+        const char * rejected[] = {
+            "",
+            "a0eebc999c0b4ef8bb6d6bb9bd380a11",
+            "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a111",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1g",
+            "a0eebc99x9c0b-4ef8-bb6d-6bb9bd380a11",
+            "a0eebc9-99c0b-4ef8-bb6d-6bb9bd380a11",
+            "oO7svJwLTvi7bWu5vTgKEQ"
+        };
+        for( const char * text : rejected )
+        {
+            INFO(text);
+            REQUIRE_FALSE( Uuid::fromString(text) );
+        }
+    }
+
+    SECTION("Ordering is the order of the bytes, and hashing is uuid_hash64()")
+    {
+        std::vector<Uuid> uuids(1000);
+        Uuid::generate(uuids);
+        std::sort(uuids.begin(), uuids.end());
+        for(size_t uuidIndex = 1; uuidIndex < uuids.size(); uuidIndex++)
+        {
+            REQUIRE( memcmp(uuids[uuidIndex - 1].bytes.data(), uuids[uuidIndex].bytes.data(), 16) < 0 );
+        }
+
+        REQUIRE( std::hash<Uuid>()(EXAMPLE) == sqlite3UuidHash64(EXAMPLE.bytes.data()) );
+
+        const std::unordered_set<Uuid> distinct(uuids.begin(), uuids.end());
+        REQUIRE( distinct.size() == uuids.size() );
+        REQUIRE( distinct.count(uuids[500]) == 1 );
+        REQUIRE( distinct.count(EXAMPLE) == 0 );
+    }
+
+    SECTION("Spans are generated, formatted and parsed back in one call each")
+    {
+        std::vector<Uuid> uuids(100);
+        Uuid7State * state = sqlite3Uuid7StateCreate(1);
+        REQUIRE( state != nullptr );
+        Uuid::generate7(state, uuids);
+        sqlite3Uuid7StateRelease(state);
+        REQUIRE( std::is_sorted(uuids.begin(), uuids.end()) );
+        REQUIRE( uuids.front().version() == 7 );
+
+        std::string text(Uuid::TEXT_LENGTH * uuids.size(), '\0');
+        Uuid::format(uuids, text);
+
+        std::vector<std::string_view> texts;
+        for(size_t uuidIndex = 0; uuidIndex < uuids.size(); uuidIndex++)
+        {
+            texts.push_back(std::string_view(text).substr(Uuid::TEXT_LENGTH * uuidIndex, Uuid::TEXT_LENGTH));
+            REQUIRE( texts.back() == uuids[uuidIndex].toString() );
+        }
+
+        std::vector<Uuid> parsed(uuids.size());
+        REQUIRE( Uuid::parse(texts, parsed) == texts.size() );
+        REQUIRE( parsed == uuids );
+
+        texts[42] = "not a guid";
+        REQUIRE( Uuid::parse(texts, parsed) == 42 );
+    }
+}
+
+TEST_CASE("Uuid values go in and out of sqlite as blobs", "[uuid]")
+{
+    registerUuidExtension();
+
+    sqlite3 * db = nullptr;
+    REQUIRE( sqlite3_open(":memory:", &db) == SQLITE_OK );
+
+    sqlite3_stmt * statement = nullptr;
+    REQUIRE( sqlite3_prepare_v2(db, "SELECT uuid_str(?1), uuid_version(?1), uuid_blob(uuid_str(?1))", -1, &statement, nullptr) == SQLITE_OK );
+    REQUIRE( sqlite3_bind_blob(statement, 1, EXAMPLE.bytes.data(), 16, SQLITE_STATIC) == SQLITE_OK );
+    REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+
+    REQUIRE( std::string(reinterpret_cast<const char *>(sqlite3_column_text(statement, 0))) == EXAMPLE.toString() );
+    REQUIRE( sqlite3_column_int(statement, 1) == EXAMPLE.version() );
+    REQUIRE( sqlite3_column_bytes(statement, 2) == 16 );
+    REQUIRE( Uuid::fromBytes(reinterpret_cast<const unsigned char *>(sqlite3_column_blob(statement, 2))) == EXAMPLE );
+
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+}
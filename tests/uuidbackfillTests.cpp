@@ -0,0 +1,76 @@
+#include "catch/catch.hpp"
+
+#include "sqlitehelpers.hpp"
+#include "testhelpers.hpp"
+#include "uuidbackfill.hpp"
+
+#include <sqlite3.h>
+
+#include <string>
+
+
+namespace
+{
+    // uuid() after writing out 200KB of hex, which depends on the row so it is not worked out once for all of them.
+    // A thousand rows take far longer than the deadline, a few of them do not.
+    const char * SLOW_GENERATOR = "CASE WHEN length(hex(zeroblob(100000 + id - id))) > 0 THEN uuid() END";
+}
+
+TEST_CASE("The app backfills UUID columns in time-capped, resumable batches", "[uuidbackfill]")
+{
+    registerUuidExtension();
+
+    sqlite3 * db = open_database(":memory:");
+
+    exec(db, "CREATE TABLE users(id INTEGER PRIMARY KEY, uuid TEXT NOT NULL DEFAULT('0'))");
+    exec(db, "INSERT INTO users(id) SELECT rowid FROM uuid_series(500)");
+
+    // Counts committed fills, so a batch that is rolled back and retried is not counted twice
+    exec(db, "CREATE TABLE fills(n INTEGER)");
+    exec(db, "INSERT INTO fills VALUES (0)");
+    exec(db, "CREATE TRIGGER count_fills AFTER UPDATE OF uuid ON users BEGIN UPDATE fills SET n = n + 1; END");
+
+    BatchOptions options;
+    options.batchRows = 1000;
+    options.maxBatchTime = std::chrono::milliseconds(20);
+    options.pause = std::chrono::milliseconds(0);
+
+    SECTION("Batches over the deadline are interrupted and retried smaller, and every row is filled once")
+    {
+        const BatchReport report = backfill_uuid_column(db, "users", "uuid", SLOW_GENERATOR, options);
+
+        REQUIRE( report.interruptedBatches > 0 );
+        REQUIRE( report.batches > 1 );
+        REQUIRE( report.rowsChanged == 500 );
+        REQUIRE( queryInt(db, "SELECT n FROM fills") == 500 );
+        REQUIRE( queryInt(db, "SELECT count(DISTINCT uuid) FROM users WHERE uuid_is_valid(uuid)") == 500 );
+        REQUIRE( queryInt(db, "SELECT last_rowid FROM uuid_batch_checkpoint WHERE name = 'uuid_backfill users.uuid'") == 500 );
+    }
+
+    SECTION("Running again starts after the checkpoint, so only new rows are filled")
+    {
+        options.maxBatchTime = std::chrono::milliseconds(10000);
+        options.batchRows = 64;
+        REQUIRE( backfill_uuid_column(db, "users", "uuid", "uuid()", options).rowsChanged == 500 );
+
+        exec(db, "CREATE TABLE before AS SELECT id, uuid FROM users");
+        exec(db, "INSERT INTO users(id) SELECT 500 + rowid FROM uuid_series(100)");
+
+        // Below the checkpoint, so it is not looked at again, even though it holds the default
+        exec(db, "UPDATE users SET uuid = '0' WHERE id = 10");
+        exec(db, "UPDATE fills SET n = 0");
+
+        const BatchReport report = backfill_uuid_column(db, "users", "uuid", "uuid()", options);
+        REQUIRE( report.rowsChanged == 100 );
+        REQUIRE( queryInt(db, "SELECT n FROM fills") == 100 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users JOIN before USING (id) WHERE users.uuid IS NOT before.uuid") == 1 );
+        REQUIRE( queryInt(db, "SELECT uuid FROM users WHERE id = 10") == 0 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE id > 500 AND uuid_is_valid(uuid)") == 100 );
+
+        // Once the checkpoint is cleared, the next run looks at every row again
+        clear_batch_checkpoint(db, "uuid_backfill users.uuid");
+        REQUIRE( backfill_uuid_column(db, "users", "uuid", "uuid()", options).rowsChanged == 1 );
+    }
+
+    sqlite3_close(db);
+}
@@ -0,0 +1,118 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidbloom.hpp"
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <string>
+#include <vector>
+
+
+TEST_CASE("Blocked Bloom filters never miss a UUID and rarely claim one", "[uuidbloom]")
+{
+    const size_t count = 50000;
+    std::vector<unsigned char> bytes(16 * (2 * count));
+    sqlite3UuidV4Generate(bytes.data(), 2 * count);
+
+    std::vector<unsigned char> filter(sqlite3UuidBloomBytes(count, 10.0));
+    sqlite3UuidBloomInit(filter.data(), filter.size());
+    for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+    {
+        sqlite3UuidBloomInsert(filter.data(), filter.size(), sqlite3UuidHash64(bytes.data() + 16 * uuidIndex));
+    }
+
+    SECTION("Filters are sized by bits per key, in whole blocks")
+    {
+        REQUIRE( filter.size() == UUID_BLOOM_HEADER_BYTES + UUID_BLOOM_BLOCK_BYTES * (count * 10 / 256 + 1) );
+        REQUIRE( sqlite3UuidBloomBytes(0, 10.0) == UUID_BLOOM_HEADER_BYTES + UUID_BLOOM_BLOCK_BYTES );
+        REQUIRE( sqlite3UuidBloomIsValid(filter.data(), filter.size()) );
+        REQUIRE_FALSE( sqlite3UuidBloomIsValid(filter.data(), filter.size() - 1) );
+        REQUIRE_FALSE( sqlite3UuidBloomIsValid(filter.data(), UUID_BLOOM_HEADER_BYTES) );
+    }
+
+    SECTION("Every supported kernel finds every UUID added, and agrees on the rest")
+    {
+        int falsePositives = 0;
+        for(size_t uuidIndex = 0; uuidIndex < 2 * count; uuidIndex++)
+        {
+            const uint64_t key = sqlite3UuidHash64(bytes.data() + 16 * uuidIndex);
+            const bool expected = sqlite3UuidBloomContainsWith(UUID_SIMD_SCALAR, filter.data(), filter.size(), key);
+            if( uuidIndex < count )
+            {
+                REQUIRE( expected );
+            }
+            else if( expected )
+            {
+                falsePositives++;
+            }
+
+            for(int level = UUID_SIMD_SSE2; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                REQUIRE( sqlite3UuidBloomContainsWith(static_cast<UuidSimdLevel>(level), filter.data(), filter.size(), key) == expected );
+            }
+        }
+
+        // About 1.2% at 10 bits per key
+        REQUIRE( falsePositives < static_cast<int>(count) / 50 );
+    }
+}
+
+TEST_CASE("The UUID SQlite extension builds and checks Bloom filters from SQL", "[uuidbloom]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+
+    SECTION("A filter kept in a side table rules out new UUIDs, in every encoding")
+    {
+        forEachEncoding([](soci::session & encoded)
+        {
+            encoded << "CREATE TABLE events (id TEXT PRIMARY KEY)";
+            encoded << "INSERT INTO events SELECT uuid FROM uuid_series(20000)";
+            encoded << "CREATE TABLE filters AS SELECT uuid_bloom(id, 10) AS filter FROM events";
+
+            int found = 0;
+            int falsePositives = 0;
+            encoded << "SELECT count(*) FROM events WHERE uuid_bloom_contains((SELECT filter FROM filters), uuid_blob(id))", soci::into(found);
+            encoded << "SELECT count(*) FROM uuid_series(20000) WHERE uuid_bloom_contains((SELECT filter FROM filters), uuid)", soci::into(falsePositives);
+            REQUIRE( found == 20000 );
+            REQUIRE( falsePositives < 400 );
+
+            // The dedup on ingest the filter is for: only the few UUIDs it cannot rule out go down the index
+            encoded << "INSERT INTO events SELECT uuid FROM uuid_series(1000) WHERE NOT uuid_bloom_contains((SELECT filter FROM filters), uuid) "
+                "OR NOT EXISTS (SELECT 1 FROM events WHERE id = uuid)";
+            encoded << "INSERT INTO events SELECT id FROM (SELECT id FROM events LIMIT 10) AS incoming WHERE NOT uuid_bloom_contains((SELECT filter FROM filters), id) "
+                "OR NOT EXISTS (SELECT 1 FROM events WHERE events.id = incoming.id)";
+
+            int count = 0;
+            encoded << "SELECT count(*) FROM events", soci::into(count);
+            REQUIRE( count == 21000 );
+        });
+    }
+
+    SECTION("No rows give an empty filter, and NULLs give NULL")
+    {
+        int contains = 1;
+        session << "SELECT uuid_bloom_contains(uuid_bloom(uuid, 10), uuid()) FROM uuid_series(0)", soci::into(contains);
+        REQUIRE( contains == 0 );
+
+        requireNull(session, "SELECT uuid_bloom_contains(NULL, uuid())");
+    }
+
+    SECTION("Bad input is rejected")
+    {
+        requireRejected(session, {
+            "SELECT uuid_bloom(uuid(), 0)",
+            "SELECT uuid_bloom(uuid(), 'ten')",
+            "SELECT uuid_bloom('not a guid', 10)",
+            "SELECT uuid_bloom_contains(x'a0eebc999c0b4ef8bb6d6bb9bd380a11', uuid())",
+            "SELECT uuid_bloom_contains(uuid_bloom(uuid(), 10), 'not a guid')"
+        });
+    }
+}
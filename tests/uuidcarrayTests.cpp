@@ -0,0 +1,114 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidcarray.hpp"
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // Binding pointers is below what soci offers, so these tests talk to sqlite directly
+    sqlite3_stmt * prepare(sqlite3 * db, const char * sql)
+    {
+        sqlite3_stmt * statement = nullptr;
+        REQUIRE( sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK );
+        return statement;
+    }
+
+    sqlite3_int64 queryInt(sqlite3 * db, const char * sql, const std::vector<unsigned char> & uuids)
+    {
+        sqlite3_stmt * statement = prepare(db, sql);
+        REQUIRE( sqlite3UuidBindCarray(statement, 1, uuids.data(), uuids.size() / 16) == SQLITE_OK );
+        REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+        const sqlite3_int64 result = sqlite3_column_int64(statement, 0);
+        sqlite3_finalize(statement);
+        return result;
+    }
+}
+
+TEST_CASE("The UUID SQlite extension reads bound arrays of UUIDs", "[uuidcarray]")
+{
+    registerUuidExtension();
+
+    sqlite3 * db = nullptr;
+    REQUIRE( sqlite3_open(":memory:", &db) == SQLITE_OK );
+    REQUIRE( sqlite3_exec(db, "CREATE TABLE events (id BLOB PRIMARY KEY, guid TEXT UNIQUE)", nullptr, nullptr, nullptr) == SQLITE_OK );
+
+    const size_t count = 100000;
+    std::vector<unsigned char> uuids(16 * count);
+    sqlite3UuidV4Generate(uuids.data(), count);
+
+    SECTION("Rows come out in the order of the array, as blobs and strings")
+    {
+        sqlite3_stmt * statement = prepare(db, "SELECT rowid, uuid_blob, uuid FROM uuid_carray(?)");
+        REQUIRE( sqlite3UuidBindCarray(statement, 1, uuids.data(), 3) == SQLITE_OK );
+
+        for(int row = 0; row < 3; row++)
+        {
+            REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+            REQUIRE( sqlite3_column_int(statement, 0) == row + 1 );
+            REQUIRE( sqlite3_column_bytes(statement, 1) == 16 );
+            REQUIRE( memcmp(sqlite3_column_blob(statement, 1), uuids.data() + 16 * row, 16) == 0 );
+
+            unsigned char text[37];
+            sqlite3UuidBlobToStr(uuids.data() + 16 * row, text);
+            REQUIRE( std::string(reinterpret_cast<const char *>(sqlite3_column_text(statement, 2))) == reinterpret_cast<char *>(text) );
+        }
+        REQUIRE( sqlite3_step(statement) == SQLITE_DONE );
+        sqlite3_finalize(statement);
+    }
+
+    SECTION("Rowids joined by OR are each looked up")
+    {
+        REQUIRE( queryInt(db, "SELECT count(*) FROM uuid_carray(?) WHERE rowid = 1 OR rowid = 3", uuids) == 2 );
+        REQUIRE( queryInt(db, "SELECT sum(rowid) FROM uuid_carray(?) WHERE rowid = 1 OR rowid = 3", uuids) == 4 );
+    }
+
+    SECTION("A whole array is inserted, and looked up, in one step")
+    {
+        sqlite3_stmt * insert = prepare(db, "INSERT INTO events SELECT uuid_blob, uuid FROM uuid_carray(?)");
+        REQUIRE( sqlite3UuidBindCarray(insert, 1, uuids.data(), count) == SQLITE_OK );
+        REQUIRE( sqlite3_step(insert) == SQLITE_DONE );
+        REQUIRE( sqlite3_changes(db) == static_cast<int>(count) );
+        sqlite3_finalize(insert);
+
+        std::vector<unsigned char> lookups(uuids.begin(), uuids.begin() + 16 * 1000);
+        std::vector<unsigned char> others(16 * 1000);
+        sqlite3UuidV4Generate(others.data(), 1000);
+        lookups.insert(lookups.end(), others.begin(), others.end());
+
+        REQUIRE( queryInt(db, "SELECT count(*) FROM events WHERE id IN uuid_carray(?)", lookups) == 1000 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM events WHERE guid IN (SELECT uuid FROM uuid_carray(?))", lookups) == 1000 );
+    }
+
+    SECTION("Anything but a bound array gives no rows")
+    {
+        sqlite3_stmt * statement = prepare(db, "SELECT count(*) FROM uuid_carray(?)");
+        REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+        REQUIRE( sqlite3_column_int(statement, 0) == 0 );
+        sqlite3_reset(statement);
+
+        // A pointer of another type is NULL to uuid_carray()
+        UuidCarray array = {uuids.data(), count};
+        REQUIRE( sqlite3_bind_pointer(statement, 1, &array, "carray", nullptr) == SQLITE_OK );
+        REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+        REQUIRE( sqlite3_column_int(statement, 0) == 0 );
+        sqlite3_reset(statement);
+
+        REQUIRE( sqlite3_bind_pointer(statement, 1, &array, UUID_CARRAY_POINTER_TYPE, nullptr) == SQLITE_OK );
+        REQUIRE( sqlite3_step(statement) == SQLITE_ROW );
+        REQUIRE( sqlite3_column_int(statement, 0) == static_cast<int>(count) );
+        sqlite3_finalize(statement);
+
+        REQUIRE( sqlite3_exec(db, "SELECT * FROM uuid_carray", nullptr, nullptr, nullptr) == SQLITE_ERROR );
+    }
+
+    sqlite3_close(db);
+}
@@ -2,24 +2,22 @@
 #define CATCH_CONFIG_MAIN
 #include "catch/catch.hpp"
 
+#include "sqlite_extensions/uuid.hpp"
 #include "sqlite_extensions/uuidext.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
 
 #include <sqlite3.h>
 #include <soci/soci.h>
 #include <boost/filesystem.hpp>
 
-#include <regex>
+#include <optional>
+#include <sstream>
 
 
 TEST_CASE("The UUID SQlite extension creates UUIDs from SQL", "[uuidext]")
 {
-    // Register extention
-    //
-    // Sqlite does something very odd where they require you to make an extension registration function that returns an int and takes three params,
-    // while also requiring you to pass it as a function that returns void and takes none. See https://www.sqlite.org/c3ref/auto_extension.html
-    typedef void(*pfnInitExtensionFunction)(void);
-    pfnInitExtensionFunction test = (pfnInitExtensionFunction)sqlite3_uuid_init;
-    sqlite3_auto_extension(test);
+    registerUuidExtension();
 
     // Delete database if it exists
     auto deleteDbFn = [](){
@@ -68,13 +66,14 @@ TEST_CASE("The UUID SQlite extension creates UUIDs from SQL", "[uuidext]")
         };
         REQUIRE_NOTHROW(insertRowWithGeneratedUuidFn());
 
-        SECTION("Generated GUID matches regex pattern")
+        SECTION("Generated GUID is in the canonical form")
         {
             soci::rowset<std::string> rowSet = (session->prepare << "SELECT guid from test_table");
             for( std::string & guidAsText : rowSet)
             {
-                const std::regex guidRegularExpression("^([0-9a-fA-F]){8}-([0-9a-fA-F]){4}-([0-9a-fA-F]){4}-([0-9a-fA-F]){4}-([0-9a-fA-F]){12}");
-                REQUIRE( std::regex_match(guidAsText, guidRegularExpression) );
+                const std::optional<Uuid> guid = Uuid::fromString(guidAsText);
+                REQUIRE( guid );
+                REQUIRE( guid->version() == 4 );
 
                 // time-low is 4 bytes
                 // time_mid is 2 bytes
@@ -94,24 +93,352 @@ TEST_CASE("The UUID SQlite extension creates UUIDs from SQL", "[uuidext]")
         }
     }
 
+    SECTION("Inserting 100 rows using the extension to generate a version 7 GUID")
+    {
+        auto insertRowWithGeneratedUuidFn = [&session]()
+        {
+            int id;
+            soci::statement statement = (session->prepare <<
+                "INSERT INTO test_table VALUES ("
+                    ":val,"              // id
+                    "uuid7(),"           // guid
+                    "uuid7_blob()"       // guid_bytes
+                ")", soci::use(id));
+            for (id = 0; id != 100; ++id)
+            {
+                statement.execute(true);
+            }
+        };
+        REQUIRE_NOTHROW(insertRowWithGeneratedUuidFn());
+
+        SECTION("Generated GUID is in the canonical form and has version 7")
+        {
+            soci::rowset<std::string> rowSet = (session->prepare << "SELECT guid from test_table");
+            for( std::string & guidAsText : rowSet)
+            {
+                const std::optional<Uuid> guid = Uuid::fromString(guidAsText);
+                REQUIRE( guid );
+                REQUIRE( guid->version() == 7 );
+                REQUIRE(guidAsText[14] == '7');
+
+                std::string eighthOctetAsHex = guidAsText.substr(19,2);
+                int eightByte;
+                REQUIRE( !(std::istringstream(eighthOctetAsHex) >> std::hex >> eightByte).fail() );
+                REQUIRE( (0xC0 & eightByte) == 0x80);
+            }
+        }
+
+        SECTION("Generated GUIDs increase in the order they were generated")
+        {
+            // Both the text and blob forms are strictly increasing, even within the same millisecond
+            int outOfOrderText = -1;
+            int outOfOrderBytes = -1;
+            *session << "SELECT count(*) FROM test_table AS a JOIN test_table AS b ON b.id = a.id + 1 WHERE b.guid <= a.guid", soci::into(outOfOrderText);
+            *session << "SELECT count(*) FROM test_table AS a JOIN test_table AS b ON b.id = a.id + 1 WHERE b.guid_bytes <= a.guid_bytes", soci::into(outOfOrderBytes);
+            REQUIRE(outOfOrderText == 0);
+            REQUIRE(outOfOrderBytes == 0);
+        }
+    }
+
     SECTION("Inserting valid GUID as Text")
     {
+        // Every form the extension documents converts to the same blob and back to the canonical string
+        const char * forms[] = {
+            "A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11",
+            "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}",
+            "a0eebc999c0b4ef8bb6d6bb9bd380a11",
+            "a0ee-bc99-9c0b-4ef8-bb6d-6bb9-bd38-0a11",
+            "{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}"
+        };
+
+        int id = 0;
+        for( const std::string form : forms )
+        {
+            REQUIRE_NOTHROW(*session << "INSERT INTO test_table VALUES (:id, uuid_str(:text), uuid_blob(:bytes))", soci::use(id), soci::use(form), soci::use(form));
+            id++;
+        }
 
+        soci::rowset<soci::row> rowSet = (session->prepare << "SELECT guid, hex(guid_bytes) FROM test_table");
+        for( soci::row & row : rowSet )
+        {
+            REQUIRE( row.get<std::string>(0) == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+            REQUIRE( row.get<std::string>(1) == "A0EEBC999C0B4EF8BB6D6BB9BD380A11" );
+        }
     }
 
     SECTION("Inserting invalid GUID as Text")
     {
+        const char * malformed[] = {
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1g",
+            "a0eebc99--9c0b-4ef8-bb6d-6bb9bd380a11",
+            "not a guid"
+        };
 
+        for( const std::string guid : malformed )
+        {
+            REQUIRE_THROWS_AS((*session << "INSERT INTO test_table VALUES (1, uuid_str(:guid), NULL)", soci::use(guid)), soci::soci_error);
+            REQUIRE_THROWS_AS((*session << "INSERT INTO test_table VALUES (1, NULL, uuid_blob(:guid))", soci::use(guid)), soci::soci_error);
+        }
     }
 
     SECTION("Inserting valid GUID as Blob")
     {
+        REQUIRE_NOTHROW(*session << "INSERT INTO test_table VALUES (1, uuid_str(x'a0eebc999c0b4ef8bb6d6bb9bd380a11'), uuid_blob(x'a0eebc999c0b4ef8bb6d6bb9bd380a11'))");
 
+        std::string guidAsText;
+        std::string guidBytesAsHex;
+        *session << "SELECT guid, hex(guid_bytes) FROM test_table WHERE id = 1", soci::into(guidAsText), soci::into(guidBytesAsHex);
+        REQUIRE( guidAsText == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+        REQUIRE( guidBytesAsHex == "A0EEBC999C0B4EF8BB6D6BB9BD380A11" );
     }
     
     SECTION("Inserting invalid GUID as Blob")
     {
+        // Blobs must be exactly 16 bytes
+        requireRejected(*session, {
+            "INSERT INTO test_table VALUES (1, uuid_str(x'a0eebc999c0b4ef8bb6d6bb9bd380a'), NULL)",
+            "INSERT INTO test_table VALUES (1, NULL, uuid_blob(x'a0eebc999c0b4ef8bb6d6bb9bd380a1100'))",
+            "INSERT INTO test_table VALUES (1, NULL, uuid_blob(12))"
+        });
+    }
+}
+
+
+TEST_CASE("The UUID SQlite extension works in UTF-16 databases", "[uuidext]")
+{
+    registerUuidExtension();
+
+    forEachEncoding([](soci::session & session)
+    {
+        session << "CREATE TABLE test_table (guid TEXT, guid_bytes BLOB)";
+
+        REQUIRE_NOTHROW(session << "INSERT INTO test_table VALUES (uuid_str('{A0EEBC99-9C0B4EF8-BB6D6BB9-BD380A11}'), uuid_blob('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'))");
+        REQUIRE_NOTHROW(session << "INSERT INTO test_table SELECT uuid(), NULL");
+        REQUIRE_NOTHROW(session << "INSERT INTO test_table SELECT uuid7(), NULL");
+
+        std::string guidAsText;
+        std::string guidBytesAsHex;
+        session << "SELECT guid, hex(guid_bytes) FROM test_table WHERE guid_bytes IS NOT NULL", soci::into(guidAsText), soci::into(guidBytesAsHex);
+        REQUIRE( guidAsText == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+        REQUIRE( guidBytesAsHex == "A0EEBC999C0B4EF8BB6D6BB9BD380A11" );
+
+        int roundTrips = 0;
+        session << "SELECT count(*) FROM test_table WHERE length(guid) = 36 AND uuid_str(uuid_blob(guid)) = guid", soci::into(roundTrips);
+        REQUIRE( roundTrips == 3 );
+
+        REQUIRE_THROWS_AS((session << "SELECT uuid_blob('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1\xC3\xA9')"), soci::soci_error);
+    }, {"UTF-16le", "UTF-16be"});
+}
+
+TEST_CASE("The UUID SQlite extension converts UUIDs to and from base64url", "[uuidext]")
+{
+    registerUuidExtension();
+
+    forEachEncoding([](soci::session & session)
+    {
+        std::string compact;
+        std::string guidAsText;
+        std::string guidBytesAsHex;
+        session << "SELECT uuid_b64('{A0EEBC99-9C0B4EF8-BB6D6BB9-BD380A11}'), uuid_from_b64('oO68mZwLTvi7bWu5vTgKEQ'), hex(uuid_blob('oO68mZwLTvi7bWu5vTgKEQ'))",
+            soci::into(compact), soci::into(guidAsText), soci::into(guidBytesAsHex);
+        REQUIRE( compact == "oO68mZwLTvi7bWu5vTgKEQ" );
+        REQUIRE( guidAsText == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+        REQUIRE( guidBytesAsHex == "A0EEBC999C0B4EF8BB6D6BB9BD380A11" );
 
+        int roundTrips = 0;
+        session << "SELECT count(*) FROM uuid_series(1000) WHERE length(uuid_b64(uuid)) = 22 AND uuid_from_b64(uuid_b64(uuid_blob)) = uuid", soci::into(roundTrips);
+        REQUIRE( roundTrips == 1000 );
+
+        // The UUID collation finds compact keys from any other form
+        session << "CREATE TABLE test_table (guid TEXT PRIMARY KEY COLLATE UUID)";
+        session << "INSERT INTO test_table SELECT uuid_b64(uuid) FROM uuid_series(100)";
+        session << "INSERT INTO test_table VALUES ('oO68mZwLTvi7bWu5vTgKEQ')";
+        std::string found;
+        session << "SELECT guid FROM test_table WHERE guid = 'A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11'", soci::into(found);
+        REQUIRE( found == "oO68mZwLTvi7bWu5vTgKEQ" );
+
+        requireRejected(session, {
+            "SELECT uuid_from_b64('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11')",
+            "SELECT uuid_from_b64('oO68mZwLTvi7bWu5vTgKER')",
+            "SELECT uuid_b64('not a guid')"
+        });
+    });
+}
+
+TEST_CASE("The UUID collation compares text UUIDs by value", "[uuidext]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+    session << "CREATE TABLE test_table (id INTEGER, guid TEXT)";
+    session << "CREATE INDEX test_table_guid ON test_table (guid COLLATE UUID)";
+    session << "INSERT INTO test_table VALUES "
+        "(1, 'A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11'), "
+        "(2, '{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}'), "
+        "(3, '00000000-0000-4000-8000-000000000001'), "
+        "(4, 'FFFFFFFF-FFFF-4FFF-BFFF-FFFFFFFFFFFF'), "
+        "(5, 'not a guid')";
+
+    SECTION("Every form of the same UUID is equal, through the index")
+    {
+        int matches = 0;
+        session << "SELECT count(*) FROM test_table WHERE guid = 'a0eebc999c0b4ef8bb6d6bb9bd380a11' COLLATE UUID", soci::into(matches);
+        REQUIRE( matches == 2 );
+
+        std::string plan;
+        soci::rowset<soci::row> planRows = (session.prepare << "EXPLAIN QUERY PLAN SELECT id FROM test_table WHERE guid = 'a0eebc999c0b4ef8bb6d6bb9bd380a11' COLLATE UUID");
+        for( soci::row & row : planRows )
+        {
+            plan += row.get<std::string>(3);
+        }
+        REQUIRE( plan.find("USING INDEX test_table_guid") != std::string::npos );
+    }
+
+    SECTION("UUIDs sort by value, followed by anything else")
+    {
+        std::vector<int> ids(5);
+        session << "SELECT id FROM test_table ORDER BY guid COLLATE UUID, id", soci::into(ids);
+        REQUIRE( ids == std::vector<int>{3, 1, 2, 4, 5} );
     }
 }
 
+TEST_CASE("Version 7 UUIDs give range scans by time", "[uuidext]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+
+    SECTION("Timestamps are read from versions 7, 6 and 1")
+    {
+        long long version7 = 0;
+        long long version6 = 0;
+        long long version1 = 0;
+        session << "SELECT uuid7_timestamp(uuid7_bound(1700000000000, 'hi')), uuid7_timestamp('1f1c9498-8028-65da-9f87-02fc00000001'), "
+            "uuid7_timestamp(x'880285dac94911f19f8702fc00000001')", soci::into(version7), soci::into(version6), soci::into(version1);
+        REQUIRE( version7 == 1700000000000ll );
+        REQUIRE( version6 == 1792145307685ll );
+        REQUIRE( version1 == 1792145307685ll );
+
+        requireNull(session, "SELECT uuid7_timestamp(uuid())");
+    }
+
+    SECTION("Bounds cover every UUID of their millisecond, as blobs and as text")
+    {
+        std::string lower;
+        std::string upper;
+        session << "SELECT uuid_str(uuid7_bound(1700000000000, 'lo')), uuid_str(uuid7_bound(1700000000000, 'hi'))", soci::into(lower), soci::into(upper);
+        REQUIRE( lower == "018bcfe5-6800-7000-8000-000000000000" );
+        REQUIRE( upper == "018bcfe5-6800-7fff-bfff-ffffffffffff" );
+
+        session << "CREATE TABLE events (id BLOB PRIMARY KEY, guid TEXT UNIQUE) WITHOUT ROWID";
+        session << "INSERT INTO events SELECT uuid_blob, uuid_str(uuid_blob) FROM (SELECT uuid7_blob() AS uuid_blob FROM uuid_series(1000))";
+
+        int blobMatches = 0;
+        int textMatches = 0;
+        session << "SELECT count(*) FROM events WHERE id BETWEEN uuid7_bound(uuid7_timestamp((SELECT min(id) FROM events)), 'lo') "
+            "AND uuid7_bound(uuid7_timestamp((SELECT max(id) FROM events)), 'hi')", soci::into(blobMatches);
+        session << "SELECT count(*) FROM events WHERE guid BETWEEN uuid_str(uuid7_bound(0, 'lo')) AND uuid_str(uuid7_bound(281474976710655, 'hi'))", soci::into(textMatches);
+        REQUIRE( blobMatches == 1000 );
+        REQUIRE( textMatches == 1000 );
+
+        std::string plan;
+        soci::rowset<soci::row> planRows = (session.prepare << "EXPLAIN QUERY PLAN SELECT count(*) FROM events WHERE id BETWEEN uuid7_bound(0, 'lo') AND uuid7_bound(1, 'hi')");
+        for( soci::row & row : planRows )
+        {
+            plan += row.get<std::string>(3);
+        }
+        REQUIRE( plan.find("SEARCH events USING PRIMARY KEY (id>? AND id<?)") != std::string::npos );
+    }
+
+    SECTION("Bad input is rejected")
+    {
+        requireRejected(session, {
+            "SELECT uuid7_timestamp('not a guid')",
+            "SELECT uuid7_bound(-1, 'lo')",
+            "SELECT uuid7_bound(281474976710656, 'hi')",
+            "SELECT uuid7_bound(0, 'middle')"
+        });
+    }
+}
+
+TEST_CASE("The UUID SQlite extension reads versions and variants, and validates UUIDs", "[uuidext]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+
+    SECTION("Versions and variants are read from any form")
+    {
+        int version4 = 0;
+        int version7 = 0;
+        int variantRfc = -1;
+        int variantNcs = -1;
+        int variantMicrosoft = -1;
+        int variantReserved = -1;
+        session << "SELECT uuid_version(uuid()), uuid_version(uuid7_blob()), uuid_variant('{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}'), "
+            "uuid_variant('a0eebc99-9c0b-4ef8-3b6d-6bb9bd380a11'), uuid_variant(x'a0eebc999c0b4ef8cb6d6bb9bd380a11'), "
+            "uuid_variant('A0EEBC99-9C0B-4EF8-EB6D-6BB9BD380A11')", soci::into(version4), soci::into(version7), soci::into(variantRfc),
+            soci::into(variantNcs), soci::into(variantMicrosoft), soci::into(variantReserved);
+        REQUIRE( version4 == 4 );
+        REQUIRE( version7 == 7 );
+        REQUIRE( variantRfc == 1 );
+        REQUIRE( variantNcs == 0 );
+        REQUIRE( variantMicrosoft == 2 );
+        REQUIRE( variantReserved == 3 );
+
+        requireRejected(session, {"SELECT uuid_version('not a guid')", "SELECT uuid_variant(x'a0eebc99')"});
+    }
+
+    SECTION("Only canonical text and 16-byte blobs of RFC 9562 UUIDs are valid")
+    {
+        const char * valid[] = {
+            "uuid()",
+            "uuid7_blob()",
+            "upper(uuid7())",
+            "uuid5(uuid(), 'name')",
+            "'00000000-0000-0000-0000-000000000000'",
+            "x'ffffffffffffffffffffffffffffffff'"
+        };
+        const char * invalid[] = {
+            "'{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}'",
+            "'a0eebc999c0b4ef8bb6d6bb9bd380a11'",
+            "'oO68mZwLTvi7bWu5vTgKEQ'",
+            "'a0eebc99-9c0b-4ef8-cb6d-6bb9bd380a11'",
+            "'a0eebc99-9c0b-0ef8-bb6d-6bb9bd380a11'",
+            "'a0eebc99-9c0b-9ef8-bb6d-6bb9bd380a11'",
+            "x'a0eebc999c0b4ef8bb6d6bb9bd380a'",
+            "42",
+            "'not a guid'"
+        };
+
+        for( const std::string expression : valid )
+        {
+            INFO(expression);
+            int result = 0;
+            session << "SELECT uuid_is_valid(" + expression + ")", soci::into(result);
+            REQUIRE( result == 1 );
+        }
+        for( const std::string expression : invalid )
+        {
+            INFO(expression);
+            int result = 1;
+            session << "SELECT uuid_is_valid(" + expression + ")", soci::into(result);
+            REQUIRE( result == 0 );
+        }
+    }
+
+    SECTION("uuid_is_valid() works as a CHECK constraint in every encoding")
+    {
+        forEachEncoding([](soci::session & encoded)
+        {
+            encoded << "CREATE TABLE users (id TEXT CHECK (uuid_is_valid(id)))";
+            encoded << "INSERT INTO users VALUES (uuid()), (uuid7()), (NULL)";
+            REQUIRE_THROWS_AS((encoded << "INSERT INTO users VALUES ('a0eebc999c0b4ef8bb6d6bb9bd380a11')"), soci::soci_error);
+
+            int count = 0;
+            encoded << "SELECT count(*) FROM users", soci::into(count);
+            REQUIRE( count == 3 );
+        });
+    }
+}
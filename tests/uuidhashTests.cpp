@@ -0,0 +1,108 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+TEST_CASE("UUIDs hash and shard the same everywhere", "[uuidhash]")
+{
+    const unsigned char uuid[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+
+    SECTION("The hash is pinned, as rows are routed by it")
+    {
+        const unsigned char zero[16] = {};
+        REQUIRE( sqlite3UuidHash64(uuid) == 2262558789814823701ull );
+        REQUIRE( sqlite3UuidHash64(zero) == 0x42cc592e95069169ull );
+        REQUIRE( sqlite3UuidShard(uuid, 16) == 7 );
+    }
+
+    SECTION("Every bit of the input changes the hash")
+    {
+        for(int bit = 0; bit < 128; bit++)
+        {
+            unsigned char flipped[16];
+            memcpy(flipped, uuid, 16);
+            flipped[bit / 8] ^= static_cast<unsigned char>(1 << (bit % 8));
+            REQUIRE( sqlite3UuidHash64(flipped) != sqlite3UuidHash64(uuid) );
+        }
+    }
+
+    SECTION("Adding a shard only moves keys onto the new shard")
+    {
+        std::mt19937_64 generator(20240415);
+        const int keys = 100000;
+        int moved = 0;
+
+        for(int i = 0; i < keys; i++)
+        {
+            const uint64_t key = generator();
+            const int32_t before = sqlite3UuidJumpHash(key, 10);
+            const int32_t after = sqlite3UuidJumpHash(key, 11);
+
+            REQUIRE( before >= 0 );
+            REQUIRE( before < 10 );
+            if( after != before )
+            {
+                REQUIRE( after == 10 );
+                moved++;
+            }
+        }
+
+        // 1 in 11 of them, give or take
+        REQUIRE( moved > keys / 11 * 9 / 10 );
+        REQUIRE( moved < keys / 11 * 11 / 10 );
+    }
+}
+
+TEST_CASE("The UUID SQlite extension hashes and shards UUIDs from SQL", "[uuidhash]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+
+    SECTION("Every form of a UUID gives the same values as the C++ API")
+    {
+        const unsigned char uuid[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        const char * forms[] = {
+            "x'a0eebc999c0b4ef8bb6d6bb9bd380a11'",
+            "'A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11'",
+            "'{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}'"
+        };
+
+        for( const std::string form : forms )
+        {
+            long long hash = 0;
+            int shard = -1;
+            session << "SELECT uuid_hash64(" + form + "), uuid_shard(" + form + ", 16)", soci::into(hash), soci::into(shard);
+            REQUIRE( static_cast<uint64_t>(hash) == sqlite3UuidHash64(uuid) );
+            REQUIRE( shard == sqlite3UuidShard(uuid, 16) );
+        }
+    }
+
+    SECTION("Shards are balanced")
+    {
+        std::vector<int> counts(8);
+        session << "SELECT count(*) FROM uuid_series(80000) GROUP BY uuid_shard(uuid, 8) ORDER BY 1", soci::into(counts);
+        REQUIRE( counts.size() == 8 );
+        REQUIRE( counts.front() > 9000 );
+        REQUIRE( counts.back() < 11000 );
+    }
+
+    SECTION("Bad input is rejected")
+    {
+        requireRejected(session, {
+            "SELECT uuid_hash64('not a guid')",
+            "SELECT uuid_shard(uuid(), 0)",
+            "SELECT uuid_shard(uuid(), 2147483648)"
+        });
+    }
+}
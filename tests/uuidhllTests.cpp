@@ -0,0 +1,142 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidhash.hpp"
+#include "sqlite_extensions/uuidhll.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    double relativeError(double estimate, double actual)
+    {
+        return std::fabs(estimate - actual) / actual;
+    }
+}
+
+TEST_CASE("HyperLogLog sketches estimate and merge distinct counts", "[uuidhll]")
+{
+    std::vector<unsigned char> sketch(UUID_HLL_SKETCH_BYTES);
+    sqlite3UuidHllInit(sketch.data());
+    unsigned char * registers = sketch.data() + UUID_HLL_HEADER_BYTES;
+
+    SECTION("An empty sketch is valid and counts nothing")
+    {
+        REQUIRE( sqlite3UuidHllIsValid(sketch.data(), sketch.size()) );
+        REQUIRE( sqlite3UuidHllEstimate(registers) == 0.0 );
+        REQUIRE_FALSE( sqlite3UuidHllIsValid(sketch.data(), sketch.size() - 1) );
+
+        sketch[0] = 'X';
+        REQUIRE_FALSE( sqlite3UuidHllIsValid(sketch.data(), sketch.size()) );
+    }
+
+    SECTION("Version 4 bits are used as they are, and version 7 is hashed")
+    {
+        const unsigned char version4[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        REQUIRE( sqlite3UuidHllHash(version4) == 0xa0ed6bb9bd380a11ull );
+
+        unsigned char version7[16];
+        sqlite3UuidV7Bound(1700000000000, false, version7);
+        REQUIRE( sqlite3UuidHllHash(version7) == sqlite3UuidHash64(version7) );
+    }
+
+    SECTION("Counts are within a few standard errors, for version 4 and version 7 UUIDs")
+    {
+        const size_t counts[] = {10, 1000, 20000, 200000};
+        for( size_t count : counts )
+        {
+            INFO(count);
+            std::vector<unsigned char> version4(16 * count);
+            sqlite3UuidV4Generate(version4.data(), count);
+
+            Uuid7State * state = sqlite3Uuid7StateCreate(1);
+            std::vector<unsigned char> version7(16 * count);
+            sqlite3UuidV7Generate(state, version7.data(), count);
+            sqlite3Uuid7StateRelease(state);
+
+            std::vector<unsigned char> sketch7(UUID_HLL_SKETCH_BYTES);
+            sqlite3UuidHllInit(sketch7.data());
+            sqlite3UuidHllInit(sketch.data());
+            for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+            {
+                sqlite3UuidHllAdd(registers, version4.data() + 16 * uuidIndex);
+                // Each one twice, which must not count
+                sqlite3UuidHllAdd(sketch7.data() + UUID_HLL_HEADER_BYTES, version7.data() + 16 * uuidIndex);
+                sqlite3UuidHllAdd(sketch7.data() + UUID_HLL_HEADER_BYTES, version7.data() + 16 * uuidIndex);
+            }
+
+            REQUIRE( relativeError(sqlite3UuidHllEstimate(registers), static_cast<double>(count)) < 0.04 );
+            REQUIRE( relativeError(sqlite3UuidHllEstimate(sketch7.data() + UUID_HLL_HEADER_BYTES), static_cast<double>(count)) < 0.04 );
+
+            // The union of the two
+            sqlite3UuidHllMerge(registers, sketch7.data() + UUID_HLL_HEADER_BYTES);
+            REQUIRE( sqlite3UuidHllIsValid(sketch.data(), sketch.size()) );
+            REQUIRE( relativeError(sqlite3UuidHllEstimate(registers), 2.0 * count) < 0.04 );
+        }
+    }
+}
+
+TEST_CASE("The UUID SQlite extension counts distinct UUIDs from SQL", "[uuidhll]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+
+    SECTION("Every form of a UUID counts once, and NULLs are skipped")
+    {
+        long long count = 0;
+        session << "SELECT uuid_approx_distinct(guid) FROM (SELECT 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11' AS guid UNION ALL "
+            "SELECT x'a0eebc999c0b4ef8bb6d6bb9bd380a11' UNION ALL SELECT '{A0EEBC99-9C0B4EF8-BB6D6BB9-BD380A11}' UNION ALL SELECT NULL)", soci::into(count);
+        REQUIRE( count == 1 );
+
+        session << "SELECT uuid_approx_distinct(uuid) FROM uuid_series(0)", soci::into(count);
+        REQUIRE( count == 0 );
+    }
+
+    SECTION("Stored sketches merge into the count of the whole table, in every encoding")
+    {
+        forEachEncoding([](soci::session & encoded)
+        {
+            encoded << "CREATE TABLE events (guid TEXT, day INTEGER)";
+            encoded << "INSERT INTO events SELECT uuid, abs(uuid_hash64(uuid)) % 7 FROM uuid_series(30000)";
+            encoded << "INSERT INTO events SELECT guid, day FROM events WHERE day < 3";
+            encoded << "CREATE TABLE daily AS SELECT day, uuid_hll(guid) AS sketch FROM events GROUP BY day";
+
+            long long exact = 0;
+            long long approximate = 0;
+            long long merged = 0;
+            encoded << "SELECT count(DISTINCT guid), uuid_approx_distinct(guid) FROM events", soci::into(exact), soci::into(approximate);
+            encoded << "SELECT uuid_hll_count(uuid_hll_merge(sketch)) FROM daily", soci::into(merged);
+            REQUIRE( exact == 30000 );
+            REQUIRE( relativeError(static_cast<double>(approximate), 30000.0) < 0.04 );
+            REQUIRE( merged == approximate );
+        });
+    }
+
+    SECTION("Merging no sketches gives NULL, and the sketch of no rows counts 0")
+    {
+        requireNull(session, "SELECT uuid_hll_merge(NULL)");
+
+        long long count = -1;
+        session << "SELECT uuid_hll_count(uuid_hll(uuid)) FROM uuid_series(0)", soci::into(count);
+        REQUIRE( count == 0 );
+    }
+
+    SECTION("Bad input is rejected")
+    {
+        requireRejected(session, {
+            "SELECT uuid_approx_distinct('not a guid')",
+            "SELECT uuid_hll_count(x'a0eebc999c0b4ef8bb6d6bb9bd380a11')",
+            "SELECT uuid_hll_merge('not a sketch')"
+        });
+    }
+}
@@ -0,0 +1,372 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidkernels.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    std::vector<unsigned char> randomBytes(std::mt19937 & generator, size_t count)
+    {
+        std::uniform_int_distribution<int> distribution(0, 255);
+        std::vector<unsigned char> bytes(count);
+        for( unsigned char & byte : bytes )
+        {
+            byte = static_cast<unsigned char>(distribution(generator));
+        }
+        return bytes;
+    }
+
+    std::string formatScalar(const unsigned char * bytes, size_t count)
+    {
+        std::string result;
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            unsigned char text[37];
+            sqlite3UuidBlobToStrScalar(bytes + 16 * uuidIndex, text);
+            result.append(reinterpret_cast<char *>(text), 36);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("The vectorized UUID formatting kernels match the scalar reference", "[uuidkernels]")
+{
+    std::mt19937 generator(20240229);
+
+    SECTION("The scalar reference produces the canonical form")
+    {
+        const unsigned char bytes[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        unsigned char text[37];
+        sqlite3UuidBlobToStrScalar(bytes, text);
+        REQUIRE( std::string(reinterpret_cast<char *>(text)) == "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11" );
+    }
+
+    SECTION("Every supported kernel formats random UUIDs identically")
+    {
+        const size_t count = 10000;
+        const std::vector<unsigned char> bytes = randomBytes(generator, 16 * count);
+        const std::string expected = formatScalar(bytes.data(), count);
+
+        for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+        {
+            INFO("SIMD level " << level);
+            std::string actual(36 * count, '\0');
+            sqlite3UuidBlobsToStrsWith(static_cast<UuidSimdLevel>(level), bytes.data(), count, reinterpret_cast<unsigned char *>(&actual[0]));
+            REQUIRE( actual == expected );
+        }
+    }
+
+    SECTION("Every supported kernel handles batches of any length without writing past the end")
+    {
+        const std::vector<unsigned char> bytes = randomBytes(generator, 16 * 9);
+
+        for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+        {
+            for(size_t count = 0; count <= 9; count++)
+            {
+                INFO("SIMD level " << level << ", batch of " << count);
+                std::string actual(36 * count + 1, '#');
+                sqlite3UuidBlobsToStrsWith(static_cast<UuidSimdLevel>(level), bytes.data(), count, reinterpret_cast<unsigned char *>(&actual[0]));
+                REQUIRE( actual.substr(0, 36 * count) == formatScalar(bytes.data(), count) );
+                REQUIRE( actual.back() == '#' );
+            }
+        }
+    }
+
+    SECTION("The dispatched single UUID routine is zero terminated")
+    {
+        const std::vector<unsigned char> bytes = randomBytes(generator, 16);
+        unsigned char text[38];
+        memset(text, '#', sizeof(text));
+        sqlite3UuidBlobToStr(bytes.data(), text);
+        REQUIRE( text[36] == 0 );
+        REQUIRE( std::string(reinterpret_cast<char *>(text)) == formatScalar(bytes.data(), 1) );
+    }
+}
+
+TEST_CASE("The vectorized UUID parsing kernels match the scalar reference", "[uuidkernels]")
+{
+    std::mt19937 generator(20240301);
+
+    auto parseWith = [](int level, const std::string & text, unsigned char * out)
+    {
+        return sqlite3UuidStrToBlobWith(static_cast<UuidSimdLevel>(level), reinterpret_cast<const unsigned char *>(text.data()), text.size(), out);
+    };
+
+    SECTION("The scalar reference accepts every documented form")
+    {
+        const unsigned char expected[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        const char * forms[] = {
+            "A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11",
+            "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}",
+            "a0eebc999c0b4ef8bb6d6bb9bd380a11",
+            "a0ee-bc99-9c0b-4ef8-bb6d-6bb9-bd38-0a11",
+            "{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}",
+            "oO68mZwLTvi7bWu5vTgKEQ"
+        };
+
+        for( const char * form : forms )
+        {
+            INFO(form);
+            for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                unsigned char out[16];
+                REQUIRE( parseWith(level, form, out) == 0 );
+                REQUIRE( memcmp(out, expected, 16) == 0 );
+            }
+        }
+    }
+
+    SECTION("Every supported kernel parses random canonical UUIDs identically, in either case")
+    {
+        const size_t count = 10000;
+        const std::vector<unsigned char> bytes = randomBytes(generator, 16 * count);
+        const std::string formatted = formatScalar(bytes.data(), count);
+
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            std::string text = formatted.substr(36 * uuidIndex, 36);
+            if( uuidIndex % 2 )
+            {
+                for( char & character : text )
+                {
+                    character = static_cast<char>(toupper(character));
+                }
+            }
+
+            for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                unsigned char out[16];
+                REQUIRE( parseWith(level, text, out) == 0 );
+                REQUIRE( memcmp(out, bytes.data() + 16 * uuidIndex, 16) == 0 );
+            }
+        }
+    }
+
+    SECTION("Every supported kernel agrees with the scalar reference on corrupted input")
+    {
+        const size_t count = 10000;
+        const std::vector<unsigned char> bytes = randomBytes(generator, 16 * count);
+        const std::string formatted = formatScalar(bytes.data(), count);
+        std::uniform_int_distribution<int> position(0, 35);
+        std::uniform_int_distribution<int> character(0, 255);
+
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            std::string text = formatted.substr(36 * uuidIndex, 36);
+            text[position(generator)] = static_cast<char>(character(generator));
+
+            unsigned char expected[16];
+            const int expectedResult = parseWith(UUID_SIMD_SCALAR, text, expected);
+
+            for(int level = UUID_SIMD_SSE2; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                INFO("SIMD level " << level << " parsing " << text);
+                unsigned char out[16];
+                const int result = parseWith(level, text, out);
+                REQUIRE( (result == 0) == (expectedResult == 0) );
+                if( result == 0 )
+                {
+                    REQUIRE( memcmp(out, expected, 16) == 0 );
+                }
+            }
+        }
+    }
+
+    SECTION("The canonical parser accepts only the canonical form, at every supported level")
+    {
+        const unsigned char expected[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        const char * canonical[] = {
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11",
+            "A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11"
+        };
+        const char * otherForms[] = {
+            "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}",
+            "a0eebc999c0b4ef8bb6d6bb9bd380a11",
+            "a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11",
+            "a0ee-bc99-9c0b-4ef8-bb6d-6bb9bd380a11",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1g",
+            "oO68mZwLTvi7bWu5vTgKEQ"
+        };
+
+        for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+        {
+            INFO("SIMD level " << level);
+            for( const std::string text : canonical )
+            {
+                unsigned char out[16];
+                REQUIRE( sqlite3UuidCanonicalToBlobWith(static_cast<UuidSimdLevel>(level), reinterpret_cast<const unsigned char *>(text.data()), text.size(), out) == 0 );
+                REQUIRE( memcmp(out, expected, 16) == 0 );
+            }
+            for( const std::string text : otherForms )
+            {
+                INFO(text);
+                unsigned char out[16];
+                REQUIRE( sqlite3UuidCanonicalToBlobWith(static_cast<UuidSimdLevel>(level), reinterpret_cast<const unsigned char *>(text.data()), text.size(), out) != 0 );
+            }
+        }
+    }
+
+    SECTION("Malformed input is rejected")
+    {
+        const char * malformed[] = {
+            "",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a111",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1g",
+            "a0eebc99--9c0b-4ef8-bb6d-6bb9bd380a11",
+            "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11-",
+            "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}}",
+            "oO68mZwLTvi7bWu5vTgKER",
+            "oO68mZwLTvi7bWu5vTgK+Q",
+            "oO68mZwLTvi7bWu5vTgKEQ="
+        };
+
+        for( const char * text : malformed )
+        {
+            INFO(text);
+            for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                unsigned char out[16];
+                REQUIRE( parseWith(level, text, out) != 0 );
+            }
+        }
+    }
+}
+
+TEST_CASE("The base64url kernels match the scalar reference", "[uuidkernels]")
+{
+    std::mt19937 generator(20240306);
+    const size_t count = 10000;
+    const std::vector<unsigned char> bytes = randomBytes(generator, 16 * count);
+
+    SECTION("The scalar reference produces RFC 4648 base64url without padding")
+    {
+        const unsigned char uuid[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+        unsigned char text[22];
+        sqlite3UuidBlobToB64Scalar(uuid, text);
+        REQUIRE( std::string(reinterpret_cast<char *>(text), 22) == "oO68mZwLTvi7bWu5vTgKEQ" );
+    }
+
+    SECTION("Every supported kernel encodes and decodes random UUIDs identically")
+    {
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            const unsigned char * uuid = bytes.data() + 16 * uuidIndex;
+            unsigned char expected[22];
+            sqlite3UuidBlobToB64Scalar(uuid, expected);
+
+            for(int level = UUID_SIMD_SCALAR; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                INFO("SIMD level " << level);
+                unsigned char text[22];
+                sqlite3UuidBlobToB64With(static_cast<UuidSimdLevel>(level), uuid, text);
+                REQUIRE( memcmp(text, expected, 22) == 0 );
+
+                unsigned char out[16];
+                REQUIRE( sqlite3UuidB64ToBlobWith(static_cast<UuidSimdLevel>(level), text, 22, out) == 0 );
+                REQUIRE( memcmp(out, uuid, 16) == 0 );
+            }
+        }
+    }
+
+    SECTION("Every supported kernel agrees with the scalar reference on corrupted input")
+    {
+        std::uniform_int_distribution<int> position(0, 21);
+        std::uniform_int_distribution<int> character(0, 255);
+
+        for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+        {
+            unsigned char text[22];
+            sqlite3UuidBlobToB64Scalar(bytes.data() + 16 * uuidIndex, text);
+            text[position(generator)] = static_cast<unsigned char>(character(generator));
+
+            unsigned char expected[16];
+            const int expectedResult = sqlite3UuidB64ToBlobScalar(text, 22, expected);
+
+            for(int level = UUID_SIMD_SSE2; level <= sqlite3UuidSimdSupported(); level++)
+            {
+                INFO("SIMD level " << level << " parsing " << std::string(reinterpret_cast<char *>(text), 22));
+                unsigned char out[16];
+                const int result = sqlite3UuidB64ToBlobWith(static_cast<UuidSimdLevel>(level), text, 22, out);
+                REQUIRE( (result == 0) == (expectedResult == 0) );
+                if( result == 0 )
+                {
+                    REQUIRE( memcmp(out, expected, 16) == 0 );
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("The UTF-16 kernels match the 8-bit ones", "[uuidkernels]")
+{
+    std::mt19937 generator(20240302);
+
+    auto widen = [](const std::string & text, bool bigEndian)
+    {
+        std::vector<unsigned char> text16;
+        for( char character : text )
+        {
+            text16.push_back(bigEndian ? 0 : static_cast<unsigned char>(character));
+            text16.push_back(bigEndian ? static_cast<unsigned char>(character) : 0);
+        }
+        return text16;
+    };
+
+    for( bool bigEndian : {false, true} )
+    {
+        INFO("big-endian " << bigEndian);
+
+        SECTION("Formatting produces the 8-bit text as code units")
+        {
+            const std::vector<unsigned char> bytes = randomBytes(generator, 16 * 1000);
+            for(size_t uuidIndex = 0; uuidIndex < 1000; uuidIndex++)
+            {
+                unsigned char text16[72];
+                sqlite3UuidBlobToStr16(bytes.data() + 16 * uuidIndex, bigEndian, text16);
+                REQUIRE( std::vector<unsigned char>(text16, text16 + 72) == widen(formatScalar(bytes.data() + 16 * uuidIndex, 1), bigEndian) );
+            }
+        }
+
+        SECTION("Parsing accepts every documented form, and rejects code units outside of ASCII")
+        {
+            const unsigned char expected[16] = {0xa0, 0xee, 0xbc, 0x99, 0x9c, 0x0b, 0x4e, 0xf8, 0xbb, 0x6d, 0x6b, 0xb9, 0xbd, 0x38, 0x0a, 0x11};
+            const char * forms[] = {
+                "A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11",
+                "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}",
+                "a0eebc999c0b4ef8bb6d6bb9bd380a11",
+                "a0ee-bc99-9c0b-4ef8-bb6d-6bb9-bd38-0a11",
+                "{a0eebc99-9c0b4ef8-bb6d6bb9-bd380a11}"
+            };
+
+            for( const char * form : forms )
+            {
+                INFO(form);
+                std::vector<unsigned char> text16 = widen(form, bigEndian);
+
+                unsigned char out[16];
+                REQUIRE( sqlite3UuidStr16ToBlob(text16.data(), text16.size(), bigEndian, out) == 0 );
+                REQUIRE( memcmp(out, expected, 16) == 0 );
+
+                // The same digit with a high byte set, in both the vectorized and the scalar part
+                for( size_t unit : {size_t(1), text16.size() / 2 - 2} )
+                {
+                    std::vector<unsigned char> corrupted = text16;
+                    corrupted[2 * unit + (bigEndian ? 0 : 1)] = 0x01;
+                    REQUIRE( sqlite3UuidStr16ToBlob(corrupted.data(), corrupted.size(), bigEndian, out) != 0 );
+                    corrupted[2 * unit + (bigEndian ? 0 : 1)] = 0x80;
+                    REQUIRE( sqlite3UuidStr16ToBlob(corrupted.data(), corrupted.size(), bigEndian, out) != 0 );
+                }
+
+                REQUIRE( sqlite3UuidStr16ToBlob(text16.data(), text16.size() - 1, bigEndian, out) != 0 );
+            }
+        }
+    }
+}
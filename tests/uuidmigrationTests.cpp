@@ -0,0 +1,106 @@
+#include "catch/catch.hpp"
+
+#include "sqlitehelpers.hpp"
+#include "testhelpers.hpp"
+#include "uuidmigration.hpp"
+
+#include <sqlite3.h>
+
+#include <stdexcept>
+#include <string>
+
+
+TEST_CASE("The app migrates text UUID columns to blobs in resumable batches", "[uuidmigration]")
+{
+    registerUuidExtension();
+
+    sqlite3 * db = open_database(":memory:");
+
+    // The app's own table gets its uuid column with DEFAULT('0'), which rows keep until they are backfilled
+    exec(db, "CREATE TABLE users(id INTEGER PRIMARY KEY, name TEXT, uuid TEXT NOT NULL DEFAULT('0'))");
+    exec(db, "CREATE INDEX users_uuid ON users(uuid)");
+    exec(db, "CREATE INDEX users_name_uuid ON users(name, uuid)");
+    exec(db, "INSERT INTO users(id, name, uuid) SELECT rowid, 'user ' || rowid, "
+        "CASE WHEN rowid % 7 = 0 THEN '{' || upper(uuid) || '}' ELSE uuid END FROM uuid_series(1000)");
+    exec(db, "UPDATE users SET uuid = '0' WHERE id % 100 = 0");
+
+    // Fails the batch holding row 450 for as long as the flag is set
+    exec(db, "CREATE TABLE flags(fail INTEGER)");
+    exec(db, "INSERT INTO flags VALUES (1)");
+    exec(db, "CREATE TRIGGER fail_row BEFORE UPDATE OF uuid ON users WHEN new.id = 450 AND (SELECT fail FROM flags) "
+        "BEGIN SELECT RAISE(ABORT, 'injected failure'); END");
+
+    BatchOptions options;
+    options.batchRows = 100;
+    options.pause = std::chrono::milliseconds(0);
+    options.maxBatchTime = std::chrono::milliseconds(10000);
+
+    SECTION("A failed batch stops the migration, which carries on from there when run again")
+    {
+        REQUIRE_THROWS_AS(migrate_uuid_column(db, "users", "uuid", options), std::runtime_error);
+
+        // The batches before the failing one are committed, the failing one and everything after it are not
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE id <= 400 AND typeof(uuid) = 'blob'") == 396 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE id > 400 AND typeof(uuid) = 'blob'") == 0 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM sqlite_schema WHERE type = 'index' AND tbl_name = 'users'") == 0 );
+        REQUIRE( queryInt(db, "SELECT last_rowid FROM uuid_batch_checkpoint WHERE name = 'uuid_migration users.uuid'") == 400 );
+
+        exec(db, "UPDATE flags SET fail = 0");
+        const UuidMigrationReport report = migrate_uuid_column(db, "users", "uuid", options);
+
+        REQUIRE( report.rowsConverted == 594 );
+        REQUIRE( report.valuesSkipped == 10 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE typeof(uuid) = 'blob' AND length(uuid) = 16") == 990 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM users WHERE uuid = '0'") == 10 );
+
+        // Both indexes are back and in use, and the progress tables are empty again
+        REQUIRE( queryInt(db, "SELECT count(*) FROM sqlite_schema WHERE type = 'index' AND name IN ('users_uuid', 'users_name_uuid')") == 2 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM uuid_migration") == 0 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM uuid_migration_index") == 0 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM uuid_batch_checkpoint") == 0 );
+        REQUIRE( queryInt(db, "PRAGMA integrity_check = 1") == 0 );
+
+        // The sizes from before the first, failed, run are the ones reported
+        REQUIRE( report.tableBefore.pageBytes > 0 );
+        REQUIRE( report.tableAfter.pageBytes > 0 );
+        REQUIRE( report.tableAfter.payloadBytes < report.tableBefore.payloadBytes );
+        REQUIRE( report.indexesBefore.payloadBytes > 0 );
+        REQUIRE( report.indexesAfter.payloadBytes < report.indexesBefore.payloadBytes );
+        REQUIRE( report.indexesAfter.depth >= 1 );
+    }
+
+    SECTION("Values that are not UUIDs are left as they are and counted")
+    {
+        exec(db, "UPDATE flags SET fail = 0");
+        exec(db, "UPDATE users SET uuid = 42 WHERE id = 1");
+        exec(db, "UPDATE users SET uuid = x'0102' WHERE id = 2");
+
+        const UuidMigrationReport report = migrate_uuid_column(db, "users", "uuid", options);
+        REQUIRE( report.rowsConverted == 988 );
+        REQUIRE( report.valuesSkipped == 12 );
+        REQUIRE( queryInt(db, "SELECT uuid FROM users WHERE id = 1") == 42 );
+    }
+
+    SECTION("Unique indexes stay, so spellings of the same UUID fail their batch rather than the index")
+    {
+        exec(db, "CREATE TABLE devices(id INTEGER PRIMARY KEY, uuid TEXT)");
+        exec(db, "CREATE UNIQUE INDEX devices_uuid ON devices(uuid)");
+        exec(db, "INSERT INTO devices(id, uuid) SELECT rowid, uuid FROM uuid_series(300)");
+        exec(db, "UPDATE devices SET uuid = (SELECT upper(uuid) FROM devices WHERE id = 150) WHERE id = 250");
+
+        REQUIRE_THROWS_WITH(migrate_uuid_column(db, "devices", "uuid", options),
+            Catch::Matchers::Contains("UNIQUE") && Catch::Matchers::Contains("in rowids 201 to 300"));
+
+        REQUIRE( queryInt(db, "SELECT count(*) FROM sqlite_schema WHERE type = 'index' AND name = 'devices_uuid'") == 1 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM devices WHERE typeof(uuid) = 'blob'") == 200 );
+
+        exec(db, "DELETE FROM devices WHERE id = 250");
+        const UuidMigrationReport report = migrate_uuid_column(db, "devices", "uuid", options);
+        REQUIRE( report.rowsConverted == 99 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM devices WHERE typeof(uuid) = 'blob'") == 300 - 1 );
+        REQUIRE( queryInt(db, "SELECT count(*) FROM sqlite_schema WHERE type = 'index' AND name = 'devices_uuid'") == 1 );
+        REQUIRE( queryInt(db, "PRAGMA integrity_check = 1") == 0 );
+    }
+
+    sqlite3_close(db);
+}
@@ -0,0 +1,148 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "sqlite_extensions/uuidname.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    const unsigned char NAMESPACE_DNS[16] = {0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8};
+    const unsigned char NAMESPACE_URL[16] = {0x6b, 0xa7, 0xb8, 0x11, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8};
+
+    std::string formatUuid(const unsigned char * bytes)
+    {
+        unsigned char text[37];
+        sqlite3UuidBlobToStr(bytes, text);
+        return reinterpret_cast<char *>(text);
+    }
+
+    const unsigned char * asBytes(const std::string & text)
+    {
+        return reinterpret_cast<const unsigned char *>(text.data());
+    }
+}
+
+TEST_CASE("Name-based UUIDs match RFC 9562", "[uuidname]")
+{
+    std::vector<bool> kernels = {false};
+    if( sqlite3UuidShaNiSupported() )
+    {
+        kernels.push_back(true);
+    }
+
+    SECTION("Known version 5 and version 3 UUIDs")
+    {
+        const std::string name = "python.org";
+        const std::string longName(100, 'x');
+        unsigned char out[16];
+
+        for( bool shaNi : kernels )
+        {
+            INFO("SHA extensions " << shaNi);
+            sqlite3UuidV5GenerateWith(shaNi, NAMESPACE_DNS, asBytes(name), name.size(), out);
+            REQUIRE( formatUuid(out) == "886313e1-3b8a-5372-9b90-0c9aee199e5d" );
+            sqlite3UuidV5GenerateWith(shaNi, NAMESPACE_URL, nullptr, 0, out);
+            REQUIRE( formatUuid(out) == "1b4db7eb-4057-5ddf-91e0-36dec72071f5" );
+        }
+
+        sqlite3UuidV3Generate(NAMESPACE_DNS, asBytes(name), name.size(), out);
+        REQUIRE( formatUuid(out) == "6fa459ea-ee8a-3ca4-894e-db77e160355e" );
+        sqlite3UuidV3Generate(NAMESPACE_URL, nullptr, 0, out);
+        REQUIRE( formatUuid(out) == "14cdb9b4-de01-3faa-aff5-65bc2f771745" );
+        sqlite3UuidV3Generate(NAMESPACE_DNS, asBytes(longName), longName.size(), out);
+        REQUIRE( formatUuid(out) == "3bcc0d1a-950b-386e-889c-e44d6b0b48c0" );
+    }
+
+    SECTION("Every kernel, one at a time or in a batch, agrees on names of every length around the block boundaries")
+    {
+        std::mt19937 generator(20240307);
+        std::uniform_int_distribution<int> character(0, 255);
+
+        std::vector<std::string> names;
+        for(size_t length = 0; length < 200; length++)
+        {
+            std::string name(length, '\0');
+            for( char & byte : name )
+            {
+                byte = static_cast<char>(character(generator));
+            }
+            names.push_back(name);
+        }
+
+        // Pairs of very different lengths, so one lane of the batch carries on alone
+        std::shuffle(names.begin(), names.end(), generator);
+
+        std::vector<const unsigned char *> pointers;
+        std::vector<size_t> lengths;
+        for( const std::string & name : names )
+        {
+            pointers.push_back(asBytes(name));
+            lengths.push_back(name.size());
+        }
+
+        std::vector<unsigned char> expected(16 * names.size());
+        for(size_t nameIndex = 0; nameIndex < names.size(); nameIndex++)
+        {
+            sqlite3UuidV5GenerateWith(false, NAMESPACE_DNS, pointers[nameIndex], lengths[nameIndex], expected.data() + 16 * nameIndex);
+        }
+
+        for( bool shaNi : kernels )
+        {
+            INFO("SHA extensions " << shaNi);
+            for(size_t nameIndex = 0; nameIndex < names.size(); nameIndex++)
+            {
+                unsigned char out[16];
+                sqlite3UuidV5GenerateWith(shaNi, NAMESPACE_DNS, pointers[nameIndex], lengths[nameIndex], out);
+                REQUIRE( memcmp(out, expected.data() + 16 * nameIndex, 16) == 0 );
+            }
+
+            // An odd count leaves one name for after the pairs
+            std::vector<unsigned char> batch(16 * names.size());
+            sqlite3UuidV5GenerateBatchWith(shaNi, NAMESPACE_DNS, pointers.data(), lengths.data(), names.size() - 1, batch.data());
+            REQUIRE( memcmp(batch.data(), expected.data(), 16 * (names.size() - 1)) == 0 );
+        }
+    }
+}
+
+TEST_CASE("The UUID SQlite extension generates name-based UUIDs from SQL", "[uuidname]")
+{
+    registerUuidExtension();
+
+    forEachEncoding([](soci::session & session)
+    {
+        SECTION("The same name always gives the same UUID, in every database encoding")
+        {
+            std::string version5;
+            std::string version3;
+            std::string nonAscii;
+            session << "SELECT uuid5('6ba7b810-9dad-11d1-80b4-00c04fd430c8', 'python.org'), uuid3(x'6ba7b8109dad11d180b400c04fd430c8', 'python.org'), "
+                "uuid5('{6BA7B810-9DAD-11D1-80B4-00C04FD430C8}', '\xC3\xA9')",
+                soci::into(version5), soci::into(version3), soci::into(nonAscii);
+            REQUIRE( version5 == "886313e1-3b8a-5372-9b90-0c9aee199e5d" );
+            REQUIRE( version3 == "6fa459ea-ee8a-3ca4-894e-db77e160355e" );
+            REQUIRE( nonAscii == "ebfe0af8-3997-5ade-b634-ba92cf69f557" );
+
+            int distinct = 0;
+            session << "SELECT count(DISTINCT uuid5('6ba7b810-9dad-11d1-80b4-00c04fd430c8', 'janedoe@posit.co')) FROM uuid_series(100)", soci::into(distinct);
+            REQUIRE( distinct == 1 );
+        }
+
+        SECTION("NULL names give NULL, and bad namespaces are rejected")
+        {
+            requireNull(session, "SELECT uuid5('6ba7b810-9dad-11d1-80b4-00c04fd430c8', NULL)");
+            requireRejected(session, {"SELECT uuid5('dns', 'python.org')", "SELECT uuid3(NULL, 'python.org')"});
+        }
+    });
+}
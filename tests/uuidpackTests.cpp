@@ -0,0 +1,175 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "sqlite_extensions/uuidkernels.hpp"
+#include "sqlite_extensions/uuidpack.hpp"
+#include "socihelpers.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("Packs of UUIDs are sorted, deduplicated and searchable", "[uuidpack]")
+{
+    SECTION("Sorting orders by bytes and drops duplicates")
+    {
+        const unsigned char uuids[4][16] = {
+            {0xff, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01},
+            {0x01, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff},
+            {0xff, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01},
+            {0x01, 0xff, 0, 0, 0, 0, 0, 0, 0xff, 0, 0, 0, 0, 0, 0, 0x00}
+        };
+
+        std::vector<UuidPackKey> keys;
+        for( const unsigned char * uuid : uuids )
+        {
+            keys.push_back(sqlite3UuidPackKey(uuid));
+        }
+
+        const size_t count = sqlite3UuidPackSort(keys.data(), keys.size());
+        REQUIRE( count == 3 );
+
+        std::vector<unsigned char> pack(16 * count);
+        sqlite3UuidPackWrite(keys.data(), count, pack.data());
+        REQUIRE( memcmp(pack.data(), uuids[1], 16) == 0 );
+        REQUIRE( memcmp(pack.data() + 16, uuids[3], 16) == 0 );
+        REQUIRE( memcmp(pack.data() + 32, uuids[0], 16) == 0 );
+        REQUIRE( sqlite3UuidPackIsSorted(pack.data(), count) );
+        REQUIRE_FALSE( sqlite3UuidPackIsSorted(uuids[0], 2) );
+    }
+
+    SECTION("Every member is found, and nothing else, for packs of every size")
+    {
+        for(size_t count = 0; count <= 70; count++)
+        {
+            INFO(count);
+            std::vector<unsigned char> bytes(16 * (2 * count + 1));
+            sqlite3UuidV4Generate(bytes.data(), 2 * count + 1);
+
+            std::vector<UuidPackKey> keys;
+            for(size_t uuidIndex = 0; uuidIndex < count; uuidIndex++)
+            {
+                keys.push_back(sqlite3UuidPackKey(bytes.data() + 16 * uuidIndex));
+            }
+            REQUIRE( sqlite3UuidPackSort(keys.data(), keys.size()) == count );
+
+            std::vector<unsigned char> pack(16 * count + 1);
+            sqlite3UuidPackWrite(keys.data(), count, pack.data());
+
+            for(size_t uuidIndex = 0; uuidIndex < 2 * count + 1; uuidIndex++)
+            {
+                REQUIRE( sqlite3UuidPackContains(pack.data(), count, bytes.data() + 16 * uuidIndex) == (uuidIndex < count) );
+            }
+
+            // Below the first and above the last
+            const unsigned char lowest[16] = {};
+            unsigned char highest[16];
+            memset(highest, 0xff, sizeof(highest));
+            REQUIRE_FALSE( sqlite3UuidPackContains(pack.data(), count, lowest) );
+            REQUIRE_FALSE( sqlite3UuidPackContains(pack.data(), count, highest) );
+        }
+    }
+}
+
+TEST_CASE("The UUID SQlite extension packs and unpacks UUIDs from SQL", "[uuidpack]")
+{
+    registerUuidExtension();
+
+    soci::session session("sqlite3", ":memory:");
+    session << "CREATE TABLE groups (id BLOB PRIMARY KEY, name TEXT)";
+    session << "INSERT INTO groups SELECT uuid_blob, 'group ' || rowid FROM uuid_series(1000)";
+
+    SECTION("One row of packed memberships replaces the junction rows, in every encoding")
+    {
+        forEachEncoding([](soci::session & encoded)
+        {
+            encoded << "CREATE TABLE groups (id TEXT PRIMARY KEY, name TEXT)";
+            encoded << "INSERT INTO groups SELECT uuid, 'group ' || rowid FROM uuid_series(1000)";
+            encoded << "CREATE TABLE users (name TEXT, group_ids BLOB)";
+            encoded << "INSERT INTO users SELECT 'alice', uuid_pack(id) FROM (SELECT id FROM groups WHERE rowid % 3 = 0 UNION ALL SELECT id FROM groups WHERE rowid % 6 = 0)";
+
+            int packed = 0;
+            int joined = 0;
+            int contained = 0;
+            encoded << "SELECT length(group_ids) / 16 FROM users", soci::into(packed);
+            encoded << "SELECT count(*) FROM users, uuid_each(users.group_ids) AS member JOIN groups ON groups.id = member.uuid", soci::into(joined);
+            encoded << "SELECT count(*) FROM users, groups WHERE uuid_pack_contains(users.group_ids, groups.id)", soci::into(contained);
+            REQUIRE( packed == 333 );
+            REQUIRE( joined == 333 );
+            REQUIRE( contained == 333 );
+        });
+    }
+
+    SECTION("uuid_each() returns the UUIDs in order, without sorting them again")
+    {
+        std::vector<std::string> uuids(1000);
+        session << "SELECT uuid FROM uuid_each((SELECT uuid_pack(id) FROM groups))", soci::into(uuids);
+        REQUIRE( uuids.size() == 1000 );
+        for(size_t uuidIndex = 1; uuidIndex < uuids.size(); uuidIndex++)
+        {
+            REQUIRE( uuids[uuidIndex - 1] < uuids[uuidIndex] );
+        }
+
+        std::string plan;
+        soci::rowset<soci::row> planRows = (session.prepare << "EXPLAIN QUERY PLAN SELECT uuid FROM uuid_each(x'') ORDER BY uuid_blob");
+        for( soci::row & row : planRows )
+        {
+            plan += row.get<std::string>(3);
+        }
+        REQUIRE( plan.find("ORDER BY") == std::string::npos );
+    }
+
+    SECTION("Rowids joined by OR are each looked up")
+    {
+        std::vector<int> rowids(10);
+        session << "SELECT rowid FROM uuid_each((SELECT uuid_pack(id) FROM groups)) WHERE rowid = 1 OR rowid = 3 ORDER BY rowid", soci::into(rowids);
+        REQUIRE( rowids == std::vector<int>{1, 3} );
+    }
+
+    SECTION("Each outer row's pack is unnested on its own, including two at once")
+    {
+        session << "CREATE TABLE users (name TEXT, group_ids BLOB)";
+        session << "INSERT INTO users SELECT 'user ' || rowid, (SELECT uuid_pack(id) FROM groups WHERE groups.rowid % (series.rowid + 1) = 0) FROM uuid_series(4) AS series";
+        session << "INSERT INTO users VALUES ('nobody', NULL)";
+
+        int members = 0;
+        int strangers = -1;
+        int shared = 0;
+        session << "SELECT count(*) FROM users, uuid_each(users.group_ids) AS member", soci::into(members);
+        session << "SELECT count(*) FROM users, uuid_each(users.group_ids) AS member WHERE NOT uuid_pack_contains(users.group_ids, member.uuid_blob)", soci::into(strangers);
+        session << "SELECT count(*) FROM users AS a, uuid_each(a.group_ids) AS e, users AS b, uuid_each(b.group_ids) AS f "
+            "WHERE a.name = 'user 1' AND b.name = 'user 2' AND e.uuid_blob = f.uuid_blob", soci::into(shared);
+        REQUIRE( members == 500 + 333 + 250 + 200 );
+        REQUIRE( strangers == 0 );
+        REQUIRE( shared == 166 );
+    }
+
+    SECTION("No rows give an empty pack, and NULL packs give NULL or no rows")
+    {
+        int length = -1;
+        int rows = -1;
+        session << "SELECT length(uuid_pack(id)) FROM groups WHERE 0", soci::into(length);
+        session << "SELECT count(*) FROM uuid_each(NULL)", soci::into(rows);
+        REQUIRE( length == 0 );
+        REQUIRE( rows == 0 );
+
+        requireNull(session, "SELECT uuid_pack_contains(NULL, uuid())");
+    }
+
+    SECTION("Bad input is rejected")
+    {
+        requireRejected(session, {
+            "SELECT uuid_pack('not a guid')",
+            "SELECT uuid_pack_contains(x'a0eebc99', uuid())",
+            "SELECT uuid_pack_contains(uuid_pack(uuid()), 'not a guid')",
+            "SELECT * FROM uuid_each(x'a0eebc99')",
+            "SELECT * FROM uuid_each(x'ffffffffffffffffffffffffffffffff00000000000000000000000000000000')",
+            "SELECT * FROM uuid_each"
+        });
+    }
+}
@@ -0,0 +1,70 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidrandom.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("The UUID randomness pool hands out unique bytes", "[uuidrandom]")
+{
+    SECTION("Consecutive draws do not repeat")
+    {
+        // Enough draws to cross several pool refills and a reseed
+        std::set<std::string> seen;
+        for(int draw = 0; draw < 100000; draw++)
+        {
+            unsigned char bytes[16];
+            sqlite3UuidRandomness(16, bytes);
+            REQUIRE( seen.insert(std::string(reinterpret_cast<char *>(bytes), 16)).second );
+        }
+    }
+
+    SECTION("Draws larger than the pool are filled completely")
+    {
+        std::vector<unsigned char> bytes(3 * 4096 + 7, 0);
+        sqlite3UuidRandomness(bytes.size(), bytes.data());
+
+        // The chance of a random 64 byte tail being all zeroes is negligible
+        std::vector<unsigned char> zeroes(64, 0);
+        REQUIRE( memcmp(bytes.data() + bytes.size() - 64, zeroes.data(), 64) != 0 );
+    }
+
+    SECTION("A forked child does not repeat the parent's bytes")
+    {
+        // Prime the pool so the child inherits a partially used buffer
+        unsigned char primer[16];
+        sqlite3UuidRandomness(16, primer);
+
+        int pipeFds[2];
+        REQUIRE( pipe(pipeFds) == 0 );
+
+        pid_t pid = fork();
+        REQUIRE( pid >= 0 );
+
+        if( pid == 0 )
+        {
+            unsigned char childBytes[16];
+            sqlite3UuidRandomness(16, childBytes);
+            ssize_t written = write(pipeFds[1], childBytes, 16);
+            _exit(written == 16 ? 0 : 1);
+        }
+
+        unsigned char parentBytes[16];
+        unsigned char childBytes[16];
+        sqlite3UuidRandomness(16, parentBytes);
+
+        int status = 0;
+        REQUIRE( waitpid(pid, &status, 0) == pid );
+        REQUIRE( read(pipeFds[0], childBytes, 16) == 16 );
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+
+        REQUIRE( memcmp(parentBytes, childBytes, 16) != 0 );
+    }
+}
@@ -0,0 +1,98 @@
+#include "catch/catch.hpp"
+
+#include "sqlite_extensions/uuidext.hpp"
+#include "testhelpers.hpp"
+
+#include <sqlite3.h>
+#include <soci/soci.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("The UUID SQlite extension generates UUIDs in bulk with uuid_series", "[uuidseries]")
+{
+    registerUuidExtension();
+
+    std::unique_ptr<soci::session> session;
+    auto createDbFn = [&session]() 
+    {
+        session.reset(new soci::session("sqlite3", ":memory:"));
+    };
+    REQUIRE_NOTHROW(createDbFn());
+
+    SECTION("Generates the requested number of distinct version 4 UUIDs")
+    {
+        int rows = 0;
+        int distinctRows = 0;
+        int wellFormedRows = 0;
+        *session << "SELECT count(*), count(DISTINCT uuid_blob), sum(uuid_str(uuid_blob) = uuid AND substr(uuid, 15, 1) = '4') "
+            "FROM uuid_series(1000)", soci::into(rows), soci::into(distinctRows), soci::into(wellFormedRows);
+
+        REQUIRE(rows == 1000);
+        REQUIRE(distinctRows == 1000);
+        REQUIRE(wellFormedRows == 1000);
+    }
+
+    SECTION("Generates increasing version 7 UUIDs")
+    {
+        int rows = 0;
+        int outOfOrder = -1;
+        *session << "SELECT count(*), sum(substr(uuid, 15, 1) <> '7') FROM uuid_series(600, 7)", soci::into(rows), soci::into(outOfOrder);
+        REQUIRE(rows == 600);
+        REQUIRE(outOfOrder == 0);
+
+        *session << "CREATE TABLE keys(n INTEGER PRIMARY KEY, id BLOB)";
+        *session << "INSERT INTO keys SELECT rowid, uuid_blob FROM uuid_series(600, 7)";
+        *session << "SELECT count(*) FROM keys AS a JOIN keys AS b ON b.n = a.n + 1 WHERE b.id <= a.id", soci::into(outOfOrder);
+        REQUIRE(outOfOrder == 0);
+    }
+
+    SECTION("Only generates the rows selected by rowid, LIMIT and OFFSET")
+    {
+        int first = 0;
+        int last = 0;
+        int rows = 0;
+
+        *session << "SELECT min(rowid), max(rowid), count(*) FROM uuid_series(1000) WHERE rowid > 990", soci::into(first), soci::into(last), soci::into(rows);
+        REQUIRE(first == 991);
+        REQUIRE(last == 1000);
+        REQUIRE(rows == 10);
+
+        *session << "SELECT min(rowid), max(rowid), count(*) FROM (SELECT rowid FROM uuid_series(1000) WHERE rowid BETWEEN 10 AND 20 LIMIT 3 OFFSET 2)",
+            soci::into(first), soci::into(last), soci::into(rows);
+        REQUIRE(first == 12);
+        REQUIRE(last == 14);
+        REQUIRE(rows == 3);
+    }
+
+    SECTION("LIMIT and OFFSET apply after sorting in any other order")
+    {
+        std::vector<int> rowids(10);
+        *session << "SELECT rowid FROM uuid_series(10) ORDER BY rowid DESC LIMIT 2 OFFSET 1", soci::into(rowids);
+        REQUIRE(rowids == std::vector<int>{9, 8});
+
+        rowids.resize(10);
+        *session << "SELECT rowid FROM uuid_series(5, 7) ORDER BY uuid DESC LIMIT 2", soci::into(rowids);
+        REQUIRE(rowids == std::vector<int>{5, 4});
+
+        rowids.resize(10);
+        *session << "SELECT rowid FROM uuid_series(10) ORDER BY rowid LIMIT 2 OFFSET 3", soci::into(rowids);
+        REQUIRE(rowids == std::vector<int>{4, 5});
+    }
+
+    SECTION("Rowids joined by OR are each looked up")
+    {
+        std::vector<int> rowids(10);
+        *session << "SELECT rowid FROM uuid_series(10) WHERE rowid = 4 OR rowid = 6 ORDER BY rowid", soci::into(rowids);
+        REQUIRE(rowids == std::vector<int>{4, 6});
+    }
+
+    SECTION("Rejects a missing count and unsupported versions")
+    {
+        std::string uuid;
+        REQUIRE_THROWS_AS((*session << "SELECT uuid FROM uuid_series", soci::into(uuid)), soci::soci_error);
+        REQUIRE_THROWS_AS((*session << "SELECT uuid FROM uuid_series(1, 5)", soci::into(uuid)), soci::soci_error);
+    }
+}